@@ -0,0 +1,120 @@
+#include "layer.h"
+#include "builder.h"
+#include "core/table.h"
+#include "core/numeric.h"
+#include "core/cmdline.h"
+#include "core/measure.h"
+#include <iostream>
+
+using namespace nano;
+
+namespace
+{
+        const auto trials = size_t(16);
+
+        auto make_layer(const string_t& layer_id, const bool fast, const tensor3d_dim_t& dims)
+        {
+                auto layer = get_layers().get(layer_id);
+                layer->from_json(config_activation_node("act", layer_id, fast));
+                layer->resize({dims});
+                return layer;
+        }
+
+        auto measure_output(layer_t& layer, const tensor4d_t& idata, tensor4d_t& odata)
+        {
+                const auto pdata = vector_t{};
+                return measure<nanoseconds_t>([&] ()
+                {
+                        layer.output({map_tensor(idata.data(), idata.dims())}, map_vector(pdata.data(), 0), map_tensor(odata.data(), odata.dims()));
+                }, trials);
+        }
+
+        auto measure_ginput(layer_t& layer, tensor4d_t& idata, const tensor4d_t& odata)
+        {
+                const auto pdata = vector_t{};
+                return measure<nanoseconds_t>([&] ()
+                {
+                        layer.ginput({map_tensor(idata.data(), idata.dims())}, map_vector(pdata.data(), 0), map_tensor(odata.data(), odata.dims()));
+                }, trials);
+        }
+
+        template <typename tduration>
+        auto speedup(const tduration& exact, const tduration& fast)
+        {
+                return static_cast<double>(exact.count()) / static_cast<double>(std::max(fast.count(), decltype(fast.count())(1)));
+        }
+}
+
+int main(int argc, const char *argv[])
+{
+        // parse the command line
+        cmdline_t cmdline("benchmark activation functions (exact vs. fast approximation)");
+        cmdline.add("", "min-size",     "minimum number of elements (in kilo) [1, 1024]", "16");
+        cmdline.add("", "max-size",     "maximum number of elements (in kilo) [1, 16384]", "1024");
+
+        cmdline.process(argc, argv);
+
+        // check arguments and options
+        const auto cmd_min_size = clamp(cmdline.get<tensor_size_t>("min-size"), tensor_size_t(1), tensor_size_t(1024));
+        const auto cmd_max_size = clamp(cmdline.get<tensor_size_t>("max-size"), cmd_min_size, tensor_size_t(16384));
+
+        table_t table;
+        table.header()
+                << colspan(2) << ""
+                << colspan(2) << alignment::center << colfill('=') << "exact[us]"
+                << colspan(2) << alignment::center << colfill('=') << "fast[us]"
+                << colspan(2) << alignment::center << colfill('=') << "speedup";
+        table.delim();
+        table.append()
+                << "activation" << "size"
+                << "output" << "ginput"
+                << "output" << "ginput"
+                << "output" << "ginput";
+        table.delim();
+
+        // benchmark each activation function for different number of elements
+        for (const auto& layer_id : get_layers().ids())
+        {
+                if (!is_activation_node(layer_id))
+                {
+                        continue;
+                }
+
+                for (auto size = cmd_min_size; size <= cmd_max_size; size *= 4)
+                {
+                        const auto dims = make_dims(size, tensor_size_t(32), tensor_size_t(32));
+
+                        tensor4d_t idata(cat_dims(1, dims)), odata(cat_dims(1, dims));
+                        idata.random(-5, +5);
+                        odata.random(-1, +1);
+
+                        // NB: the gradient wrt inputs overwrites its input buffer
+                        tensor4d_t gdata = idata;
+
+                        auto exact = make_layer(layer_id, false, dims);
+                        auto fast = make_layer(layer_id, true, dims);
+
+                        const auto exact_output = measure_output(*exact, idata, odata);
+                        const auto exact_ginput = measure_ginput(*exact, gdata, odata);
+                        const auto fast_output = measure_output(*fast, idata, odata);
+                        const auto fast_ginput = measure_ginput(*fast, gdata, odata);
+
+                        table.append()
+                                << layer_id << (to_string(size) + "K")
+                                << precision(1) << (exact_output.count() / 1e+3)
+                                << precision(1) << (exact_ginput.count() / 1e+3)
+                                << precision(1) << (fast_output.count() / 1e+3)
+                                << precision(1) << (fast_ginput.count() / 1e+3)
+                                << precision(2) << speedup(exact_output, fast_output)
+                                << precision(2) << speedup(exact_ginput, fast_ginput);
+                }
+
+                table.delim();
+        }
+
+        // print results
+        std::cout << table;
+
+        // OK
+        return EXIT_SUCCESS;
+}
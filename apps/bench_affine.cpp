@@ -3,9 +3,11 @@
 #include "core/logger.h"
 #include "core/numeric.h"
 #include "core/cmdline.h"
+#include "core/algorithm.h"
 #include "core/measure.h"
 #include "layers/affine3d.h"
 #include "layers/affine4d.h"
+#include "layers/sparse_affine4d.h"
 #include <iostream>
 
 using namespace nano;
@@ -17,25 +19,19 @@ namespace
         template <typename top, typename tidata, typename twdata, typename tbdata, typename todata>
         auto measure_output(const top& op, const tidata& idata, const twdata& wdata, const tbdata& bdata, todata& odata)
         {
-                const auto count = idata.template size<0>();
-                const auto duration = measure<nanoseconds_t>([&] () { op.output(idata, wdata, bdata, odata); }, trials);
-                return nano::gflops(op.params().flops_output() * count, duration);
+                return measure<nanoseconds_t>([&] () { op.output(idata, wdata, bdata, odata); }, trials);
         }
 
         template <typename top, typename tidata, typename twdata, typename tbdata, typename todata>
         auto measure_ginput(const top& op, tidata& idata, const twdata& wdata, const tbdata& bdata, const todata& odata)
         {
-                const auto count = idata.template size<0>();
-                const auto duration = measure<nanoseconds_t>([&] () { op.ginput(idata, wdata, bdata, odata); }, trials);
-                return nano::gflops(op.params().flops_ginput() * count, duration);
+                return measure<nanoseconds_t>([&] () { op.ginput(idata, wdata, bdata, odata); }, trials);
         }
 
         template <typename top, typename tidata, typename twdata, typename tbdata, typename todata>
         auto measure_gparam(const top& op, const tidata& idata, twdata& wdata, tbdata& bdata, const todata& odata)
         {
-                const auto count = idata.template size<0>();
-                const auto duration = measure<nanoseconds_t>([&] () { op.gparam(idata, wdata, bdata, odata); }, trials);
-                return nano::gflops(op.params().flops_gparam() * count, duration);
+                return measure<nanoseconds_t>([&] () { op.gparam(idata, wdata, bdata, odata); }, trials);
         }
 
         bool benchmark(const int isize, const int osize, const int count, table_t& table)
@@ -60,15 +56,15 @@ namespace
 
                 // 3D implementation
                 const auto op3d = affine3d_t{params};
-                const auto gf3d_output = measure_output(op3d, idata, wdata, bdata, odata);
-                const auto gf3d_ginput = measure_ginput(op3d, idata, wdata, bdata, odata);
-                const auto gf3d_gparam = measure_gparam(op3d, idata, wdata, bdata, odata);
+                const auto gf3d_output = nano::gflops(params.flops_output() * count, measure_output(op3d, idata, wdata, bdata, odata));
+                const auto gf3d_ginput = nano::gflops(params.flops_ginput() * count, measure_ginput(op3d, idata, wdata, bdata, odata));
+                const auto gf3d_gparam = nano::gflops(params.flops_gparam() * count, measure_gparam(op3d, idata, wdata, bdata, odata));
 
                 // 4D implementation
                 const auto op4d = affine4d_t{params};
-                const auto gf4d_output = measure_output(op4d, idata, wdata, bdata, odata);
-                const auto gf4d_ginput = measure_ginput(op4d, idata, wdata, bdata, odata);
-                const auto gf4d_gparam = measure_gparam(op4d, idata, wdata, bdata, odata);
+                const auto gf4d_output = nano::gflops(params.flops_output() * count, measure_output(op4d, idata, wdata, bdata, odata));
+                const auto gf4d_ginput = nano::gflops(params.flops_ginput() * count, measure_ginput(op4d, idata, wdata, bdata, odata));
+                const auto gf4d_gparam = nano::gflops(params.flops_gparam() * count, measure_gparam(op4d, idata, wdata, bdata, odata));
 
                 table.append()
                         << params.idims() << config << params.odims() << params.psize()
@@ -77,6 +73,58 @@ namespace
                         << gf4d_output << gf4d_ginput << gf4d_gparam;
                 return true;
         }
+
+        bool benchmark_sparse(const int isize, const int osize, const int count, const strings_t& densities, table_t& table)
+        {
+                const auto params = affine_params_t{isize, 1, 1, osize, 1, 1};
+                const auto config = strcat("isize=", isize, ",osize=", osize, ",count=", count);
+
+                if (!params.valid())
+                {
+                        log_error() << "invalid parameters (" << config << ")!";
+                        return false;
+                }
+
+                auto wdata = params.make_wdata(); wdata.setRandom();
+                auto bdata = params.make_bdata(); bdata.setRandom();
+                auto idata = params.make_idata(count); idata.setRandom();
+                auto odata = params.make_odata(count); odata.setRandom();
+
+                // dense baseline
+                const auto op4d = affine4d_t{params};
+                const auto dense_output = measure_output(op4d, idata, wdata, bdata, odata);
+                const auto dense_ginput = measure_ginput(op4d, idata, wdata, bdata, odata);
+                const auto dense_gparam = measure_gparam(op4d, idata, wdata, bdata, odata);
+
+                const auto speedup = [] (const auto dense, const auto sparse)
+                {
+                        return static_cast<double>(dense.count()) / static_cast<double>(std::max(sparse.count(), decltype(sparse.count())(1)));
+                };
+
+                for (const auto& density : densities)
+                {
+                        sparse_indices_t rowptr, colidx;
+                        sparse_affine4d_t::make_pattern(params, from_string<scalar_t>(density), rowptr, colidx);
+
+                        const auto op = sparse_affine4d_t{params, rowptr, colidx};
+                        vector_t swdata(op.nnz()); swdata.setRandom();
+
+                        const auto sparse_output = measure_output(op, idata, swdata, bdata, odata);
+                        const auto sparse_ginput = measure_ginput(op, idata, swdata, bdata, odata);
+                        const auto sparse_gparam = measure_gparam(op, idata, swdata, bdata, odata);
+
+                        table.append()
+                                << config << density << op.nnz()
+                                << nano::gflops(op.flops_output() * count, sparse_output)
+                                << nano::gflops(op.flops_ginput() * count, sparse_ginput)
+                                << nano::gflops(op.flops_gparam() * count, sparse_gparam)
+                                << precision(2) << speedup(dense_output, sparse_output)
+                                << precision(2) << speedup(dense_ginput, sparse_ginput)
+                                << precision(2) << speedup(dense_gparam, sparse_gparam);
+                }
+
+                return true;
+        }
 }
 
 int main(int argc, const char *argv[])
@@ -89,6 +137,7 @@ int main(int argc, const char *argv[])
         cmdline.add("", "max-osize",    "maximum output size [32, 4096]", "1024");
         cmdline.add("", "min-count",    "minimum number of samples in minibatch [1, 16]",  "1");
         cmdline.add("", "max-count",    "maximum number of samples in minibatch [1, 128]", "128");
+        cmdline.add("", "densities",    "benchmark the sparse kernel for these weight densities (e.g. 0.01,0.1,0.5)");
 
         cmdline.process(argc, argv);
 
@@ -99,6 +148,7 @@ int main(int argc, const char *argv[])
         const auto cmd_max_osize = clamp(cmdline.get<int>("max-osize"), cmd_min_osize, 4096);
         const auto cmd_min_count = clamp(cmdline.get<int>("min-count"), 1, 16);
         const auto cmd_max_count = clamp(cmdline.get<int>("max-count"), cmd_min_count, 128);
+        const auto cmd_densities = cmdline.has("densities") ? split(cmdline.get<string_t>("densities"), ",") : strings_t{};
 
         table_t table;
         table.header()
@@ -139,6 +189,41 @@ int main(int argc, const char *argv[])
         // print results
         std::cout << table;
 
+        // benchmark the sparse kernel for different densities (relative to the dense 4d kernel)
+        if (!cmd_densities.empty())
+        {
+                table_t stable;
+                stable.header()
+                        << colspan(3) << ""
+                        << colspan(3) << alignment::center << colfill('=') << "sparse kernel[gflop/s]"
+                        << colspan(3) << alignment::center << colfill('=') << "speedup vs 4d kernel";
+                stable.delim();
+                stable.append()
+                        << "config" << "density" << "#nnz"
+                        << "output" << "ginput" << "gparam"
+                        << "output" << "ginput" << "gparam";
+                stable.delim();
+
+                auto first = true;
+                for (auto isize = cmd_min_isize; isize <= cmd_max_isize; isize *= 2)
+                {
+                        for (auto osize = cmd_min_osize; osize <= cmd_max_osize; osize *= 2)
+                        {
+                                for (auto count = cmd_min_count; count <= cmd_max_count; count *= 2)
+                                {
+                                        if (!first)
+                                        {
+                                                stable.delim();
+                                        }
+                                        benchmark_sparse(isize, osize, count, cmd_densities, stable);
+                                        first = false;
+                                }
+                        }
+                }
+
+                std::cout << stable;
+        }
+
         // OK
         return EXIT_SUCCESS;
 }
@@ -95,8 +95,8 @@ int main(int argc, const char *argv[])
         cmdline.add("", "irows",        "number of input rows [16, 128]", "24");
         cmdline.add("", "icols",        "number of input cols [16, 128]", "24");
         cmdline.add("", "omaps",        "number of output planes [1, 128]", "32");
-        cmdline.add("", "min-kconn",    "minimum connectivity factor [1, 16]", "1");
-        cmdline.add("", "max-kconn",    "maximum connectivity factor [1, 16]", "4");
+        cmdline.add("", "min-kconn",    "minimum connectivity factor [1, 128]", "1");
+        cmdline.add("", "max-kconn",    "maximum connectivity factor [1, 128] (use imaps for depthwise convolutions)", "4");
         cmdline.add("", "min-ksize",    "minimum kernel size [1, 15]", "1");
         cmdline.add("", "max-ksize",    "maximum kernel size [1, 15]", "9");
         cmdline.add("", "min-kdelta",   "minimum kernel stride [1, 3]", "1");
@@ -111,8 +111,8 @@ int main(int argc, const char *argv[])
         const auto cmd_irows = clamp(cmdline.get<int>("irows"), 16, 128);
         const auto cmd_icols = clamp(cmdline.get<int>("icols"), 16, 128);
         const auto cmd_omaps = clamp(cmdline.get<int>("omaps"), 1, 128);
-        const auto cmd_min_kconn = clamp(cmdline.get<int>("min-kconn"), 1, 16);
-        const auto cmd_max_kconn = clamp(cmdline.get<int>("max-kconn"), cmd_min_kconn, 16);
+        const auto cmd_min_kconn = clamp(cmdline.get<int>("min-kconn"), 1, 128);
+        const auto cmd_max_kconn = clamp(cmdline.get<int>("max-kconn"), cmd_min_kconn, 128);
         const auto cmd_min_ksize = clamp(cmdline.get<int>("min-ksize"), 1, 15);
         const auto cmd_max_ksize = clamp(cmdline.get<int>("max-ksize"), cmd_min_ksize, 15);
         const auto cmd_min_kdelta = clamp(cmdline.get<int>("min-kdelta"), 1, 3);
@@ -4,6 +4,7 @@
 #include "core/cmdline.h"
 #include "core/measure.h"
 #include "tensor/numeric.h"
+#include "layers/gemm.h"
 #include <iostream>
 
 namespace
@@ -169,6 +170,21 @@ namespace
                 store(row, 2 * dims * dims * dims + dims * dims, [&] () { Z.noalias() = A * B.transpose() + C; });
         }
 
+        auto measure_gemm(const gemm_backend backend, const bool transa, const bool transb, const scalar_t beta,
+                const tensor_size_t dims, row_t& row)
+        {
+                auto A = make_matrix(dims, dims);
+                auto B = make_matrix(dims, dims);
+                auto Z = make_matrix(dims, dims);
+
+                set_gemm_backend(backend);
+                store(row, 2 * dims * dims * dims + (beta == 0 ? 0 : dims * dims), [&] ()
+                {
+                        gemm(A, transa, B, transb, Z, beta);
+                });
+                set_gemm_backend(gemm_backend::eigen);
+        }
+
         template <typename top>
         void foreach_dims(const tensor_size_t min, const tensor_size_t max, const top& op)
         {
@@ -214,6 +230,7 @@ int main(int argc, const char* argv[])
         cmdline.add("", "level1",       "benchmark level1 operations (vector-vector)");
         cmdline.add("", "level2",       "benchmark level2 operations (matrix-vector)");
         cmdline.add("", "level3",       "benchmark level3 operations (matrix-matrix)");
+        cmdline.add("", "gemm",         "benchmark the GEMM backends (matrix-matrix)");
 
         cmdline.process(argc, argv);
 
@@ -223,8 +240,9 @@ int main(int argc, const char* argv[])
         const auto level1 = cmdline.has("level1");
         const auto level2 = cmdline.has("level2");
         const auto level3 = cmdline.has("level3");
+        const auto gemm = cmdline.has("gemm");
 
-        if (!level1 && !level2 && !level3)
+        if (!level1 && !level2 && !level3 && !gemm)
         {
                 cmdline.usage();
         }
@@ -275,6 +293,37 @@ int main(int argc, const char* argv[])
                 }
                 std::cout << table;
         }
+        if (gemm)
+        {
+                const auto min = min_dims;
+                const auto max = max_dims;
+
+                table_t table;
+                fillheader(min, max, table);
+                for (const auto backend : enum_values<gemm_backend>())
+                {
+                        if (backend == gemm_backend::blas && !has_blas())
+                        {
+                                continue;
+                        }
+
+                        const auto name = to_string(backend);
+                        const auto op = [&] (const bool transa, const bool transb, const scalar_t beta)
+                        {
+                                return [=] (const tensor_size_t dims, row_t& row)
+                                {
+                                        measure_gemm(backend, transa, transb, beta, dims, row);
+                                };
+                        };
+
+                        foreach_dims_row(min, max, table.append() << (name + ": Z = AB"), op(false, false, 0));
+                        foreach_dims_row(min, max, table.append() << (name + ": Z = AB + Z"), op(false, false, 1));
+                        foreach_dims_row(min, max, table.append() << (name + ": Z = AB^t + Z"), op(false, true, 1));
+                        foreach_dims_row(min, max, table.append() << (name + ": Z = A^tB + Z"), op(true, false, 1));
+                        table.delim();
+                }
+                std::cout << table;
+        }
 
         return EXIT_SUCCESS;
 }
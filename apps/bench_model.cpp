@@ -3,6 +3,8 @@
 #include "model.h"
 #include "core/io.h"
 #include "core/table.h"
+#include "core/timer.h"
+#include "core/tpool.h"
 #include "accumulator.h"
 #include "core/cmdline.h"
 #include "core/algorithm.h"
@@ -35,11 +37,18 @@ int main(int argc, const char *argv[])
         cmdline.add("", "forward",      "evaluate the \'forward\' pass (output)");
         cmdline.add("", "backward",     "evaluate the \'backward' pass (gradient)");
         cmdline.add("", "detailed",     "print detailed measurements (e.g. per-layer)");
+        cmdline.add("", "layouts",      "tensor layouts to compare [nchw,nhwc]", "nchw,nhwc");
         cmdline.add("", "min-count",    "minimum number of samples in minibatch [1, 16]",  "1");
         cmdline.add("", "max-count",    "maximum number of samples in minibatch [1, 128]", "16");
+        cmdline.add("", "probes",       "timing mode of the probes [off,sampled,tsc,precise]", "precise");
+        cmdline.add("", "pipeline",     "compare data-parallel with pipeline-parallel execution using up to this number of stages", "0");
+        cmdline.add("", "pipeline-samples", "number of samples to process for each execution mode", "1024");
 
         cmdline.process(argc, argv);
 
+        // setup the timing of the (per node) operations
+        probe_t::mode(from_string<probe_mode>(cmdline.get<string_t>("probes")));
+
         // check arguments and options
         const auto cmd_task = cmdline.get<string_t>("task");
         const auto cmd_model = cmdline.get<string_t>("model");
@@ -47,8 +56,11 @@ int main(int argc, const char *argv[])
         const auto cmd_forward = cmdline.has("forward");
         const auto cmd_backward = cmdline.has("backward");
         const auto cmd_detailed = cmdline.has("detailed");
+        const auto cmd_layouts = split(cmdline.get<string_t>("layouts"), ",");
         const auto cmd_min_count = clamp(cmdline.get<size_t>("min-count"), 1, 16);
         const auto cmd_max_count = clamp(cmdline.get<size_t>("max-count"), cmd_min_count, 128);
+        const auto cmd_pipeline = cmdline.get<size_t>("pipeline");
+        const auto cmd_pipeline_samples = cmdline.get<size_t>("pipeline-samples");
 
         if (!cmd_forward && !cmd_backward)
         {
@@ -87,44 +99,57 @@ int main(int argc, const char *argv[])
 
         model_t model;
         checkpoint.step("configure model");
-        checkpoint.measure(model.from_json(json) && model.resize(task->idims(), task->odims()));
+        checkpoint.measure(model.from_json(json));
 
-        model.random();
-        model.describe();
-        if (model != *task)
+        // benchmark model for different tensor layouts and batch sizes
+        std::vector<std::pair<string_t, std::vector<probes_t>>> layout2probes;
+        for (const auto& cmd_layout : cmd_layouts)
         {
-                log_error() << "model not compatible with the task!";
-                return EXIT_FAILURE;
-        }
-
-        // benchmark model for different batch sizes
-        std::vector<probes_t> batch2probes;
-        for (size_t count = cmd_min_count; count <= cmd_max_count; count *= 2)
-        {
-                const auto fold = fold_t{0, protocol::train};
-                const auto size = task->size(fold);
+                const auto layout = from_string<tensor_layout>(cmd_layout);
 
-                // measure processing
-                accumulator_t acc(model, *loss);
-                acc.mode((cmd_forward && !cmd_backward) ? accumulator_t::type::value : accumulator_t::type::vgrad);
+                model.layout(layout);
+                checkpoint.step(strcat("resize model using the <", cmd_layout, "> tensor layout"));
+                checkpoint.critical(model.resize(task->idims(), task->odims()));
 
-                for (size_t i = 0; i + count < size; i += count)
+                model.random();
+                model.describe();
+                if (model != *task)
                 {
-                        acc.update(*task, fold, i, i + count);
+                        log_error() << "model not compatible with the task!";
+                        return EXIT_FAILURE;
                 }
 
-                log_info() << "<<< processed [" << size << "] samples using minibatches of size " << count << ".";
+                std::vector<probes_t> batch2probes;
+                for (size_t count = cmd_min_count; count <= cmd_max_count; count *= 2)
+                {
+                        const auto fold = fold_t{0, protocol::train};
+                        const auto size = task->size(fold);
+
+                        // measure processing
+                        accumulator_t acc(model, *loss);
+                        acc.mode((cmd_forward && !cmd_backward) ? accumulator_t::type::value : accumulator_t::type::vgrad);
 
-                // filter probes
-                auto probes = acc.probes();
-                probes.erase(
-                        std::remove_if(probes.begin(), probes.end(), [&] (const probe_t& probe)
+                        for (size_t i = 0; i + count < size; i += count)
                         {
-                                return !starts_with(probe.fullname(), "model") && !cmd_detailed;
-                        }),
-                        probes.end());
+                                acc.update(*task, fold, i, i + count);
+                        }
+
+                        log_info() << "<<< processed [" << size << "] samples using minibatches of size " << count
+                                << " and the <" << cmd_layout << "> tensor layout.";
 
-                batch2probes.push_back(probes);
+                        // filter probes
+                        auto probes = acc.probes();
+                        probes.erase(
+                                std::remove_if(probes.begin(), probes.end(), [&] (const probe_t& probe)
+                                {
+                                        return !starts_with(probe.fullname(), "model") && !cmd_detailed;
+                                }),
+                                probes.end());
+
+                        batch2probes.push_back(probes);
+                }
+
+                layout2probes.emplace_back(cmd_layout, batch2probes);
         }
 
         // print results
@@ -147,35 +172,95 @@ int main(int argc, const char *argv[])
                 }
         }
         table.delim();
-        for (const auto& probe0 : batch2probes[0])
+        for (const auto& layout_probes : layout2probes)
         {
-                auto&& row = table.append();
-                row << probe0.fullname() << probe0.flops();
+                const auto& layout = layout_probes.first;
+                const auto& batch2probes = layout_probes.second;
 
-                for (const auto& probes : batch2probes)
+                for (const auto& probe0 : batch2probes[0])
                 {
-                        for (const auto& probe : probes)
+                        auto&& row = table.append();
+                        row << (layout + ":" + probe0.fullname()) << probe0.flops();
+
+                        for (const auto& probes : batch2probes)
                         {
-                                if (probe.fullname() != probe0.fullname())
+                                for (const auto& probe : probes)
                                 {
-                                        continue;
-                                }
+                                        if (probe.fullname() != probe0.fullname())
+                                        {
+                                                continue;
+                                        }
 
-                                if (probe.timings().min() < int64_t(1))
-                                {
-                                        row << "-";
+                                        if (probe.timings().min() < int64_t(1))
+                                        {
+                                                row << "-";
+                                        }
+                                        else
+                                        {
+                                                row << probe.gflops();
+                                        }
+                                        row << probe.timings().min() << probe.timings().avg() << probe.timings().max();
                                 }
-                                else
-                                {
-                                        row << probe.gflops();
-                                }
-                                row << probe.timings().min() << probe.timings().avg() << probe.timings().max();
                         }
                 }
+
+                if (&layout_probes != &*layout2probes.rbegin())
+                {
+                        table.delim();
+                }
         }
 
         std::cout << table;
 
+        // compare data-parallel with pipeline-parallel execution (using the last tensor layout)
+        if (cmd_pipeline > 1)
+        {
+                const auto fold = fold_t{0, protocol::train};
+                const auto size = std::min(task->size(fold), cmd_pipeline_samples);
+                const auto workers = tpool_t::instance().workers();
+
+                table_t ptable;
+                ptable.header() << "execution" << "#stages" << "#micro-batches" << "minibatch" << "samples/s" << "buffers[MB]";
+                ptable.delim();
+
+                for (size_t stages = 1; stages <= cmd_pipeline; stages *= 2)
+                {
+                        // NB: the stages are not balanced perfectly, so the model may be split in less stages
+                        const auto nstages = model.stages(stages).size() - 1;
+                        if (stages > 1 && nstages < 2)
+                        {
+                                continue;
+                        }
+
+                        for (size_t count = cmd_min_count; count <= cmd_max_count; count *= 2)
+                        {
+                                accumulator_t acc(model, *loss);
+                                acc.mode((cmd_forward && !cmd_backward) ? accumulator_t::type::value : accumulator_t::type::vgrad);
+                                acc.minibatch(count);
+                                acc.pipeline(stages);
+
+                                const nano::timer_t timer;
+                                acc.update(*task, fold, 0, size);
+                                const auto micros = std::max(timer.microseconds().count(), 1LL);
+
+                                // input-output buffers of the model copies or of the micro-batches in flight
+                                const auto nmicros = (stages > 1) ? (4 * nstages) : size_t(0);
+                                const auto xsize = (stages > 1) ?
+                                        static_cast<tensor_size_t>(nmicros) * model.xsize(static_cast<tensor_size_t>((count + nmicros - 1) / nmicros)) :
+                                        static_cast<tensor_size_t>(workers) * model.xsize(static_cast<tensor_size_t>(count));
+
+                                ptable.append()
+                                        << ((stages > 1) ? "pipeline-parallel" : "data-parallel")
+                                        << ((stages > 1) ? nstages : size_t(1))
+                                        << nmicros << count
+                                        << (static_cast<int64_t>(size) * 1000 * 1000 / micros)
+                                        << precision(3) << (static_cast<scalar_t>(xsize * sizeof(scalar_t)) / (1 << 20));
+                        }
+                }
+
+                std::cout << ptable;
+        }
+
         // OK
         return EXIT_SUCCESS;
 }
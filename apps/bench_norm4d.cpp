@@ -0,0 +1,185 @@
+#include "core/table.h"
+#include "core/numeric.h"
+#include "core/cmdline.h"
+#include "core/measure.h"
+#include "layers/norm4d.h"
+#include <iostream>
+
+using namespace nano;
+
+namespace
+{
+        const auto trials = size_t(16);
+
+        ///
+        /// \brief reference implementation: recomputes the sum & the sum of squares in ginput.
+        ///
+        struct norm4d_sum2_t
+        {
+                explicit norm4d_sum2_t(const norm3d_params_t& params) : m_params(params) {}
+
+                template <typename tiarray, typename toarray>
+                static void onorm(const tiarray& iarray, toarray&& oarray)
+                {
+                        const auto isum1 = iarray.sum();
+                        const auto isum2 = iarray.square().sum();
+                        const auto count = static_cast<scalar_t>(iarray.size());
+                        const auto imean = isum1 / count;
+                        const auto istdv = std::sqrt(isum2 * count - isum1 * isum1) / count;
+
+                        oarray = (iarray - imean) / istdv;
+                }
+
+                template <typename tiarray, typename toarray>
+                static void gnorm(tiarray&& iarray, const toarray& oarray)
+                {
+                        const auto isum1 = iarray.sum();
+                        const auto isum2 = iarray.square().sum();
+                        const auto count = static_cast<scalar_t>(iarray.size());
+                        const auto imean = isum1 / count;
+                        const auto istdv = std::sqrt(isum2 * count - isum1 * isum1) / count;
+
+                        const auto osum1 = oarray.sum();
+                        const auto oisum = (oarray * (iarray - imean)).sum();
+
+                        iarray = oarray / (istdv) -
+                                 osum1 / (count * istdv) -
+                                 (iarray - imean) * oisum / (count * istdv * istdv * istdv);
+                }
+
+                template <typename tidata, typename todata>
+                void output(const tidata& idata, todata&& odata)
+                {
+                        for (auto x = 0; x < idata.template size<0>(); ++ x)
+                        {
+                                if (m_params.m_ntype == norm_type::global)
+                                {
+                                        onorm(idata.array(x), odata.array(x));
+                                }
+                                else
+                                {
+                                        for (auto i = 0; i < idata.template size<1>(); ++ i)
+                                        {
+                                                onorm(idata.array(x, i), odata.array(x, i));
+                                        }
+                                }
+                        }
+                }
+
+                template <typename tidata, typename todata>
+                void ginput(tidata&& idata, const todata& odata) const
+                {
+                        for (auto x = 0; x < idata.template size<0>(); ++ x)
+                        {
+                                if (m_params.m_ntype == norm_type::global)
+                                {
+                                        gnorm(idata.array(x), odata.array(x));
+                                }
+                                else
+                                {
+                                        for (auto i = 0; i < idata.template size<1>(); ++ i)
+                                        {
+                                                gnorm(idata.array(x, i), odata.array(x, i));
+                                        }
+                                }
+                        }
+                }
+
+                norm3d_params_t m_params;
+        };
+
+        template <typename top>
+        auto measure_output(top& op, const tensor4d_t& idata, tensor4d_t& odata)
+        {
+                return measure<nanoseconds_t>([&] () { op.output(idata, odata); }, trials);
+        }
+
+        template <typename top>
+        auto measure_ginput(top& op, const tensor4d_t& idata, tensor4d_t& gdata, const tensor4d_t& odata)
+        {
+                // NB: the gradient wrt inputs overwrites its input buffer
+                return measure<nanoseconds_t>([&] () { gdata = idata; op.ginput(gdata, odata); }, trials);
+        }
+
+        template <typename tduration>
+        auto speedup(const tduration& reference, const tduration& duration)
+        {
+                return static_cast<double>(reference.count()) / static_cast<double>(std::max(duration.count(), decltype(duration.count())(1)));
+        }
+
+        void benchmark(const norm_type ntype, const int xmaps, const int xsize, const int count, table_t& table)
+        {
+                const auto params = norm3d_params_t{xmaps, xsize, xsize, ntype};
+                const auto config = strcat("norm=", to_string(ntype), ",maps=", xmaps, ",rows=", xsize, ",cols=", xsize, ",count=", count);
+
+                auto idata = params.make_xdata(count); idata.random(-1, +1);
+                auto odata = params.make_xdata(count); odata.random(-1, +1);
+                auto gdata = idata;
+
+                auto op0 = norm4d_sum2_t{params};
+                const auto output0 = measure_output(op0, idata, odata);
+                const auto ginput0 = measure_ginput(op0, idata, gdata, odata);
+
+                auto op1 = norm4d_t{params};
+                const auto output1 = measure_output(op1, idata, odata);
+                const auto ginput1 = measure_ginput(op1, idata, gdata, odata);
+
+                table.append()
+                        << config
+                        << precision(1) << (output0.count() / 1e+3) << precision(1) << (ginput0.count() / 1e+3)
+                        << precision(1) << (output1.count() / 1e+3) << precision(1) << (ginput1.count() / 1e+3)
+                        << precision(2) << speedup(output0, output1) << precision(2) << speedup(ginput0, ginput1);
+        }
+}
+
+int main(int argc, const char *argv[])
+{
+        // parse the command line
+        cmdline_t cmdline("benchmark normalization operators");
+        cmdline.add("", "min-size",     "minimum input size (rows = cols) [4, 128]", "8");
+        cmdline.add("", "max-size",     "maximum input size (rows = cols) [4, 256]", "64");
+        cmdline.add("", "maps",         "number of feature maps [1, 256]", "32");
+        cmdline.add("", "count",        "number of samples in minibatch [1, 128]", "32");
+
+        cmdline.process(argc, argv);
+
+        // check arguments and options
+        const auto cmd_min_size = clamp(cmdline.get<int>("min-size"), 4, 128);
+        const auto cmd_max_size = clamp(cmdline.get<int>("max-size"), cmd_min_size, 256);
+        const auto cmd_maps = clamp(cmdline.get<int>("maps"), 1, 256);
+        const auto cmd_count = clamp(cmdline.get<int>("count"), 1, 128);
+
+        table_t table;
+        table.header()
+                << ""
+                << colspan(2) << alignment::center << colfill('=') << "sum & sum2[us]"
+                << colspan(2) << alignment::center << colfill('=') << "cached stats[us]"
+                << colspan(2) << alignment::center << colfill('=') << "speedup";
+        table.delim();
+        table.append()
+                << "config"
+                << "output" << "ginput"
+                << "output" << "ginput"
+                << "output" << "ginput";
+        table.delim();
+
+        // benchmark for different normalization types and input sizes
+        const auto ntypes = enum_values<norm_type>();
+        for (const auto ntype : ntypes)
+        {
+                if (ntype != *ntypes.begin())
+                {
+                        table.delim();
+                }
+                for (auto size = cmd_min_size; size <= cmd_max_size; size *= 2)
+                {
+                        benchmark(ntype, cmd_maps, size, cmd_count, table);
+                }
+        }
+
+        // print results
+        std::cout << table;
+
+        // OK
+        return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+#include "task.h"
+#include "core/io.h"
+#include "core/table.h"
+#include "core/tpool.h"
+#include "core/cmdline.h"
+#include "core/measure.h"
+#include "core/checkpoint.h"
+#include <iostream>
+
+using namespace nano;
+
+static bool load_json(const string_t& path, json_t& json, string_t& id)
+{
+        string_t config;
+        const auto ret = load_string(path, config);
+        json = json_t::parse(config);
+        return ret && from_json(json, "type", id);
+}
+
+int main(int argc, const char *argv[])
+{
+        // parse the command line
+        cmdline_t cmdline("benchmark building the minibatches of a task (e.g. with and without augmentation)");
+        cmdline.add("", "task",         join(get_tasks().ids()) + " (.json)");
+        cmdline.add("", "min-count",    "minimum number of samples in minibatch [1, 1024]",  "16");
+        cmdline.add("", "max-count",    "maximum number of samples in minibatch [1, 1024]", "256");
+        cmdline.add("", "trials",       "number of measurements (the fastest is reported)", "3");
+
+        cmdline.process(argc, argv);
+
+        // check arguments and options
+        const auto cmd_task = cmdline.get<string_t>("task");
+        const auto cmd_min_count = clamp(cmdline.get<size_t>("min-count"), 1, 1024);
+        const auto cmd_max_count = clamp(cmdline.get<size_t>("max-count"), cmd_min_count, 1024);
+        const auto cmd_trials = clamp(cmdline.get<size_t>("trials"), 1, 100);
+
+        checkpoint_t checkpoint;
+        json_t json;
+        string_t id;
+
+        // load task
+        checkpoint.step(strcat("load task configuration from <", cmd_task, ">"));
+        checkpoint.critical(load_json(cmd_task, json, id));
+
+        rtask_t task;
+        checkpoint.step(strcat("search task <", id, ">"));
+        checkpoint.critical((task = get_tasks().get(id)) != nullptr);
+
+        task->from_json(json);
+        checkpoint.step(strcat("load task <", id, ">"));
+        checkpoint.measure(task->load());
+
+        task->describe(id);
+
+        // the vision tasks augment only the training samples (if configured),
+        //      so the training and the validation folds give the throughput with and without augmentation
+        json_t config;
+        task->to_json(config);
+
+        size_t crop = 0, flip = 0;
+        scalar_t jitter = 0;
+        from_json(config, "crop", crop, "flip", flip, "jitter", jitter);
+        const auto augmented = crop > 0 || flip > 0 || jitter > 0;
+
+        table_t table;
+        {
+                auto&& header = table.header();
+                header << "fold" << "augmentation" << "#samples";
+                for (size_t count = cmd_min_count; count <= cmd_max_count; count *= 2)
+                {
+                        header << strcat("ksamples/s x", count);
+                }
+        }
+        table.delim();
+
+        for (const auto p : {protocol::train, protocol::valid, protocol::test})
+        {
+                const auto fold = fold_t{0, p};
+                const auto size = task->size(fold);
+
+                auto&& row = table.append();
+                row << to_string(p) << ((p == protocol::train && augmented) ? "on" : "off") << size;
+
+                for (size_t count = cmd_min_count; count <= cmd_max_count; count *= 2)
+                {
+                        // build all minibatches concurrently (like when training)
+                        const auto batches = size / count;
+                        if (batches == 0)
+                        {
+                                row << "-";
+                                continue;
+                        }
+
+                        const auto duration = measure<microseconds_t>([&] ()
+                        {
+                                loopi(batches, size_t(1), [&] (const size_t begin, const size_t end)
+                                {
+                                        for (size_t batch = begin; batch < end; ++ batch)
+                                        {
+                                                const auto minibatch = task->get(fold, batch * count, batch * count + count);
+                                                (void)minibatch;
+                                        }
+                                });
+                        }, cmd_trials);
+
+                        const auto samples = static_cast<double>(batches * count);
+                        const auto ksamples = 1e+3 * samples / static_cast<double>(std::max(duration.count(), decltype(duration.count())(1)));
+                        row << precision(1) << ksamples;
+                }
+        }
+
+        // print results
+        std::cout << table;
+
+        // OK
+        return EXIT_SUCCESS;
+}
@@ -0,0 +1,78 @@
+#include "core/io.h"
+#include "core/cmdline.h"
+#include "core/checkpoint.h"
+#include "tasks/task_stream.h"
+
+using namespace nano;
+
+static bool load_json(const string_t& path, json_t& json, string_t& id)
+{
+        string_t config;
+        const auto ret = load_string(path, config);
+        json = json_t::parse(config);
+        return ret && from_json(json, "type", id);
+}
+
+int main(int argc, const char *argv[])
+{
+        // parse the command line
+        cmdline_t cmdline("convert a task to the binary format streamed by the out-of-core task");
+        cmdline.add("", "task",         join(get_tasks().ids()) + " (.json)");
+        cmdline.add("", "output",       "path to the binary file to write");
+        cmdline.add("", "shm",          "name of the shared memory segment to publish instead (e.g. /mnist)");
+        cmdline.add("", "remove",       "remove the shared memory segment with the given name (e.g. /mnist)");
+        cmdline.add("", "block",        "number of samples per block (read at once when streaming)", "1024");
+
+        cmdline.process(argc, argv);
+
+        checkpoint_t checkpoint;
+        json_t json;
+        string_t id;
+
+        // remove the shared memory segment
+        if (cmdline.has("remove"))
+        {
+                const auto cmd_remove = cmdline.get<string_t>("remove");
+                checkpoint.step(strcat("remove shared memory segment <", cmd_remove, ">"));
+                checkpoint.critical(stream_task_t::unpublish(cmd_remove));
+
+                log_info() << done;
+                return EXIT_SUCCESS;
+        }
+
+        // check arguments and options
+        const auto cmd_task = cmdline.get<string_t>("task");
+        const auto cmd_shm = cmdline.has("shm");
+        const auto cmd_output = cmdline.get<string_t>(cmd_shm ? "shm" : "output");
+        const auto cmd_block = cmdline.get<size_t>("block");
+
+        // load task
+        checkpoint.step(strcat("load task configuration from <", cmd_task, ">"));
+        checkpoint.critical(load_json(cmd_task, json, id));
+
+        rtask_t task;
+        checkpoint.step(strcat("search task <", id, ">"));
+        checkpoint.critical((task = get_tasks().get(id)) != nullptr);
+
+        task->from_json(json);
+        checkpoint.step(strcat("load task <", id, ">"));
+        checkpoint.measure(task->load());
+
+        task->describe(id);
+
+        // convert task
+        if (cmd_shm)
+        {
+                checkpoint.step(strcat("publish task to shared memory segment <", cmd_output, ">"));
+                checkpoint.measure(stream_task_t::publish(*task, cmd_output, cmd_block));
+        }
+        else
+        {
+                checkpoint.step(strcat("write task to <", cmd_output, ">"));
+                checkpoint.measure(stream_task_t::save(*task, cmd_output, cmd_block));
+        }
+
+        // OK
+        log_info() << done;
+        return EXIT_SUCCESS;
+}
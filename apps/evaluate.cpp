@@ -28,9 +28,13 @@ int main(int argc, const char *argv[])
         cmdline.add("", "fold",         "fold index to use for evaluation", "0");
         cmdline.add("", "loss",         join(get_losses().ids()) + " (.json)");
         cmdline.add("", "model",        "path to the trained model (.model)");
+        cmdline.add("", "probes",       "timing mode of the probes [off,sampled,tsc,precise]", "off");
 
         cmdline.process(argc, argv);
 
+        // setup the timing of the (per node) operations
+        probe_t::mode(from_string<probe_mode>(cmdline.get<string_t>("probes")));
+
         // check arguments and options
         const auto cmd_task = cmdline.get<string_t>("task");
         const auto cmd_fold = cmdline.get<size_t>("fold");
@@ -0,0 +1,67 @@
+#include "model.h"
+#include "core/cmdline.h"
+#include "core/algorithm.h"
+#include "core/checkpoint.h"
+
+using namespace nano;
+
+int main(int argc, const char *argv[])
+{
+        // parse the command line
+        cmdline_t cmdline("prune the affine nodes of a trained model");
+        cmdline.add("", "model",        "path to the trained model (.model)");
+        cmdline.add("", "output",       "path to save the pruned model (.model)");
+        cmdline.add("", "density",      "fraction of weights to keep (the largest in magnitude) (0, 1]", "0.1");
+        cmdline.add("", "nodes",        "names of the affine nodes to prune (e.g. fc1,fc2), all affine nodes if not given");
+
+        cmdline.process(argc, argv);
+
+        // check arguments and options
+        const auto cmd_model = cmdline.get<string_t>("model");
+        const auto cmd_output = cmdline.get<string_t>("output");
+        const auto cmd_density = cmdline.get<scalar_t>("density");
+
+        checkpoint_t checkpoint;
+
+        // load model
+        checkpoint.step(strcat("load model from <", cmd_model, ">"));
+
+        model_t model;
+        checkpoint.critical(model.load(cmd_model));
+
+        model.describe();
+
+        // select the nodes to prune
+        strings_t nodes;
+        if (cmdline.has("nodes"))
+        {
+                nodes = split(cmdline.get<string_t>("nodes"), ",");
+        }
+        else
+        {
+                for (const auto& json_node : model.to_json()["nodes"])
+                {
+                        if (json_node["type"].get<string_t>() == affine_node_name())
+                        {
+                                nodes.push_back(json_node["name"].get<string_t>());
+                        }
+                }
+        }
+
+        // prune model
+        for (const auto& node : nodes)
+        {
+                checkpoint.step(strcat("prune node <", node, "> to density <", cmd_density, ">"));
+                checkpoint.critical(model.prune(node, cmd_density));
+        }
+
+        model.describe();
+
+        // save model
+        checkpoint.step(strcat("save model to <", cmd_output, ">"));
+        checkpoint.critical(model.save(cmd_output));
+
+        // OK
+        log_info() << done;
+        return EXIT_SUCCESS;
+}
@@ -5,6 +5,7 @@
 #include "trainer.h"
 #include "core/table.h"
 #include "accumulator.h"
+#include "core/algorithm.h"
 #include "core/cmdline.h"
 #include "core/checkpoint.h"
 #include <iostream>
@@ -31,16 +32,24 @@ int main(int argc, const char *argv[])
         cmdline_t cmdline("train a model");
         cmdline.add("", "task",         join(get_tasks().ids()) + " (.json)");
         cmdline.add("", "model",        "model configuration (.json)");
+        cmdline.add("", "init",         "fine-tune a previously trained model (.model) instead of the model configuration");
+        cmdline.add("", "freeze",       "names of the nodes to freeze when fine-tuning (e.g. conv1,conv2)");
         cmdline.add("", "trainer",      join(get_trainers().ids()) + " (.json)");
         cmdline.add("", "loss",         join(get_losses().ids()) + " (.json)");
         cmdline.add("", "basepath",     "basepath where to save results (e.g. model, logs, history)");
         cmdline.add("", "trials",       "number of trials/folds", 10);
+        cmdline.add("", "probes",       "timing mode of the probes [off,sampled,tsc,precise]", "off");
 
         cmdline.process(argc, argv);
 
+        // setup the timing of the (per node) operations
+        probe_t::mode(from_string<probe_mode>(cmdline.get<string_t>("probes")));
+
         // check arguments and options
         const auto cmd_task = cmdline.get<string_t>("task");
-        const auto cmd_model = cmdline.get<string_t>("model");
+        const auto cmd_init = cmdline.has("init");
+        const auto cmd_model = cmdline.get<string_t>(cmd_init ? "init" : "model");
+        const auto cmd_freeze = cmdline.has("freeze") ? split(cmdline.get<string_t>("freeze"), ",") : strings_t();
         const auto cmd_trainer = cmdline.get<string_t>("trainer");
         const auto cmd_loss = cmdline.get<string_t>("loss");
         const auto cmd_basepath = cmdline.get<string_t>("basepath");
@@ -83,12 +92,26 @@ int main(int argc, const char *argv[])
         trainer->from_json(json);
 
         // load model
-        checkpoint.step(strcat("load model configuration from <", cmd_model, ">"));
-        checkpoint.critical(load_json(cmd_model, json));
-
         model_t model;
-        checkpoint.step("configure model");
-        checkpoint.measure(model.from_json(json) && model.resize(task->idims(), task->odims()));
+        if (cmd_init)
+        {
+                checkpoint.step(strcat("load model from <", cmd_model, ">"));
+                checkpoint.measure(model.load(cmd_model));
+        }
+        else
+        {
+                checkpoint.step(strcat("load model configuration from <", cmd_model, ">"));
+                checkpoint.critical(load_json(cmd_model, json));
+
+                checkpoint.step("configure model");
+                checkpoint.measure(model.from_json(json) && model.resize(task->idims(), task->odims()));
+        }
+
+        if (!cmd_freeze.empty())
+        {
+                checkpoint.step(strcat("freeze nodes <", join(cmd_freeze), ">"));
+                checkpoint.critical(model.freeze(cmd_freeze));
+        }
 
         model.describe();
         if (model != *task)
@@ -99,6 +122,7 @@ int main(int argc, const char *argv[])
 
         // setup accumulator
         accumulator_t acc(model, *loss);
+        const auto init_params = model.params();
 
         table_t table;
         table.header()
@@ -113,7 +137,14 @@ int main(int argc, const char *argv[])
         // train & save the model using multiple trials
         for (size_t trial = 0; trial < cmd_trials; ++ trial)
         {
-                acc.random();
+                if (cmd_init)
+                {
+                        acc.params(init_params);
+                }
+                else
+                {
+                        acc.random();
+                }
                 trainer_result_t result;
                 checkpoint.step("train model");
                 checkpoint.measure((result = trainer->train(*task, trial % task->fsize(), acc)) == true);
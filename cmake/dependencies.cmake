@@ -13,3 +13,13 @@ include_directories(SYSTEM ${LibArchive_INCLUDE_DIRS})
 # Eigen
 find_package(Eigen3 3.3 REQUIRED)
 include_directories(SYSTEM ${EIGEN3_INCLUDE_DIR} ${EIGEN3_INCLUDE_DIR}/../)
+
+# BLAS (optional)
+if(NANO_WITH_BLAS)
+        find_package(BLAS)
+        if(BLAS_FOUND)
+                add_definitions(-DNANO_WITH_BLAS)
+        else()
+                set(NANO_WITH_BLAS OFF)
+        endif()
+endif()
@@ -16,4 +16,5 @@ option(NANO_WITH_TIME_REPORT            "report detailed compilation time"
 option(NANO_WITH_CLANG_TIDY             "create clang-tidy target for static analysis"                  OFF)
 option(NANO_WITH_TUNE_NATIVE            "tune for the native platform (-mtune=native -march=native)"    ON)
 option(NANO_WITH_COVERAGE               "build with support for code coverage"                          OFF)
+option(NANO_WITH_BLAS                   "use a system BLAS library as GEMM backend (if available)"      ON)
 option(NANO_WITH_TESTS                  "build the unit tests"                                          ON)
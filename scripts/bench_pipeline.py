@@ -0,0 +1,42 @@
+import os
+import json
+import config
+import subprocess
+
+# benchmark:
+# - compare data-parallel with pipeline-parallel execution of the forward and backward passes
+# - deep convolution networks on the MNIST and the CIFAR10 image classification tasks
+cfg = config.config()
+outdir = os.path.join(cfg.expdir, "bench_pipeline")
+os.makedirs(outdir, exist_ok = True)
+
+def save_json(path, parameters, indent=4):
+        """ save the given parameters as json """
+        with open(path, "w") as output:
+                output.write(json.dumps(parameters, indent=indent))
+        return path
+
+def deep_cnn(omaps, depth):
+        """ create a deep convolution network of the given depth (3x3 convolutions with the same number of feature maps) """
+        nodes, names = [], []
+        for i in range(depth):
+                cn = {"name":"cn{}".format(i + 1),"type":"conv3d","omaps":omaps,"krows":3,"kcols":3,"kconn":1,"kdrow":1,"kdcol":1}
+                ac = {"name":"ac{}".format(i + 1),"type":"act-snorm"}
+                nodes += [cn, ac]
+                names += [cn["name"], ac["name"]]
+
+        output = {"name":"output","type":"affine","omaps":10,"orows":1,"ocols":1}
+        nodes.append(output)
+        names.append(output["name"])
+        return {"nodes": nodes, "model": [names]}
+
+loss = save_json(os.path.join(outdir, "loss.json"), cfg.loss("s-logistic"))
+model = save_json(os.path.join(outdir, "model.json"), deep_cnn(omaps = 32, depth = 8))
+
+for name, task in (("mnist", cfg.task_mnist()), ("cifar10", cfg.task_cifar10())):
+        task = save_json(os.path.join(outdir, "task_" + name + ".json"), task)
+        subprocess.check_call([cfg.app_bench_model,
+                "--task", task, "--model", model, "--loss", loss,
+                "--forward", "--backward", "--layouts", "nchw",
+                "--min-count", "16", "--max-count", "128",
+                "--pipeline", "8", "--pipeline-samples", "2048"])
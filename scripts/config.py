@@ -15,6 +15,7 @@ class config:
                 self.app_train = os.path.join(crtpath, build_folder, "apps", "train")
                 self.app_stats = os.path.join(crtpath, build_folder, "apps", "stats")
                 self.app_tabulate = os.path.join(crtpath, build_folder, "apps", "tabulate")
+                self.app_bench_model = os.path.join(crtpath, build_folder, "apps", "bench_model")
 
         def losses(self):
                 """ available loss functions"""
@@ -52,10 +53,11 @@ class config:
                 assert(solver in self.stoch_solvers())
                 return {"type": "stoch", "solver": solver, "epochs": epochs, "patience": patience, "epsilon": epsilon}
 
-        def batch_trainer(self, solver, epochs = 100, patience = 10, epsilon = 1e-6):
-                """ create a batch trainer """
+        def batch_trainer(self, solver, epochs = 100, patience = 10, epsilon = 1e-6, deterministic = 0, pipeline = 0):
+                """ create a batch trainer (pipeline-parallel if using at least two stages) """
                 assert(solver in self.batch_solvers())
-                return {"type": "batch", "solver": solver, "epochs": epochs, "patience": patience, "epsilon": epsilon}
+                return {"type": "batch", "solver": solver, "epochs": epochs, "patience": patience, "epsilon": epsilon,
+                        "deterministic": deterministic, "pipeline": pipeline}
 
         def loss(self, loss):
                 """ create a loss """
@@ -1,4 +1,5 @@
 #include "core/tpool.h"
+#include "core/logger.h"
 #include "accumulator.h"
 
 using namespace nano;
@@ -26,10 +27,24 @@ void accumulator_t::clear()
         }
 }
 
+static auto sample_key(const task_t& task, const fold_t& fold, const size_t index)
+{
+        return std::make_pair(task.ihash(fold, index), task.ohash(fold, index));
+}
+
 void accumulator_t::random()
 {
-        origin().m_model->random();
-        params(origin().m_model->params());
+        auto& model = *origin().m_model;
+        model.random();
+        for (auto& tcache : m_tcaches)
+        {
+                if (&tcache != &origin())
+                {
+                        tcache.m_model = model.clone();
+                }
+        }
+        m_fcaches.clear();
+        params(model.params());
 }
 
 void accumulator_t::params(const vector_t& params)
@@ -56,6 +71,51 @@ void accumulator_t::lambda(const scalar_t lambda)
 void accumulator_t::minibatch(const size_t minibatch_size)
 {
         m_batch = minibatch_size;
+        if (m_stages.size() <= 2)
+        {
+                for (auto& tcache : m_tcaches)
+                {
+                        tcache.m_model->reserve(static_cast<tensor_size_t>(m_batch));
+                }
+        }
+}
+
+void accumulator_t::threads(const size_t threads)
+{
+        const auto& model = *origin().m_model;
+        while (m_tcaches.size() < threads)
+        {
+                m_tcaches.emplace_back(model);
+                m_tcaches.rbegin()->m_model->reserve(static_cast<tensor_size_t>(m_batch));
+        }
+        while (m_tcaches.size() > std::max(threads, size_t(1)))
+        {
+                m_tcaches.pop_back();
+        }
+        clear();
+}
+
+void accumulator_t::pipeline(const size_t stages)
+{
+        auto& model = *origin().m_model;
+        const auto pipelined = m_stages.size() > 2;
+
+        m_stages = model.stages(std::max(stages, size_t(1)));
+        if (m_stages.size() > 2)
+        {
+                // NB: the micro-batches share the parameters of the origin's model, so its copies are not needed
+                threads(1);
+                model.micros(4 * (m_stages.size() - 1));
+
+                log_info() << "accumulator: pipeline-parallel execution using [" << (m_stages.size() - 1)
+                        << "] stages and [" << model.micros() << "] micro-batches.";
+        }
+        else if (pipelined)
+        {
+                model.micros(0);
+                threads(tpool_t::instance().workers());
+        }
+        clear();
 }
 
 void accumulator_t::update(const task_t& task, const fold_t& fold)
@@ -63,30 +123,201 @@ void accumulator_t::update(const task_t& task, const fold_t& fold)
         update(task, fold, 0, task.size(fold));
 }
 
+void accumulator_t::deterministic(const bool enable)
+{
+        m_deterministic = enable;
+        clear();
+}
+
 void accumulator_t::update(const task_t& task, const fold_t& fold, const size_t begin, const size_t end)
 {
         assert(begin <= end);
         const auto old_count = vstats().count();
-        loopit(end - begin, m_batch, [&] (const size_t ibegin, const size_t iend, const size_t thread)
+        if (m_stages.size() > 2)
         {
-                assert(thread < m_tcaches.size());
-                assert(ibegin < iend && iend + begin <= end);
-                update(m_tcaches[thread], task.get(fold, begin + ibegin, begin + iend));
-        });
-        accumulate();
+                pipeline(task, fold, begin, end);
+        }
+        else
+        {
+                const auto* fcache = this->fcache(task, fold);
+                update(task, fold, fcache, begin, end);
+                if (m_deterministic)
+                {
+                        reduce();
+                }
+                else
+                {
+                        accumulate();
+                }
+        }
         NANO_UNUSED1_RELEASE(old_count);
         assert(old_count + end == begin + vstats().count());
 }
 
+void accumulator_t::update(const task_t& task, const fold_t& fold, const fcache_t* fcache, const size_t begin, const size_t end)
+{
+        const auto threads = m_tcaches.size();
+        if (m_deterministic)
+        {
+                // NB: the blocks of samples are always the same, independent of the number of threads,
+                //      and they are accumulated one per thread at a time to bound the memory usage
+                const auto blocks = (end - begin + m_batch - 1) / m_batch;
+                m_pcaches.resize(threads);
+
+                for (size_t gbegin = 0; gbegin < blocks; gbegin += threads)
+                {
+                        const auto gsize = std::min(threads, blocks - gbegin);
+                        loopit(gsize, size_t(1), gsize, [&] (const size_t bbegin, const size_t bend, const size_t thread)
+                        {
+                                assert(thread < m_tcaches.size());
+                                for (auto b = bbegin; b < bend; ++ b)
+                                {
+                                        const auto ibegin = begin + (gbegin + b) * m_batch;
+                                        const auto iend = std::min(ibegin + m_batch, end);
+
+                                        auto& pcache = m_pcaches[b];
+                                        pcache.clear(m_type, psize());
+                                        pcache.swap(m_tcaches[thread]);
+                                        update(m_tcaches[thread], fcache, task, fold, ibegin, iend);
+                                        pcache.swap(m_tcaches[thread]);
+                                }
+                        });
+
+                        for (size_t b = 0; b < gsize; ++ b)
+                        {
+                                push(m_pcaches[b]);
+                        }
+                }
+        }
+        else
+        {
+                loopit(end - begin, m_batch, threads, [&] (const size_t ibegin, const size_t iend, const size_t thread)
+                {
+                        assert(thread < m_tcaches.size());
+                        assert(ibegin < iend && iend + begin <= end);
+                        update(m_tcaches[thread], fcache, task, fold, begin + ibegin, begin + iend);
+                });
+        }
+}
+
 void accumulator_t::update(tcache_t& tcache, const minibatch_t& minibatch)
 {
         update(tcache, minibatch.odata(), minibatch.idata());
 }
 
-void accumulator_t::update(tcache_t& tcache, const tensor4d_t& targets, const tensor4d_t& inputs)
+const accumulator_t::fcache_t* accumulator_t::fcache(const task_t& task, const fold_t& fold)
+{
+        // NB: the augmented samples are different each time, so their outputs cannot be reused
+        auto& model = *origin().m_model;
+        if (model.prefix_size() == 0 || task.augmented(fold))
+        {
+                return nullptr;
+        }
+
+        json_t json;
+        task.to_json(json);
+        const auto config = json.dump();
+
+        // NB: the cached folds of another task are discarded (e.g. a new task allocated at the same address)
+        if (    !m_fcaches.empty() &&
+                (m_fcaches.begin()->m_task != &task || m_fcaches.begin()->m_config != config))
+        {
+                m_fcaches.clear();
+        }
+
+        const auto size = task.size(fold);
+        const auto it = std::find_if(m_fcaches.begin(), m_fcaches.end(), [&] (const fcache_t& fcache)
+        {
+                return  fcache.m_fold == fold &&
+                        fcache.m_fdata.size<0>() == static_cast<tensor_size_t>(size);
+        });
+        if (it != m_fcaches.end())
+        {
+                return &(*it);
+        }
+
+        // compute the outputs of the frozen prefix for all samples
+        fcache_t fcache;
+        fcache.m_task = &task;
+        fcache.m_config = config;
+        fcache.m_fold = fold;
+        fcache.m_fdata.resize(cat_dims(static_cast<tensor_size_t>(size), model.prefix_odims()));
+        fcache.m_odata.resize(cat_dims(static_cast<tensor_size_t>(size), task.odims()));
+
+        loopit(size, m_batch, m_tcaches.size(), [&] (const size_t begin, const size_t end, const size_t thread)
+        {
+                const auto minibatch = task.get(fold, begin, end);
+                const auto fdata = m_tcaches[thread].m_model->prefix_output(minibatch.idata());
+
+                const auto fsize = nano::size(model.prefix_odims());
+                const auto osize = nano::size(task.odims());
+                const auto ibegin = static_cast<tensor_size_t>(begin);
+                const auto icount = static_cast<tensor_size_t>(end - begin);
+
+                map_vector(fcache.m_fdata.data() + ibegin * fsize, icount * fsize) = fdata.vector();
+                map_vector(fcache.m_odata.data() + ibegin * osize, icount * osize) = minibatch.odata().vector();
+        });
+
+        for (size_t i = 0; i < size; ++ i)
+        {
+                fcache.m_rows[sample_key(task, fold, i)] = i;
+        }
+
+        m_fcaches.push_back(std::move(fcache));
+        return &(*m_fcaches.rbegin());
+}
+
+void accumulator_t::update(tcache_t& tcache, const fcache_t* pfcache,
+        const task_t& task, const fold_t& fold, const size_t begin, const size_t end)
+{
+        if (!pfcache)
+        {
+                update(tcache, task.get(fold, begin, end));
+                return;
+        }
+
+        const auto& fcache = *pfcache;
+
+        // NB: the samples may have been shuffled since caching
+        auto& fdata = tcache.m_fdata;
+        auto& targets = tcache.m_odata;
+        fdata.resize(cat_dims(static_cast<tensor_size_t>(end - begin), tcache.m_model->prefix_odims()));
+        targets.resize(cat_dims(static_cast<tensor_size_t>(end - begin), task.odims()));
+        for (size_t i = begin; i < end; ++ i)
+        {
+                const auto it = fcache.m_rows.find(sample_key(task, fold, i));
+                if (it == fcache.m_rows.end())
+                {
+                        // NB: the sample was not cached (e.g. its hashes changed), so evaluate the whole model
+                        update(tcache, task.get(fold, begin, end));
+                        return;
+                }
+
+                const auto row = static_cast<tensor_size_t>(it->second);
+                fdata.vector(static_cast<tensor_size_t>(i - begin)) = fcache.m_fdata.vector(row);
+                targets.vector(static_cast<tensor_size_t>(i - begin)) = fcache.m_odata.vector(row);
+        }
+
+        update(tcache, targets, fdata, true);
+}
+
+void accumulator_t::update(tcache_t& tcache, const tensor4d_t& targets, const tensor4d_t& inputs, const bool cached)
 {
-        const auto& outputs = tcache.m_model->output(inputs);
+        const auto& outputs = cached ?
+                tcache.m_model->suffix_output(inputs) :
+                tcache.m_model->output(inputs);
+
+        tensor4d_t vgrads;
+        update(tcache, targets, outputs, vgrads);
+
+        if (m_type == type::vgrad)
+        {
+                tcache.m_vgrad += tcache.m_model->gparam(vgrads);
+        }
+}
 
+void accumulator_t::update(tcache_t& tcache, const tensor4d_t& targets, const tensor4d_cmap_t& outputs, tensor4d_t& vgrads)
+{
         const auto values = m_loss.value(targets, outputs);
         const auto errors = m_loss.error(targets, outputs);
 
@@ -98,7 +329,71 @@ void accumulator_t::update(tcache_t& tcache, const tensor4d_t& targets, const te
 
         if (m_type == type::vgrad)
         {
-                tcache.m_vgrad += tcache.m_model->gparam(m_loss.vgrad(targets, outputs));
+                vgrads = m_loss.vgrad(targets, outputs);
+        }
+}
+
+void accumulator_t::pipeline(const task_t& task, const fold_t& fold, const size_t begin, const size_t end)
+{
+        auto& origin = this->origin();
+        auto& model = *origin.m_model;
+
+        // NB: each minibatch is split into micro-batches, all in flight at the same time
+        const auto stages = m_stages.size() - 1;
+        const auto micros = model.micros();
+        const auto msize = std::max((m_batch + micros - 1) / micros, size_t(1));
+
+        std::vector<minibatch_t> minibatches(micros);
+        std::vector<tensor4d_t> vgrads(micros);
+
+        // run the active stages in parallel at each time step, while stage s processes micro-batch t - delay(s)
+        const auto wavefront = [&] (const size_t count, const bool backward, const auto& op)
+        {
+                for (size_t t = 0; t + 1 < count + stages; ++ t)
+                {
+                        loopi(stages, size_t(1), [&] (const size_t sbegin, const size_t send)
+                        {
+                                for (auto s = sbegin; s < send; ++ s)
+                                {
+                                        const auto delay = backward ? (stages - 1 - s) : s;
+                                        if (t >= delay && t - delay < count)
+                                        {
+                                                op(s, t - delay);
+                                        }
+                                }
+                        });
+                }
+        };
+
+        for (auto gbegin = begin; gbegin < end; gbegin = std::min(gbegin + micros * msize, end))
+        {
+                const auto count = std::min(micros, (end - gbegin + msize - 1) / msize);
+
+                wavefront(count, false, [&] (const size_t s, const size_t m)
+                {
+                        auto& minibatch = minibatches[m];
+                        if (s == 0)
+                        {
+                                const auto mbegin = gbegin + m * msize;
+                                minibatch = task.get(fold, mbegin, std::min(mbegin + msize, end));
+                        }
+
+                        const auto outputs = model.output(m, minibatch.idata(), m_stages[s], m_stages[s + 1]);
+                        if (s + 1 == stages)
+                        {
+                                // NB: the micro-batches reach the last stage in order
+                                update(origin, minibatch.odata(), outputs, vgrads[m]);
+                        }
+                });
+
+                if (m_type == type::vgrad)
+                {
+                        // NB: the stages update disjoint segments of the gradient, each in the order of the micro-batches
+                        wavefront(count, true, [&] (const size_t s, const size_t m)
+                        {
+                                model.gparam(m, vgrads[m], m_stages[s], m_stages[s + 1], origin.m_vgrad);
+                        });
+                }
         }
 }
 
@@ -119,6 +414,46 @@ void accumulator_t::accumulate()
         }
 }
 
+void accumulator_t::push(pcache_t& pcache)
+{
+        // binary counter: merge the partial results of 2^k consecutive blocks as soon as available
+        if (m_ptop == m_pstack.size())
+        {
+                m_pstack.emplace_back();
+        }
+        m_pstack[m_ptop ++].swap(pcache);
+
+        while (m_ptop > 1 && m_pstack[m_ptop - 2].m_level == m_pstack[m_ptop - 1].m_level)
+        {
+                m_pstack[m_ptop - 2].merge(m_pstack[m_ptop - 1], m_type);
+                m_pstack[m_ptop - 2].m_level ++;
+                m_ptop --;
+        }
+}
+
+void accumulator_t::reduce()
+{
+        // merge the remaining partial results from the last (and smallest) to the first one
+        for ( ; m_ptop > 1; -- m_ptop)
+        {
+                m_pstack[m_ptop - 2].merge(m_pstack[m_ptop - 1], m_type);
+        }
+
+        if (m_ptop > 0)
+        {
+                auto& origin = this->origin();
+                const auto& pcache = m_pstack[0];
+
+                origin.m_vstats(pcache.m_vstats);
+                origin.m_estats(pcache.m_estats);
+                if (m_type == type::vgrad)
+                {
+                        origin.m_vgrad += pcache.m_vgrad;
+                }
+                m_ptop = 0;
+        }
+}
+
 accumulator_t::tcache_t& accumulator_t::origin()
 {
         return *m_tcaches.begin();
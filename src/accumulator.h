@@ -1,6 +1,8 @@
 #pragma once
 
+#include <unordered_map>
 #include "loss.h"
+#include "core/hash.h"
 #include "task.h"
 #include "model.h"
 
@@ -9,6 +11,13 @@ namespace nano
         ///
         /// \brief accumulate {loss value, error and gradient} over the given samples.
         ///
+        /// NB: the outputs of the model's frozen prefix (if any) are computed once per fold and then cached in memory
+        ///     (only for the last task used, as identified by its address and its JSON configuration),
+        ///     unless the fold is augmented on the fly.
+        /// NB: the deterministic reduction makes the results independent of the number of threads (see ::deterministic).
+        /// NB: the samples are processed either data-parallel (a model copy processes a minibatch / thread)
+        ///     or pipeline-parallel (a stage of the model processes a micro-batch / thread, see ::pipeline).
+        ///
         class NANO_PUBLIC accumulator_t
         {
         public:
@@ -44,6 +53,39 @@ namespace nano
                 void params(const vector_t& params);
                 void minibatch(const size_t minibatch_size);
 
+                ///
+                /// \brief number of threads (with their own model copy) to split the samples to
+                ///     (by default the number of workers of the thread pool)
+                ///
+                void threads(const size_t threads);
+
+                ///
+                /// \brief deterministic reduction: the samples are split in blocks of minibatch size,
+                ///     which are accumulated separately and then reduced following a fixed binary tree.
+                ///
+                /// NB: one block / thread is accumulated at a time and the partial results of 2^k consecutive blocks
+                ///     are merged as soon as available, so at most (#threads + log2(#blocks)) partial results are stored.
+                ///
+                /// NB: the results are bitwise reproducible, independent of the number of threads.
+                ///
+                void deterministic(const bool enable = true);
+
+                ///
+                /// \brief pipeline-parallel execution using (at most) the given number of stages:
+                ///     each minibatch is split into micro-batches that flow through the stages forward and then backward,
+                ///     so that the stages process different micro-batches concurrently.
+                ///
+                /// NB: the micro-batches share the parameters and the gradient of a single model
+                ///     (the model copies of the data-parallel threads are released),
+                ///     while each micro-batch in flight stores its own input-output buffers.
+                /// NB: four micro-batches are used per stage to keep the pipeline idle time low.
+                /// NB: the outputs of the frozen prefix (if any) are not cached,
+                ///     but the results are reproducible as the micro-batches are accumulated in a fixed order.
+                /// NB: data-parallel execution is used for less than two stages (the default).
+                /// NB: resets the accumulator (but keeps the other settings).
+                ///
+                void pipeline(const size_t stages);
+
                 ///
                 /// \brief resets accumulator (but keeps settings)
                 ///
@@ -109,11 +151,98 @@ namespace nano
                         vector_t        m_vgrad;        ///< gradient wrt parameters
                         tstats_t        m_vstats;       ///< statistics for the loss value
                         tstats_t        m_estats;       ///< statistics for the error function
+                        tensor4d_t      m_fdata;        ///< buffer: outputs of the frozen prefix for a minibatch
+                        tensor4d_t      m_odata;        ///< buffer: targets for a minibatch
+                };
+
+                ///
+                /// \brief cached outputs of the model's frozen prefix for all samples of a fold.
+                ///
+                /// NB: the cached samples are found by their (input hash, output hash) pair
+                ///     (the samples themselves are not compared, so colliding pairs share a row).
+                ///
+                struct fcache_t
+                {
+                        using tkey = std::pair<size_t, size_t>;         ///< (input hash, output hash)
+
+                        struct thash
+                        {
+                                size_t operator()(const tkey& key) const
+                                {
+                                        auto hash = key.first;
+                                        hash_combine(hash, key.second);
+                                        return hash;
+                                }
+                        };
+
+                        const task_t*   m_task{nullptr};        ///<
+                        string_t        m_config;               ///< JSON configuration of the task
+                        fold_t          m_fold{0, protocol::train};
+                        tensor4d_t      m_fdata;                ///< outputs of the frozen prefix / sample
+                        tensor4d_t      m_odata;                ///< targets / sample
+                        std::unordered_map<tkey, size_t, thash> m_rows; ///< sample hashes -> cached sample
                 };
 
                 void update(tcache_t&, const minibatch_t&);
-                void update(tcache_t&, const tensor4d_t& targets, const tensor4d_t& inputs);
+
+                ///
+                /// \brief partial results of a block of samples (for the deterministic reduction).
+                ///
+                struct pcache_t
+                {
+                        void clear(const type t, const tensor_size_t psize)
+                        {
+                                m_level = 0;
+                                m_vstats.clear();
+                                m_estats.clear();
+                                if (t == type::vgrad)
+                                {
+                                        m_vgrad.resize(psize);
+                                        m_vgrad.setZero();
+                                }
+                        }
+
+                        void swap(pcache_t& other)
+                        {
+                                std::swap(m_vgrad, other.m_vgrad);
+                                std::swap(m_vstats, other.m_vstats);
+                                std::swap(m_estats, other.m_estats);
+                                std::swap(m_level, other.m_level);
+                        }
+
+                        void swap(tcache_t& tcache)
+                        {
+                                std::swap(m_vgrad, tcache.m_vgrad);
+                                std::swap(m_vstats, tcache.m_vstats);
+                                std::swap(m_estats, tcache.m_estats);
+                        }
+
+                        void merge(const pcache_t& other, const type t)
+                        {
+                                m_vstats(other.m_vstats);
+                                m_estats(other.m_estats);
+                                if (t == type::vgrad)
+                                {
+                                        m_vgrad += other.m_vgrad;
+                                }
+                        }
+
+                        vector_t        m_vgrad;        ///< gradient wrt parameters
+                        tstats_t        m_vstats;       ///< statistics for the loss value
+                        tstats_t        m_estats;       ///< statistics for the error function
+                        size_t          m_level{0};     ///< the partial results of 2^level consecutive blocks
+                };
+
+                void update(const task_t&, const fold_t&, const fcache_t*, const size_t begin, const size_t end);
+                void update(tcache_t&, const fcache_t*, const task_t&, const fold_t&, const size_t begin, const size_t end);
+                void update(tcache_t&, const tensor4d_t& targets, const tensor4d_t& inputs, const bool cached = false);
+                void update(tcache_t&, const tensor4d_t& targets, const tensor4d_cmap_t& outputs, tensor4d_t& vgrads);
+                void pipeline(const task_t&, const fold_t&, const size_t begin, const size_t end);
                 void accumulate();
+                void push(pcache_t&);
+                void reduce();
+
+                const fcache_t* fcache(const task_t&, const fold_t&);
 
                 tcache_t& origin();
                 const tcache_t& origin() const;
@@ -122,7 +251,13 @@ namespace nano
                 mutable type            m_type;         ///<
                 const loss_t&           m_loss;         ///<
                 std::vector<tcache_t>   m_tcaches;      ///< cache / thread
+                std::vector<fcache_t>   m_fcaches;      ///< cached outputs of the frozen prefix / fold (of the same task)
                 size_t                  m_batch{1024};  ///< maximum number of samples to process at once / thread
+                std::vector<pcache_t>   m_pcaches;      ///< deterministic reduction: partial results / block in progress
+                std::vector<pcache_t>   m_pstack;       ///< deterministic reduction: partial results to merge
+                size_t                  m_ptop{0};      ///< deterministic reduction: number of partial results to merge
+                bool                    m_deterministic{false};
+                indices_t               m_stages;       ///< pipeline-parallel execution: the first node of each stage
                 scalar_t                m_lambda{0};    ///< L2-regularization term
         };
 }
@@ -42,11 +42,21 @@ namespace nano
                         "omaps", omaps, "orows", orows, "ocols", ocols);
         }
 
+        template <typename tname>
+        json_t config_sparse_affine_node(const tname& name,
+                const tensor_size_t omaps, const tensor_size_t orows, const tensor_size_t ocols, const scalar_t density)
+        {
+                return to_json("name", name, "type", sparse_affine_node_name(),
+                        "omaps", omaps, "orows", orows, "ocols", ocols, "density", density);
+        }
+
         template <typename tname, typename ttype>
-        json_t config_activation_node(const tname& name, const ttype& type)
+        json_t config_activation_node(const tname& name, const ttype& type, const bool fast = false)
         {
                 assert(is_activation_node(type));
-                return to_json("name", name, "type", type);
+                return fast ?
+                        to_json("name", name, "type", type, "fast", 1) :
+                        to_json("name", name, "type", type);
         }
 
         template <typename tname>
@@ -33,6 +33,7 @@ namespace nano
                         m_type(other.m_type),
                         m_node(other.m_node->clone()),
                         m_inodes(other.m_inodes),
+                        m_frozen(other.m_frozen),
                         m_obegin(other.m_obegin),
                         m_pbegin(other.m_pbegin),
                         m_probe_output(other.m_probe_output),
@@ -93,25 +94,25 @@ namespace nano
                 ///
                 /// \brief compute the output (given the input & the parameters)
                 ///
-                void output(tensor4d_cmaps_t idata, vector_cmap_t pdata, tensor4d_map_t odata)
+                void output(const tensor4d_cmaps_t& idata, vector_cmap_t pdata, tensor4d_map_t odata)
                 {
-                        m_probe_output.measure([=] () { m_node->output(idata, pdata, odata); }, odata.size<0>());
+                        m_probe_output.measure([&] () { m_node->output(idata, pdata, odata); }, odata.size<0>());
                 }
 
                 ///
                 /// \brief compute the gradient wrt the inputs (given the output & the parameters)
                 ///
-                void ginput(tensor4d_maps_t idata, vector_cmap_t pdata, tensor4d_cmap_t odata)
+                void ginput(const tensor4d_maps_t& idata, vector_cmap_t pdata, tensor4d_cmap_t odata)
                 {
-                        m_probe_ginput.measure([=] () { m_node->ginput(idata, pdata, odata); }, odata.size<0>());
+                        m_probe_ginput.measure([&] () { m_node->ginput(idata, pdata, odata); }, odata.size<0>());
                 }
 
                 ///
                 /// \brief compute the (cumulated) gradient wrt the parameters (given the output & the input)
                 ///
-                void gparam(tensor4d_cmaps_t idata, vector_map_t pdata, tensor4d_cmap_t odata)
+                void gparam(const tensor4d_cmaps_t& idata, vector_map_t pdata, tensor4d_cmap_t odata)
                 {
-                        m_probe_gparam.measure([=] () { m_node->gparam(idata, pdata, odata); }, odata.size<0>());
+                        m_probe_gparam.measure([&] () { m_node->gparam(idata, pdata, odata); }, odata.size<0>());
                 }
 
                 // attributes
@@ -119,6 +120,7 @@ namespace nano
                 string_t        m_type;
                 rlayer_t        m_node;         ///< the computation node
                 indices_t       m_inodes;       ///< input nodes
+                bool            m_frozen{false}; ///< the parameters are not optimized (e.g. when fine-tuning)
                 tensor_size_t   m_obegin{0};    ///< offset of the output tensor
                 tensor_size_t   m_pbegin{0};    ///< offset of the parameter vector
                 probe_t         m_probe_output; ///< measure ::output() calls
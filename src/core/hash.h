@@ -1,9 +1,122 @@
 #pragma once
 
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <type_traits>
 
 namespace nano
 {
+        namespace detail
+        {
+                constexpr uint64_t hash_prime1 = 0x9E3779B185EBCA87ULL;
+                constexpr uint64_t hash_prime2 = 0xC2B2AE3D27D4EB4FULL;
+                constexpr uint64_t hash_prime3 = 0x165667B19E3779F9ULL;
+                constexpr uint64_t hash_prime4 = 0x85EBCA77C2B2AE63ULL;
+                constexpr uint64_t hash_prime5 = 0x27D4EB2F165667C5ULL;
+
+                inline uint64_t hash_rotl(const uint64_t x, const int r)
+                {
+                        return (x << r) | (x >> (64 - r));
+                }
+
+                inline uint64_t hash_read64(const unsigned char* p)
+                {
+                        uint64_t value;
+                        std::memcpy(&value, p, sizeof(value));
+                        return value;
+                }
+
+                inline uint64_t hash_read32(const unsigned char* p)
+                {
+                        uint32_t value;
+                        std::memcpy(&value, p, sizeof(value));
+                        return value;
+                }
+
+                inline uint64_t hash_round(uint64_t acc, const uint64_t input)
+                {
+                        acc += input * hash_prime2;
+                        acc = hash_rotl(acc, 31);
+                        return acc * hash_prime1;
+                }
+
+                inline uint64_t hash_merge(uint64_t acc, const uint64_t value)
+                {
+                        acc ^= hash_round(0, value);
+                        return acc * hash_prime1 + hash_prime4;
+                }
+        }
+
+        ///
+        /// \brief hash the given buffer (64-bit xxHash):
+        ///     the 32-byte blocks are processed by 4 independent lanes, so that the loop is pipelined (or vectorized).
+        ///
+        /// NB: much faster than combining the hashes of the elements one by one (e.g. for images or tensors).
+        ///
+        inline uint64_t hash_bytes(const void* data, const std::size_t size, const uint64_t seed = 0)
+        {
+                using namespace detail;
+
+                const auto* p = static_cast<const unsigned char*>(data);
+                const auto* const end = p + size;
+
+                uint64_t hash;
+                if (size >= 32)
+                {
+                        auto v1 = seed + hash_prime1 + hash_prime2;
+                        auto v2 = seed + hash_prime2;
+                        auto v3 = seed;
+                        auto v4 = seed - hash_prime1;
+
+                        for ( ; p + 32 <= end; p += 32)
+                        {
+                                v1 = hash_round(v1, hash_read64(p + 0));
+                                v2 = hash_round(v2, hash_read64(p + 8));
+                                v3 = hash_round(v3, hash_read64(p + 16));
+                                v4 = hash_round(v4, hash_read64(p + 24));
+                        }
+
+                        hash = hash_rotl(v1, 1) + hash_rotl(v2, 7) + hash_rotl(v3, 12) + hash_rotl(v4, 18);
+                        hash = hash_merge(hash, v1);
+                        hash = hash_merge(hash, v2);
+                        hash = hash_merge(hash, v3);
+                        hash = hash_merge(hash, v4);
+                }
+                else
+                {
+                        hash = seed + hash_prime5;
+                }
+
+                hash += static_cast<uint64_t>(size);
+
+                // remaining bytes
+                for ( ; p + 8 <= end; p += 8)
+                {
+                        hash ^= hash_round(0, hash_read64(p));
+                        hash = hash_rotl(hash, 27) * hash_prime1 + hash_prime4;
+                }
+                if (p + 4 <= end)
+                {
+                        hash ^= hash_read32(p) * hash_prime1;
+                        hash = hash_rotl(hash, 23) * hash_prime2 + hash_prime3;
+                        p += 4;
+                }
+                for ( ; p < end; ++ p)
+                {
+                        hash ^= (*p) * hash_prime5;
+                        hash = hash_rotl(hash, 11) * hash_prime1;
+                }
+
+                // avalanche
+                hash ^= hash >> 33;
+                hash *= hash_prime2;
+                hash ^= hash >> 29;
+                hash *= hash_prime3;
+                hash ^= hash >> 32;
+                return hash;
+        }
+
         ///
         /// \brief combine the current hash with the given value.
         ///
@@ -62,4 +175,14 @@ namespace nano
                 std::hash<tvalue> hasher;
                 return hash_range(begin, end, hasher);
         }
+
+        ///
+        /// \brief hash the given contiguous [begin, end) range of arithmetic values (e.g. the pixels of an image),
+        ///     using the 64-bit block hash of the underlying bytes.
+        ///
+        template <typename tscalar, typename = typename std::enable_if<std::is_arithmetic<tscalar>::value>::type>
+        inline std::size_t hash_range(tscalar* begin, tscalar* end)
+        {
+                return static_cast<std::size_t>(hash_bytes(begin, static_cast<std::size_t>(end - begin) * sizeof(tscalar)));
+        }
 }
@@ -308,18 +308,30 @@ bool image_t::save(const string_t& path) const
 tensor3d_t image_t::to_tensor() const
 {
         tensor3d_t ret(dims(), rows(), cols());
-        ret.vector() = m_data.vector().cast<scalar_t>() * static_cast<scalar_t>(1.0 / 255.0);
+        to_tensor(ret.tensor());
         return ret;
 }
 
 tensor3d_t image_t::to_tensor(const rect_t& rect) const
 {
         tensor3d_t ret(dims(), rect.height(), rect.width());
+        to_tensor(rect, ret.tensor());
+        return ret;
+}
+
+void image_t::to_tensor(tensor3d_map_t data) const
+{
+        assert(data.dims() == make_dims(dims(), rows(), cols()));
+        data.vector() = m_data.vector().cast<scalar_t>() * static_cast<scalar_t>(1.0 / 255.0);
+}
+
+void image_t::to_tensor(const rect_t& rect, tensor3d_map_t data) const
+{
+        assert(data.dims() == make_dims(dims(), rect.height(), rect.width()));
         for (auto i = 0; i < dims(); ++ i)
         {
-                ret.matrix(i) = plane(i, rect).cast<scalar_t>() * static_cast<scalar_t>(1.0 / 255.0);
+                data.matrix(i) = plane(i, rect).cast<scalar_t>() * static_cast<scalar_t>(1.0 / 255.0);
         }
-        return ret;
 }
 
 bool image_t::from_tensor(const tensor3d_t& data)
@@ -63,6 +63,12 @@ namespace nano
                 tensor3d_t to_tensor() const;
                 tensor3d_t to_tensor(const rect_t& region) const;
 
+                ///
+                /// \brief save image to the given scaled [0, 1] tensor (e.g. directly into a minibatch, without allocations)
+                ///
+                void to_tensor(tensor3d_map_t data) const;
+                void to_tensor(const rect_t& region, tensor3d_map_t data) const;
+
                 ///
                 /// \brief load image from scaled [0, 1] tensor
                 ///
@@ -102,6 +108,7 @@ namespace nano
                 bool is_rgba() const { return mode() == color_mode::rgba; }
                 bool is_luma() const { return mode() == color_mode::luma; }
                 color_mode mode() const;
+                const image_tensor_t& data() const { return m_data; }
 
                 auto plane(const coord_t band) const { return m_data.matrix(band); }
                 auto plane(const coord_t band) { return m_data.matrix(band); }
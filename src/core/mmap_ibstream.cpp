@@ -0,0 +1,93 @@
+#include "mmap_ibstream.h"
+#include <cstring>
+#include <algorithm>
+
+#if defined(_WIN32)
+        #include <fstream>
+#else
+        #include <fcntl.h>
+        #include <unistd.h>
+        #include <sys/mman.h>
+        #include <sys/stat.h>
+#endif
+
+using namespace nano;
+
+mmap_t::mmap_t(const std::string& path, const mmap_source source)
+{
+#if defined(_WIN32)
+        if (source != mmap_source::file)
+        {
+                return;
+        }
+
+        std::ifstream stream(path, std::ios::binary | std::ios::in | std::ios::ate);
+        if (stream.is_open())
+        {
+                m_buffer.resize(static_cast<std::size_t>(stream.tellg()));
+                stream.seekg(0);
+                if (stream.read(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size())))
+                {
+                        m_data = m_buffer.data();
+                        m_size = m_buffer.size();
+                }
+        }
+#else
+        const auto fd = (source == mmap_source::shm) ?
+                ::shm_open(path.c_str(), O_RDONLY, 0) :
+                ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+                return;
+        }
+
+        struct stat info;
+        if (::fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+                const auto size = static_cast<std::size_t>(info.st_size);
+                auto* data = ::mmap(nullptr, size, PROT_READ,
+                        (source == mmap_source::shm) ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+                if (data != MAP_FAILED)
+                {
+                        m_data = static_cast<const char*>(data);
+                        m_size = size;
+                }
+        }
+
+        // NB: the mapping is still valid after closing the file
+        ::close(fd);
+#endif
+}
+
+mmap_t::~mmap_t()
+{
+#if !defined(_WIN32)
+        if (m_data)
+        {
+                ::munmap(const_cast<char*>(m_data), m_size);
+        }
+#endif
+}
+
+std::streamsize mmap_ibstream_t::read(char* bytes, const std::streamsize num_bytes)
+{
+        const auto size = std::min(static_cast<std::size_t>(std::max(num_bytes, std::streamsize(0))), remaining());
+        if (size > 0)
+        {
+                std::memcpy(bytes, m_map.data() + m_index, size);
+                m_index += size;
+        }
+        return static_cast<std::streamsize>(size);
+}
+
+bool mmap_ibstream_t::read(std::string& str)
+{
+        std::streamsize size = 0;
+        if (read(size) && size >= 0 && static_cast<std::size_t>(size) <= remaining())
+        {
+                str.assign(m_map.data() + m_index, static_cast<std::size_t>(size));
+                m_index += static_cast<std::size_t>(size);
+                return true;
+        }
+        return false;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "arch.h"
+#include <string>
+#include <vector>
+#include <type_traits>
+
+namespace nano
+{
+        ///
+        /// \brief source of the memory mapped bytes.
+        ///
+        enum class mmap_source
+        {
+                file,           ///< regular file (mapped privately)
+                shm             ///< POSIX shared memory object (e.g. "/name", mapped shared by all processes)
+        };
+
+        ///
+        /// \brief read-only memory mapping of a file.
+        ///
+        class NANO_PUBLIC mmap_t
+        {
+        public:
+
+                ///
+                /// \brief constructor
+                ///
+                explicit mmap_t(const std::string& path, const mmap_source = mmap_source::file);
+
+                ///
+                /// \brief destructor
+                ///
+                ~mmap_t();
+
+                ///
+                /// \brief disable copying
+                ///
+                mmap_t(const mmap_t&) = delete;
+                mmap_t& operator=(const mmap_t&) = delete;
+
+                ///
+                /// \brief check if the file was mapped
+                ///
+                operator bool() const { return m_data != nullptr; }
+
+                const char* data() const { return m_data; }
+                std::size_t size() const { return m_size; }
+
+        private:
+
+                // attributes
+                const char*             m_data{nullptr};        ///< mapped memory
+                std::size_t             m_size{0};              ///< number of mapped bytes
+                std::vector<char>       m_buffer;               ///< file contents if memory mapping is not available
+        };
+
+        ///
+        /// \brief deserialize particular entities (e.g. strings, tensors, PODs) from a memory mapped file,
+        ///     using the binary format of obstream_t.
+        ///
+        /// NB: the file is not copied as a whole, so large binary files are read without buffering.
+        ///
+        class NANO_PUBLIC mmap_ibstream_t
+        {
+        public:
+
+                ///
+                /// \brief constructor
+                ///
+                explicit mmap_ibstream_t(const std::string& path, const mmap_source source = mmap_source::file) :
+                        m_map(path, source) {}
+
+                ///
+                /// \brief check if the file was mapped
+                ///
+                operator bool() const { return m_map; }
+
+                ///
+                /// \brief read a POD structure
+                ///
+                template <typename tstruct, typename = typename std::enable_if<std::is_pod<tstruct>::value>::type>
+                bool read(tstruct& pod)
+                {
+                        const auto size = static_cast<std::streamsize>(sizeof(pod));
+                        return read(reinterpret_cast<char*>(&pod), size) == size;
+                }
+
+                ///
+                /// \brief read a string
+                ///
+                bool read(std::string& str);
+
+                ///
+                /// \brief read given number of bytes
+                /// \return the number of bytes actually read
+                ///
+                std::streamsize read(char* bytes, const std::streamsize num_bytes);
+
+                ///
+                /// \brief read a ND tensor
+                ///
+                template <typename ttensor>
+                bool read_tensor(ttensor& t)
+                {
+                        typename ttensor::tdims dims;
+                        if (!read(dims))
+                        {
+                                return false;
+                        }
+
+                        // NB: check the dimensions before allocating (e.g. corrupted files)
+                        const auto max_count = remaining() / sizeof(typename ttensor::Scalar);
+                        std::size_t count = 1;
+                        for (const auto dim : dims)
+                        {
+                                if (dim < 0 || (dim > 0 && count > max_count / static_cast<std::size_t>(dim)))
+                                {
+                                        return false;
+                                }
+                                count *= static_cast<std::size_t>(dim);
+                        }
+                        t.resize(dims);
+
+                        const auto size = t.size() * static_cast<std::streamsize>(sizeof(typename ttensor::Scalar));
+                        return read(reinterpret_cast<char*>(t.data()), size) == size;
+                }
+
+                ///
+                /// \brief returns the number of bytes not read yet
+                ///
+                std::size_t remaining() const { return m_map.size() - m_index; }
+
+                ///
+                /// \brief returns the number of bytes read so far
+                ///
+                std::size_t tellg() const { return m_index; }
+
+                ///
+                /// \brief access the mapped bytes (e.g. to use them in place)
+                ///
+                const char* data() const { return m_map.data(); }
+                std::size_t size() const { return m_map.size(); }
+
+        private:
+
+                // attributes
+                mmap_t          m_map;          ///<
+                std::size_t     m_index{0};     ///< current position
+        };
+}
@@ -1,3 +1,4 @@
+#include <unistd.h>
 #include "obstream.h"
 
 using namespace nano;
@@ -7,9 +8,30 @@ obstream_t::obstream_t(const std::string& path) :
 {
 }
 
+obstream_t::obstream_t(const int fd) :
+        m_fd(fd)
+{
+}
+
 bool obstream_t::write(const char* bytes, const std::streamsize num_bytes)
 {
-        return m_stream.write(bytes, num_bytes).good();
+        if (m_fd < 0)
+        {
+                return m_stream.write(bytes, num_bytes).good();
+        }
+
+        for (auto remaining = num_bytes; remaining > 0; )
+        {
+                const auto ret = ::write(m_fd, bytes, static_cast<size_t>(remaining));
+                if (ret <= 0)
+                {
+                        return false;
+                }
+
+                bytes += ret;
+                remaining -= ret;
+        }
+        return true;
 }
 
 bool obstream_t::write(const std::string& str)
@@ -8,7 +8,7 @@
 namespace nano
 {
         ///
-        /// \brief wrapper over binary std::ofstream to serialize particular entities:
+        /// \brief wrapper over binary std::ofstream (or an open file descriptor) to serialize particular entities:
         ///     e.g. vectors, matrices, strings, tensors, PODs.
         ///
         class NANO_PUBLIC obstream_t
@@ -20,6 +20,12 @@ namespace nano
                 ///
                 explicit obstream_t(const std::string& path);
 
+                ///
+                /// \brief constructor: write to the given file descriptor (e.g. shared memory),
+                ///     which is not closed by the stream.
+                ///
+                explicit obstream_t(const int fd);
+
                 ///
                 /// \brief write a POD structure
                 ///
@@ -66,6 +72,7 @@ namespace nano
 
                 // attributes
                 std::ofstream   m_stream;
+                int             m_fd{-1};       ///< file descriptor to write to (if any)
         };
 
         template <typename tstruct, typename>
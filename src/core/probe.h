@@ -1,14 +1,83 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
+#include "cast.h"
 #include "stats.h"
 #include "measure.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define NANO_PROBE_TSC
+#endif
+
 namespace nano
 {
+        ///
+        /// \brief probe timing modes.
+        ///
+        enum class probe_mode
+        {
+                off,            ///< no measurement (the operations are called directly)
+                sampled,        ///< measure one every given number of calls (see probe_t::period)
+                tsc,            ///< measure all calls using the CPU's time-stamp counter (cheaper than the clock)
+                precise         ///< measure all calls using the high resolution clock
+        };
+
+        template <>
+        inline enum_map_t<probe_mode> enum_string<probe_mode>()
+        {
+                return
+                {
+                        { probe_mode::off,      "off" },
+                        { probe_mode::sampled,  "sampled" },
+                        { probe_mode::tsc,      "tsc" },
+                        { probe_mode::precise,  "precise" }
+                };
+        }
+
+        namespace detail
+        {
+                inline std::atomic<probe_mode>& probe_mode_flag()
+                {
+                        static std::atomic<probe_mode> mode{probe_mode::precise};
+                        return mode;
+                }
+
+                inline std::atomic<int64_t>& probe_period_flag()
+                {
+                        static std::atomic<int64_t> period{16};
+                        return period;
+                }
+
+#ifdef NANO_PROBE_TSC
+                ///
+                /// \brief number of time-stamp counter ticks per nanosecond (calibrated once against the clock).
+                ///
+                inline double tsc_ticks_per_nanosecond()
+                {
+                        static const double ticks = [] ()
+                        {
+                                const timer_t timer;
+                                const auto start = __rdtsc();
+
+                                int64_t nanoseconds = 0;
+                                while ((nanoseconds = timer.nanoseconds().count()) < 10 * 1000 * 1000)
+                                {
+                                }
+
+                                return static_cast<double>(__rdtsc() - start) / static_cast<double>(nanoseconds);
+                        }();
+                        return ticks;
+                }
+#endif
+        }
+
         ///
         /// \brief accumulate time measurements for a given operation of given complexity (aka flops).
         ///
+        /// NB: the timing mode is global and can be changed at runtime (e.g. turned off when training).
+        ///
         class probe_t
         {
         public:
@@ -24,13 +93,54 @@ namespace nano
                 {
                 }
 
+                ///
+                /// \brief change the timing mode of all probes
+                ///
+                static void mode(const probe_mode mode) { detail::probe_mode_flag() = mode; }
+                static probe_mode mode() { return detail::probe_mode_flag(); }
+
+                ///
+                /// \brief change the number of calls between two measurements in the sampled mode
+                ///
+                static void period(const int64_t period) { assert(period > 0); detail::probe_period_flag() = period; }
+                static int64_t period() { return detail::probe_period_flag(); }
+
                 template <typename toperator>
                 void measure(const toperator& op, const int64_t count = 1)
                 {
                         assert(count > 0);
-                        const timer_t timer;
-                        op();
-                        m_timings(timer.nanoseconds().count() / count);
+                        switch (mode())
+                        {
+                        case probe_mode::off:
+                                op();
+                                break;
+
+                        case probe_mode::sampled:
+                                if ((m_calls ++) % period() == 0)
+                                {
+                                        measure_clock(op, count);
+                                }
+                                else
+                                {
+                                        op();
+                                }
+                                break;
+
+                        case probe_mode::tsc:
+#ifdef NANO_PROBE_TSC
+                                {
+                                        const auto start = __rdtsc();
+                                        op();
+                                        const auto ticks = static_cast<double>(__rdtsc() - start);
+                                        m_timings(static_cast<int64_t>(ticks / detail::tsc_ticks_per_nanosecond()) / count);
+                                }
+                                break;
+#endif
+                        case probe_mode::precise:
+                        default:
+                                measure_clock(op, count);
+                                break;
+                        }
                 }
 
                 operator bool() const { return m_timings; }
@@ -45,10 +155,19 @@ namespace nano
 
         private:
 
+                template <typename toperator>
+                void measure_clock(const toperator& op, const int64_t count)
+                {
+                        const timer_t timer;
+                        op();
+                        m_timings(timer.nanoseconds().count() / count);
+                }
+
                 // attributes
                 std::string     m_basename;             ///<
                 std::string     m_fullname;             ///<
                 int64_t         m_flops;                ///< number of floating point operations per call
+                int64_t         m_calls{0};             ///< number of calls (for sampling)
                 timings_t       m_timings;              ///< time measurements
         };
 
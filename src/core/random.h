@@ -2,6 +2,7 @@
 
 #include <random>
 #include <cassert>
+#include <cstdint>
 #include <numeric>
 #include <algorithm>
 #include <type_traits>
@@ -25,6 +26,52 @@ namespace nano
                 return rng_t{std::random_device{}()};
         }
 
+        ///
+        /// \brief counter-based random number generator: the k-th value of the stream is computed by mixing
+        ///     the key and the counter k (splitmix64), so that independent and reproducible streams
+        ///     can be created for any key (e.g. per sample) without storing any state.
+        ///
+        class counter_rng_t
+        {
+        public:
+
+                using result_type = uint64_t;
+
+                explicit counter_rng_t(const uint64_t key) : m_key(key) {}
+
+                static constexpr result_type min() { return 0; }
+                static constexpr result_type max() { return ~result_type(0); }
+
+                result_type operator()()
+                {
+                        return mix(m_key + (++ m_counter) * 0x9E3779B97F4A7C15ULL);
+                }
+
+                ///
+                /// \brief mix the bits of the given value (a bijection)
+                ///
+                static uint64_t mix(uint64_t z)
+                {
+                        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                        return z ^ (z >> 31);
+                }
+
+                ///
+                /// \brief derive a key from the given key and value (e.g. seed and sample index)
+                ///
+                static uint64_t key(const uint64_t key, const uint64_t value)
+                {
+                        return mix(key ^ mix(value + 0x9E3779B97F4A7C15ULL));
+                }
+
+        private:
+
+                // attributes
+                uint64_t        m_key;          ///<
+                uint64_t        m_counter{0};   ///<
+        };
+
         ///
         /// \brief create an uniform distribution for the [min, max] range.
         ///
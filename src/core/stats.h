@@ -4,13 +4,19 @@
 #include <limits>
 #include <cassert>
 #include <ostream>
+#include <iterator>
 #include <algorithm>
+#include <type_traits>
 
 namespace nano
 {
         ///
         /// \brief computes statistics: average, standard deviation etc.
         ///
+        /// NB: the sums are stored in extended precision, so that updating and merging don't need divisions.
+        /// NB: the contiguous ranges of values are processed in blocks using independent lanes (vectorized),
+        ///     while the partial sums of each block are combined in extended precision.
+        ///
         template <typename tscalar = long double>
         class stats_t
         {
@@ -30,8 +36,8 @@ namespace nano
                 ///
                 void operator()(const tscalar value)
                 {
-                        m_avg1 += (value - m_avg1) / (m_count + 1);
-                        m_avg2 += (value * value - m_avg2) / (m_count + 1);
+                        m_sum1 += value;
+                        m_sum2 += static_cast<tstorage>(value) * value;
                         m_min = std::min(m_min, value);
                         m_max = std::max(m_max, value);
                         m_count ++;
@@ -49,8 +55,8 @@ namespace nano
                 ///
                 void operator()(const stats_t& other)
                 {
-                        m_avg1 = (m_avg1 * m_count + other.m_avg1 * other.m_count) / (m_count + other.m_count);
-                        m_avg2 = (m_avg2 * m_count + other.m_avg2 * other.m_count) / (m_count + other.m_count);
+                        m_sum1 += other.m_sum1;
+                        m_sum2 += other.m_sum2;
                         m_count += other.m_count;
                         m_min = std::min(m_min, other.m_min);
                         m_max = std::max(m_max, other.m_max);
@@ -62,10 +68,12 @@ namespace nano
                 template <typename titerator, typename = typename std::iterator_traits<titerator>::value_type>
                 void operator()(titerator begin, const titerator end)
                 {
-                        for ( ; begin != end; ++ begin)
-                        {
-                                operator()(*begin);
-                        }
+                        using contiguous = std::integral_constant<bool,
+                                std::is_floating_point<tscalar>::value &&
+                                std::is_pointer<titerator>::value &&
+                                std::is_same<std::remove_cv_t<std::remove_pointer_t<titerator>>, tscalar>::value>;
+
+                        update(begin, end, contiguous());
                 }
 
                 ///
@@ -74,8 +82,8 @@ namespace nano
                 void clear()
                 {
                         m_count = 0;
-                        m_avg1 = 0;
-                        m_avg2 = 0;
+                        m_sum1 = 0;
+                        m_sum2 = 0;
                         m_min = std::numeric_limits<tscalar>::max();
                         m_max = std::numeric_limits<tscalar>::lowest();
                 }
@@ -86,7 +94,7 @@ namespace nano
                 tscalar avg() const
                 {
                         assert(count() > 0);
-                        return static_cast<tscalar>(m_avg1);
+                        return static_cast<tscalar>(m_sum1 / m_count);
                 }
 
                 ///
@@ -95,7 +103,9 @@ namespace nano
                 tscalar var() const
                 {
                         assert(count() > 0);
-                        return std::max(static_cast<tscalar>(m_avg2 - m_avg1 * m_avg1), tscalar(0));
+                        const auto avg1 = m_sum1 / m_count;
+                        const auto avg2 = m_sum2 / m_count;
+                        return std::max(static_cast<tscalar>(avg2 - avg1 * avg1), tscalar(0));
                 }
 
                 ///
@@ -112,14 +122,66 @@ namespace nano
                 std::size_t count() const { return m_count; }
                 tscalar min() const { return m_min; }
                 tscalar max() const { return m_max; }
-                tscalar sum1() const { return static_cast<tscalar>(m_avg1 * m_count); }
-                tscalar sum2() const { return static_cast<tscalar>(m_avg2 * m_count); }
+                tscalar sum1() const { return static_cast<tscalar>(m_sum1); }
+                tscalar sum2() const { return static_cast<tscalar>(m_sum2); }
 
         private:
 
+                template <typename titerator>
+                void update(titerator begin, const titerator end, std::false_type)
+                {
+                        for ( ; begin != end; ++ begin)
+                        {
+                                operator()(*begin);
+                        }
+                }
+
+                void update(const tscalar* begin, const tscalar* end, std::true_type)
+                {
+                        // NB: the number of values per block bounds the rounding errors of the partial sums
+                        const std::ptrdiff_t lanes = 8, block = 32 * lanes;
+
+                        while (end - begin >= lanes)
+                        {
+                                const auto size = std::min(block, (end - begin) / lanes * lanes);
+
+                                tscalar psum1[lanes], psum2[lanes], pmin[lanes], pmax[lanes];
+                                for (std::ptrdiff_t k = 0; k < lanes; ++ k)
+                                {
+                                        psum1[k] = psum2[k] = 0;
+                                        pmin[k] = pmax[k] = begin[k];
+                                }
+
+                                for (std::ptrdiff_t i = 0; i < size; i += lanes)
+                                {
+                                        for (std::ptrdiff_t k = 0; k < lanes; ++ k)
+                                        {
+                                                const auto value = begin[i + k];
+                                                psum1[k] += value;
+                                                psum2[k] += value * value;
+                                                pmin[k] = (value < pmin[k]) ? value : pmin[k];
+                                                pmax[k] = (value > pmax[k]) ? value : pmax[k];
+                                        }
+                                }
+
+                                for (std::ptrdiff_t k = 0; k < lanes; ++ k)
+                                {
+                                        m_sum1 += psum1[k];
+                                        m_sum2 += psum2[k];
+                                        m_min = std::min(m_min, pmin[k]);
+                                        m_max = std::max(m_max, pmax[k]);
+                                }
+
+                                m_count += static_cast<std::size_t>(size);
+                                begin += size;
+                        }
+
+                        update(begin, end, std::false_type());
+                }
+
                 // attributes
                 std::size_t     m_count{0};
-                tstorage        m_avg1{0}, m_avg2{0};
+                tstorage        m_sum1{0}, m_sum2{0};
                 tscalar         m_min, m_max;
         };
 
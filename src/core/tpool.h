@@ -48,6 +48,15 @@ namespace nano
                 bool                            m_stop{false};          ///< stop requested
         };
 
+        ///
+        /// \brief flag set for the threads of the thread pool.
+        ///
+        inline bool& tpool_worker_flag()
+        {
+                static thread_local bool is_worker = false;
+                return is_worker;
+        }
+
         ///
         /// \brief worker to process tasks enqueued in a thread pool.
         ///
@@ -64,6 +73,8 @@ namespace nano
                 ///
                 void operator()() const
                 {
+                        tpool_worker_flag() = true;
+
                         while (true)
                         {
                                 tpool_task_t task;
@@ -112,10 +123,28 @@ namespace nano
                 ~tpool_section_t()
                 {
                         // block until all futures are done
+                        for (const auto& future : m_futures)
+                        {
+                                if (future.valid())
+                                {
+                                        future.wait();
+                                }
+                        }
+                }
+
+                ///
+                /// \brief block until all futures are done and rethrow the first exception raised by the tasks (if any).
+                ///
+                void wait()
+                {
                         for (const auto& future : m_futures)
                         {
                                 future.wait();
                         }
+                        for (auto& future : m_futures)
+                        {
+                                future.get();
+                        }
                 }
 
                 ///
@@ -186,6 +215,15 @@ namespace nano
                         return m_workers.size();
                 }
 
+                ///
+                /// \brief check if the calling thread is one of the worker threads
+                /// NB: useful to avoid waiting for tasks enqueued from a worker thread (potential deadlock)
+                ///
+                static bool is_worker()
+                {
+                        return tpool_worker_flag();
+                }
+
                 ///
                 /// \brief number of tasks still enqueued
                 ///
@@ -236,16 +274,16 @@ namespace nano
         };
 
         ///
-        /// \brief split a loop computation of the given size using a thread pool.
-        /// NB: the operator receives the range [begin, end) to process and the assigned thread index:
+        /// \brief split a loop computation of the given size in the given number of ranges using a thread pool.
+        /// NB: the operator receives the range [begin, end) to process and the assigned range index:
         ///     op(begin, end, thread)
+        /// NB: the number of ranges can differ from the number of workers (e.g. to match thread-specific caches).
         ///
         template <typename tsize, typename toperator>
-        void loopit(const tsize size, const tsize max_thread_chunk, const toperator& op)
+        void loopit(const tsize size, const tsize max_thread_chunk, const tsize workers, const toperator& op)
         {
                 auto& pool = tpool_t::instance();
 
-                const auto workers = static_cast<tsize>(pool.workers());
                 const auto thread_chunk = (size + workers - 1) / workers;
                 if (thread_chunk > tsize(0))
                 {
@@ -271,10 +309,24 @@ namespace nano
                                         }
                                 }));
                         }
-                        // NB: the section is destroyed here waiting for all tasks to finish!
+
+                        // NB: the exceptions raised by the tasks are propagated to the caller
+                        section.wait();
                 }
         }
 
+        ///
+        /// \brief split a loop computation of the given size using a thread pool.
+        /// NB: the operator receives the range [begin, end) to process and the assigned thread index:
+        ///     op(begin, end, thread)
+        ///
+        template <typename tsize, typename toperator>
+        void loopit(const tsize size, const tsize max_thread_chunk, const toperator& op)
+        {
+                const auto workers = static_cast<tsize>(tpool_t::instance().workers());
+                loopit(size, max_thread_chunk, workers, op);
+        }
+
         ///
         /// \brief split a loop computation of the given size using a thread pool.
         /// NB: the operator receives the range [begin, end) to process:
@@ -69,6 +69,16 @@ namespace nano
                         assert(index >= 0 && index < count());
                         assert(idata.dims() == idims());
                         m_idata.vector(index) = idata.vector();
+                        copy(index, odata, label);
+                }
+
+                ///
+                /// \brief set only the target of the given sample (e.g. the input is written in place using ::idata)
+                ///
+                template <typename totensor>
+                void copy(const tensor_size_t index, const totensor& odata, const string_t& label)
+                {
+                        assert(index >= 0 && index < count());
                         if (odata.size() == 0)
                         {
                                 m_odata.vector(0).setZero();
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>
+#include "cnode.h"
+
+namespace nano
+{
+        ///
+        /// \brief execution plan: the input, output and parameter maps of all computation nodes
+        ///     pre-resolved for the numbers of samples processed so far.
+        ///
+        /// NB: the forward and the backward passes don't allocate memory when following the plan.
+        /// NB: the maps point to the buffers of the owning model, so a copied plan is empty and needs to be recompiled.
+        ///
+        class cplan_t
+        {
+        public:
+
+                struct cstep_t
+                {
+                        tensor4d_cmaps_t        m_icdata;       ///< inputs
+                        tensor4d_maps_t         m_idata;        ///< gradients wrt the inputs
+                        tensor4d_cmap_t         m_ocdata;       ///< gradient wrt the output
+                        tensor4d_map_t          m_odata;        ///< output
+                        vector_cmap_t           m_pdata;        ///< parameters
+                        vector_map_t            m_gdata;        ///< (cumulated) gradient wrt the parameters (empty if frozen)
+                };
+
+                using csteps_t = std::vector<cstep_t>;
+
+                ///
+                /// \brief constructors & asignment operators
+                ///
+                cplan_t() = default;
+                cplan_t(const cplan_t&) {}
+                cplan_t(cplan_t&&) = default;
+                cplan_t& operator=(cplan_t&&) = default;
+                cplan_t& operator=(const cplan_t&) = delete;
+
+                ///
+                /// \brief map the given buffers for processing the given number of samples
+                ///     (the parameters of the frozen nodes are stored separately)
+                ///
+                const csteps_t& compile(const cnodes_t& nodes, const tensor_size_t count, const tensor3d_dim_t& idims,
+                        vector_t& xdata, const vector_t& pdata, const vector_t& fdata, vector_t& gdata)
+                {
+                        const auto& cxdata = xdata;
+
+                        csteps_t steps;
+                        steps.reserve(nodes.size());
+                        for (const auto& cnode : nodes)
+                        {
+                                steps.push_back(cstep_t{
+                                        cnode.idata(cxdata, count, nodes, idims),
+                                        cnode.idata(xdata, count, nodes, idims),
+                                        cnode.odata(cxdata, count),
+                                        cnode.odata(xdata, count),
+                                        cnode.pdata(cnode.m_frozen ? fdata : pdata),
+                                        cnode.m_frozen ? map_vector(gdata.data(), 0) : cnode.pdata(gdata)});
+                        }
+
+                        m_plans.emplace_back(count, std::move(steps));
+                        return m_plans.rbegin()->second;
+                }
+
+                ///
+                /// \brief retrieve the steps compiled for the given number of samples (if any)
+                ///
+                const csteps_t* find(const tensor_size_t count) const
+                {
+                        const auto it = std::find_if(m_plans.begin(), m_plans.end(),
+                                [=] (const auto& plan) { return plan.first == count; });
+                        return (it == m_plans.end()) ? nullptr : &it->second;
+                }
+
+                ///
+                /// \brief invalidate the plan
+                ///
+                void clear()
+                {
+                        m_plans.clear();
+                }
+
+        private:
+
+                // attributes
+                std::vector<std::pair<tensor_size_t, csteps_t>> m_plans;       ///< (number of samples, the maps of each node)
+        };
+}
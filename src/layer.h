@@ -4,6 +4,7 @@
 #include "tensor.h"
 #include "core/json.h"
 #include "core/factory.h"
+#include "tensor/layout.h"
 
 namespace nano
 {
@@ -22,9 +23,20 @@ namespace nano
         inline const char* conv3d_node_name() { return "conv3d"; }
         inline const char* norm3d_node_name() { return "norm3d"; }
         inline const char* affine_node_name() { return "affine"; }
+        inline const char* sparse_affine_node_name() { return "affine-sparse"; }
         inline const char* plus4d_node_name() { return "mix-plus"; }
         inline const char* tcat4d_node_name() { return "mix-tcat"; }
 
+        template <>
+        inline enum_map_t<tensor_layout> enum_string<tensor_layout>()
+        {
+                return
+                {
+                        { tensor_layout::nchw,  "nchw" },
+                        { tensor_layout::nhwc,  "nhwc" }
+                };
+        }
+
         ///
         /// \brief computation node.
         ///
@@ -42,20 +54,29 @@ namespace nano
                 ///
                 virtual bool resize(const tensor3d_dims_t& idims) = 0;
 
+                ///
+                /// \brief configure the memory layout of the input and output tensors (called before ::resize)
+                ///     returns false if the layout is not supported.
+                ///
+                virtual bool layout(const tensor_layout layout) { return layout == tensor_layout::nchw; }
+
                 ///
                 /// \brief compute the output (given the input & the parameters)
                 ///
-                virtual void output(tensor4d_cmaps_t idata, vector_cmap_t pdata, tensor4d_map_t odata) = 0;
+                virtual void output(const tensor4d_cmaps_t& idata, vector_cmap_t pdata, tensor4d_map_t odata) = 0;
 
                 ///
                 /// \brief compute the gradient wrt the inputs (given the output & the parameters)
                 ///
-                virtual void ginput(tensor4d_maps_t idata, vector_cmap_t pdata, tensor4d_cmap_t odata) = 0;
+                /// NB: ::ginput and ::gparam may reuse the state cached by the last call to ::output,
+                ///     so they must be called after ::output on the same inputs and parameters.
+                ///
+                virtual void ginput(const tensor4d_maps_t& idata, vector_cmap_t pdata, tensor4d_cmap_t odata) = 0;
 
                 ///
                 /// \brief compute the (cumulated) gradient wrt the parameters (given the output & the input)
                 ///
-                virtual void gparam(tensor4d_cmaps_t idata, vector_map_t pdata, tensor4d_cmap_t odata) = 0;
+                virtual void gparam(const tensor4d_cmaps_t& idata, vector_map_t pdata, tensor4d_cmap_t odata) = 0;
 
                 ///
                 /// \brief set parameters to random values
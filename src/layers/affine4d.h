@@ -1,5 +1,6 @@
 #pragma once
 
+#include "gemm.h"
 #include "affine_params.h"
 #include "tensor/numeric.h"
 
@@ -9,6 +10,8 @@ namespace nano
         /// \brief affine transformation with 4D input and output tensors using
         ///     level-3 Blas calls (thus processing all samples at once).
         ///
+        /// NB: the matrix multiplications are dispatched to the current GEMM backend.
+        ///
         /// parameters:
         ///     idata: 4D input tensor (count x imaps x irows x icols, with isize = imaps x irows x icols)
         ///     wdata: weight matrix (osize x isize)
@@ -68,7 +71,8 @@ namespace nano
                 auto midata = idata.reshape(count, isize).matrix();
                 auto modata = odata.reshape(count, osize).matrix();
 
-                modata.noalias() = (midata * wdata.transpose()).rowwise() + bdata.transpose();
+                modata.rowwise() = bdata.transpose();
+                gemm(midata, false, wdata, true, modata, 1);
         }
 
         template <typename tidata, typename twdata, typename tbdata, typename todata>
@@ -84,7 +88,7 @@ namespace nano
                 auto midata = idata.reshape(count, isize).matrix();
                 auto modata = odata.reshape(count, osize).matrix();
 
-                midata.transpose().noalias() = wdata.transpose() * modata.transpose();
+                gemm(modata, false, wdata, false, midata, 0);
         }
 
         template <typename tidata, typename twdata, typename tbdata, typename todata>
@@ -99,7 +103,7 @@ namespace nano
                 auto midata = idata.reshape(count, isize).matrix();
                 auto modata = odata.reshape(count, osize).matrix();
 
-                wdata.noalias() = modata.transpose() * midata;
+                gemm(modata, true, midata, false, wdata, 0);
                 bdata.noalias() = modata.colwise().sum();
         }
 }
@@ -1,7 +1,9 @@
 #pragma once
 
+#include "gemm.h"
 #include "conv_utils.h"
 #include "conv3d_params.h"
+#include "tensor/layout.h"
 
 namespace nano
 {
@@ -9,8 +11,18 @@ namespace nano
         /// \brief convolution transformation with 4D input and output tensors using
         ///     efficient level-3 BLAS calls.
         ///
+        /// NB: the matrix multiplications are dispatched to the current GEMM backend.
         /// NB: the 3D convolutions and correlations are replaced with matrix multiplications.
         /// NB: requires extra buffers.
+        /// NB: the input and the output planes are split into kconn groups (group g = planes with index % kconn == g)
+        ///     and each group is processed with its own (smaller) matrix multiplication.
+        /// NB: the depthwise case (kconn == imaps) is processed directly without the extra buffers.
+        /// NB: the input and the output tensors can be stored either as channels-first (nchw) or as channels-last (nhwc).
+        ///     The channels-last case unrolls the input patches per output pixel with contiguous copies
+        ///     and it always uses the matrix multiplications.
+        /// NB: the channels-last case caches the reordered kernels and the unrolled input patches in ::output
+        ///     to be reused by ::ginput and ::gparam. Thus these must be called after ::output
+        ///     on the same inputs and kernels (checked in debug builds).
         ///
         /// parameters:
         ///     idata: 4D input tensor (count x imaps x irows x icols, with isize = imaps x irows x icols)
@@ -27,7 +39,8 @@ namespace nano
                 ///
                 /// \brief constructor
                 ///
-                explicit conv4d_t(const conv3d_params_t& params = conv3d_params_t());
+                explicit conv4d_t(const conv3d_params_t& params = conv3d_params_t(),
+                        const tensor_layout layout = tensor_layout::nchw);
 
                 ///
                 /// \brief output
@@ -54,25 +67,120 @@ namespace nano
 
         private:
 
+                template <typename tidata, typename tkdata, typename tbdata, typename todata>
+                void output_nhwc(const tidata&, const tkdata&, const tbdata&, todata&&);
+
+                template <typename tidata, typename tkdata, typename tbdata, typename todata>
+                void ginput_nhwc(tidata&&, const tkdata&, const tbdata&, const todata&);
+
+                template <typename tidata, typename tkdata, typename tbdata, typename todata>
+                void gparam_nhwc(const tidata&, tkdata&&, tbdata&&, const todata& odata);
+
+                template <typename timatrix, typename tomatrix>
+                void img2col_nhwc(const timatrix& imat, tomatrix&& omat) const;
+
+                template <typename tkdata>
+                bool cached_kdata(const tkdata&) const;
+
+                template <typename tidata>
+                bool cached_idata(const tidata&) const;
+
+                template <typename timatrix, typename tomatrix>
+                void col2img_nhwc(timatrix&& imat, const tomatrix& omat) const;
+
+                bool depthwise() const
+                {
+                        return  m_layout == tensor_layout::nchw &&
+                                m_params.kconn() > 1 && m_params.kconn() == m_params.imaps();
+                }
+
+                tensor_size_t gimaps() const { return m_params.imaps() / m_params.kconn(); }
+                tensor_size_t gomaps() const { return m_params.omaps() / m_params.kconn(); }
+                tensor_size_t ksize2() const { return m_params.krows() * m_params.kcols(); }
+                tensor_size_t osize2() const { return m_params.orows() * m_params.ocols(); }
+
+                ///
+                /// \brief row offset of the given input plane in the unrolled buffers (grouped by connectivity)
+                ///
+                tensor_size_t krow(const tensor_size_t i) const
+                {
+                        const auto kconn = m_params.kconn();
+                        return ((i % kconn) * gimaps() + i / kconn) * ksize2();
+                }
+
+                ///
+                /// \brief column offset of the given input plane and kernel offset in the unrolled buffers (channels-last)
+                ///
+                tensor_size_t kcol(const tensor_size_t i, const tensor_size_t k) const
+                {
+                        const auto kconn = m_params.kconn();
+                        return (i % kconn) * gimaps() * ksize2() + k * gimaps() + i / kconn;
+                }
+
+                ///
+                /// \brief map the convolution kernels of the given group: (omaps/kconn, imaps/kconn x krows x kcols)
+                ///
+                template <typename tkdata>
+                auto gkdata(tkdata&& kdata, const tensor_size_t g) const
+                {
+                        const auto cols = gimaps() * ksize2();
+                        return map_matrix(kdata.data() + g * cols, gomaps(), cols, m_params.kconn() * cols);
+                }
+
+                ///
+                /// \brief map the output planes of the given group: (omaps/kconn, orows x ocols)
+                ///
+                template <typename todata>
+                auto godata(todata&& xodata, const tensor_size_t g) const
+                {
+                        const auto cols = osize2();
+                        return map_matrix(xodata.data() + g * cols, gomaps(), cols, m_params.kconn() * cols);
+                }
+
+                ///
+                /// \brief map the input plane block of the given kernel offset: (orows, ocols)
+                ///
+                template <typename tmatrix>
+                auto gidata(tmatrix&& imat, const tensor_size_t kr, const tensor_size_t kc) const
+                {
+                        const auto drows = m_params.kdrow(), dcols = m_params.kdcol();
+                        return map_matrix(imat.data() + kr * imat.cols() + kc,
+                                m_params.orows(), m_params.ocols(), drows * imat.cols(), dcols);
+                }
+
                 // attributes
                 conv3d_params_t m_params;
-                matrix_t        m_okdata;       ///< buffer: (omaps, imaps x krows x kcols)
-                matrix_t        m_xkdata;       ///< buffer: (omaps, imaps x krows x kcols)
-                tensor3d_t      m_kodata;       ///< buffer: (count, imaps x krows x kcols, orows x ocols)
-                matrix_t        m_kxdata;       ///< buffer: (imaps x krows x kcols, orows x ocols)
+                tensor_layout   m_layout;
+                tensor3d_t      m_kodata;       ///< buffer: (at least count, imaps x krows x kcols, orows x ocols), transposed if nhwc
+                matrix_t        m_kxdata;       ///< buffer: (imaps x krows x kcols, orows x ocols), transposed if nhwc
+                matrix_t        m_okdata;       ///< buffer: (omaps, imaps/kconn x krows x kcols), only if nhwc
+                matrix_t        m_xkdata;       ///< buffer: (omaps, imaps/kconn x krows x kcols), only if nhwc
         };
 
-        inline conv4d_t::conv4d_t(const conv3d_params_t& params) :
-                m_params(params)
+        inline conv4d_t::conv4d_t(const conv3d_params_t& params, const tensor_layout layout) :
+                m_params(params),
+                m_layout(layout)
         {
                 const auto imaps = m_params.imaps();
                 const auto krows = m_params.krows(), kcols = m_params.kcols();
                 const auto omaps = m_params.omaps(), orows = m_params.orows(), ocols = m_params.ocols();
 
                 // allocate buffers
-                m_okdata.resize(omaps, imaps * krows * kcols);
-                m_xkdata.resize(omaps, imaps * krows * kcols);
-                m_kxdata.resize(imaps * krows * kcols, orows * ocols);
+                switch (m_layout)
+                {
+                case tensor_layout::nchw:
+                        if (!depthwise())
+                        {
+                                m_kxdata.resize(imaps * krows * kcols, orows * ocols);
+                        }
+                        break;
+
+                case tensor_layout::nhwc:
+                        m_kxdata.resize(orows * ocols, imaps * krows * kcols);
+                        m_okdata.resize(omaps, gimaps() * krows * kcols);
+                        m_xkdata.resize(omaps, gimaps() * krows * kcols);
+                        break;
+                }
         }
 
         template <typename tidata, typename tkdata, typename tbdata, typename todata>
@@ -80,55 +188,79 @@ namespace nano
         {
                 assert(m_params.valid(idata, kdata, bdata, odata));
 
+                if (m_layout == tensor_layout::nhwc)
+                {
+                        output_nhwc(idata, kdata, bdata, odata);
+                        return;
+                }
+
                 const auto count = idata.template size<0>();
                 const auto imaps = m_params.imaps();
                 const auto kconn = m_params.kconn(), krows = m_params.krows(), kcols = m_params.kcols();
                 const auto omaps = m_params.omaps(), orows = m_params.orows(), ocols = m_params.ocols();
                 const auto drows = m_params.kdrow(), dcols = m_params.kdcol();
 
-                switch (kconn)
+                if (depthwise())
                 {
-                case 1:
-                        m_okdata = kdata.reshape(omaps, imaps * krows * kcols).matrix();
-                        break;
-
-                default:
-                        m_okdata.setZero();
-                        for (tensor_size_t o = 0; o < omaps; ++ o)
+                        for (tensor_size_t x = 0; x < count; ++ x)
                         {
-                                for (tensor_size_t i = o % kconn, ik = 0; i < imaps; i += kconn, ++ ik)
+                                auto xidata = idata.tensor(x);
+                                auto xodata = odata.tensor(x);
+
+                                // bias
+                                xodata.reshape(omaps, orows * ocols).matrix().colwise() = bdata;
+
+                                // +convolution
+                                for (tensor_size_t o = 0; o < omaps; ++ o)
                                 {
-                                        m_okdata.row(o).segment(i * krows * kcols, krows * kcols) =
-                                        kdata.vector(o, ik);
+                                        const auto imat = xidata.matrix(o % kconn);
+                                        const auto kmat = kdata.matrix(o, 0);
+
+                                        auto omat = xodata.matrix(o);
+                                        for (tensor_size_t kr = 0; kr < krows; ++ kr)
+                                        {
+                                                for (tensor_size_t kc = 0; kc < kcols; ++ kc)
+                                                {
+                                                        omat.array() += kmat(kr, kc) * gidata(imat, kr, kc).array();
+                                                }
+                                        }
                                 }
                         }
-                        break;
+                        return;
                 }
 
-//                output[x] = kernel * input[x]
+//                output[x] = kernel * input[x] (for each group g)
 //
-//                oodata                  = okdata *                         kodata
-//                (omaps, orows * ocols)  = (omaps, imaps * krows * kcols) x (imaps * krows * kcols, orows * ocols)
+//                oodata                          = okdata *                                 kodata
+//                (omaps/kconn, orows * ocols)    = (omaps/kconn, imaps/kconn * krows * kcols) x (imaps/kconn * krows * kcols, orows * ocols)
 
-                m_kodata.resize(count, imaps * krows * kcols, orows * ocols);
+                const auto grows = gimaps() * krows * kcols;
+
+                if (m_kodata.size<0>() < count)
+                {
+                        m_kodata.resize(count, imaps * krows * kcols, orows * ocols);
+                }
                 for (tensor_size_t x = 0; x < count; ++ x)
                 {
                         auto xidata = idata.tensor(x);
-                        auto xodata = odata.tensor(x).reshape(omaps, orows * ocols).matrix();
+                        auto xodata = odata.tensor(x);
                         auto kodata = m_kodata.matrix(x);
 
                         // bias
-                        xodata.colwise() = bdata;
+                        xodata.reshape(omaps, orows * ocols).matrix().colwise() = bdata;
 
                         // +convolution
                         for (tensor_size_t i = 0; i < imaps; ++ i)
                         {
                                 img2col(xidata.matrix(i), orows, ocols, krows, kcols, drows, dcols,
-                                         map_matrix(kodata.row(i * krows * kcols).data(),
+                                         map_matrix(kodata.row(krow(i)).data(),
                                                     krows * kcols, orows * ocols));
                         }
 
-                        xodata.noalias() += m_okdata * kodata;
+                        for (tensor_size_t g = 0; g < kconn; ++ g)
+                        {
+                                gemm(gkdata(kdata, g), false, kodata.middleRows(g * grows, grows), false, godata(xodata, g), 1);
+                        }
                 }
         }
 
@@ -136,26 +268,63 @@ namespace nano
         void conv4d_t::ginput(tidata&& idata, const tkdata& kdata, const tbdata& bdata, const todata& odata)
         {
                 assert(m_params.valid(idata, kdata, bdata, odata));
-                NANO_UNUSED2(kdata, bdata);
+                NANO_UNUSED1(bdata);
+
+                if (m_layout == tensor_layout::nhwc)
+                {
+                        ginput_nhwc(idata, kdata, bdata, odata);
+                        return;
+                }
 
                 const auto count = idata.template size<0>();
                 const auto imaps = m_params.imaps();
-                const auto krows = m_params.krows(), kcols = m_params.kcols();
+                const auto kconn = m_params.kconn(), krows = m_params.krows(), kcols = m_params.kcols();
                 const auto omaps = m_params.omaps(), orows = m_params.orows(), ocols = m_params.ocols();
                 const auto drows = m_params.kdrow(), dcols = m_params.kdcol();
 
+                if (depthwise())
+                {
+                        for (tensor_size_t x = 0; x < count; ++ x)
+                        {
+                                auto xidata = idata.tensor(x);
+                                auto xodata = odata.tensor(x);
+
+                                xidata.zero();
+                                for (tensor_size_t o = 0; o < omaps; ++ o)
+                                {
+                                        const auto omat = xodata.matrix(o);
+                                        const auto kmat = kdata.matrix(o, 0);
+
+                                        auto imat = xidata.matrix(o % kconn);
+                                        for (tensor_size_t kr = 0; kr < krows; ++ kr)
+                                        {
+                                                for (tensor_size_t kc = 0; kc < kcols; ++ kc)
+                                                {
+                                                        gidata(imat, kr, kc).array() += kmat(kr, kc) * omat.array();
+                                                }
+                                        }
+                                }
+                        }
+                        return;
+                }
+
+                const auto grows = gimaps() * krows * kcols;
+
                 for (tensor_size_t x = 0; x < count; ++ x)
                 {
                         auto xidata = idata.tensor(x);
                         auto xodata = odata.tensor(x);
 
-                        m_kxdata.noalias() = m_okdata.transpose() * xodata.reshape(omaps, orows * ocols).matrix();
+                        for (tensor_size_t g = 0; g < kconn; ++ g)
+                        {
+                                gemm(gkdata(kdata, g), true, godata(xodata, g), false, m_kxdata.middleRows(g * grows, grows), 0);
+                        }
 
                         xidata.zero();
                         for (tensor_size_t i = 0; i < imaps; ++ i)
                         {
                                 col2img(xidata.matrix(i), orows, ocols, krows, kcols, drows, dcols,
-                                        map_matrix(m_kxdata.row(i * krows * kcols).data(),
+                                        map_matrix(m_kxdata.row(krow(i)).data(),
                                                    krows * kcols, orows * ocols));
                         }
                 }
@@ -166,6 +335,12 @@ namespace nano
         {
                 assert(m_params.valid(idata, kdata, bdata, odata));
 
+                if (m_layout == tensor_layout::nhwc)
+                {
+                        gparam_nhwc(idata, kdata, bdata, odata);
+                        return;
+                }
+
                 const auto count = idata.template size<0>();
                 const auto imaps = m_params.imaps();
                 const auto kconn = m_params.kconn(), krows = m_params.krows(), kcols = m_params.kcols();
@@ -174,37 +349,277 @@ namespace nano
                 kdata.setZero();
                 bdata.setZero();
 
-                assert(m_kodata.size<0>() == count);
+                if (depthwise())
+                {
+                        for (tensor_size_t x = 0; x < count; ++ x)
+                        {
+                                auto xidata = idata.tensor(x);
+                                auto xodata = odata.tensor(x);
+
+                                // bias
+                                bdata += xodata.reshape(omaps, orows * ocols).matrix().rowwise().sum();
+
+                                // convolution
+                                for (tensor_size_t o = 0; o < omaps; ++ o)
+                                {
+                                        const auto imat = xidata.matrix(o % kconn);
+                                        const auto omat = xodata.matrix(o);
+
+                                        auto kmat = kdata.matrix(o, 0);
+                                        for (tensor_size_t kr = 0; kr < krows; ++ kr)
+                                        {
+                                                for (tensor_size_t kc = 0; kc < kcols; ++ kc)
+                                                {
+                                                        kmat(kr, kc) += (gidata(imat, kr, kc).array() * omat.array()).sum();
+                                                }
+                                        }
+                                }
+                        }
+                        return;
+                }
+
+                const auto grows = gimaps() * krows * kcols;
+
+                assert(m_kodata.size<0>() >= count);
                 assert(m_kodata.size<1>() == imaps * krows * kcols);
                 assert(m_kodata.size<2>() == orows * ocols);
+                NANO_UNUSED1_RELEASE(imaps);
+
                 for (tensor_size_t x = 0; x < count; ++ x)
                 {
-                        auto xodata = odata.tensor(x).reshape(omaps, orows * ocols).matrix();
+                        auto xodata = odata.tensor(x);
                         auto kodata = m_kodata.matrix(x);
 
                         // bias
-                        bdata += xodata.rowwise().sum();
+                        bdata += xodata.reshape(omaps, orows * ocols).matrix().rowwise().sum();
 
                         // convolution
-                        m_xkdata.noalias() = xodata * kodata.transpose();
+                        for (tensor_size_t g = 0; g < kconn; ++ g)
+                        {
+                                gemm(godata(xodata, g), false, kodata.middleRows(g * grows, grows), true, gkdata(kdata, g), 1);
+                        }
+                }
+        }
+
+        template <typename timatrix, typename tomatrix>
+        void conv4d_t::img2col_nhwc(const timatrix& imat, tomatrix&& omat) const
+        {
+                const auto imaps = m_params.imaps(), icols = m_params.icols();
+                const auto kconn = m_params.kconn(), krows = m_params.krows(), kcols = m_params.kcols();
+                const auto orows = m_params.orows(), ocols = m_params.ocols();
+                const auto drows = m_params.kdrow(), dcols = m_params.kdcol();
 
-                        switch (kconn)
+                for (tensor_size_t r = 0, o = 0; r < orows; ++ r)
+                {
+                        for (tensor_size_t c = 0; c < ocols; ++ c, ++ o)
                         {
-                        case 1:
-                                kdata.reshape(omaps, imaps * krows * kcols).matrix().noalias() += m_xkdata;
-                                break;
+                                for (tensor_size_t kr = 0, k = 0; kr < krows; ++ kr)
+                                {
+                                        for (tensor_size_t kc = 0; kc < kcols; ++ kc, ++ k)
+                                        {
+                                                const auto i = (r * drows + kr) * icols + (c * dcols + kc);
+                                                if (kconn == 1)
+                                                {
+                                                        omat.row(o).segment(k * imaps, imaps) = imat.row(i);
+                                                }
+                                                else
+                                                {
+                                                        for (tensor_size_t m = 0; m < imaps; ++ m)
+                                                        {
+                                                                omat(o, kcol(m, k)) = imat(i, m);
+                                                        }
+                                                }
+                                        }
+                                }
+                        }
+                }
+        }
 
-                        default:
-                                for (tensor_size_t o = 0; o < omaps; ++ o)
+        template <typename timatrix, typename tomatrix>
+        void conv4d_t::col2img_nhwc(timatrix&& imat, const tomatrix& omat) const
+        {
+                const auto imaps = m_params.imaps(), icols = m_params.icols();
+                const auto kconn = m_params.kconn(), krows = m_params.krows(), kcols = m_params.kcols();
+                const auto orows = m_params.orows(), ocols = m_params.ocols();
+                const auto drows = m_params.kdrow(), dcols = m_params.kdcol();
+
+                for (tensor_size_t r = 0, o = 0; r < orows; ++ r)
+                {
+                        for (tensor_size_t c = 0; c < ocols; ++ c, ++ o)
+                        {
+                                for (tensor_size_t kr = 0, k = 0; kr < krows; ++ kr)
                                 {
-                                        for (tensor_size_t i = o % kconn, ik = 0; i < imaps; i += kconn, ++ ik)
+                                        for (tensor_size_t kc = 0; kc < kcols; ++ kc, ++ k)
                                         {
-                                                kdata.vector(o, ik) +=
-                                                m_xkdata.row(o).segment(i * krows * kcols, krows * kcols);
+                                                const auto i = (r * drows + kr) * icols + (c * dcols + kc);
+                                                if (kconn == 1)
+                                                {
+                                                        imat.row(i) += omat.row(o).segment(k * imaps, imaps);
+                                                }
+                                                else
+                                                {
+                                                        for (tensor_size_t m = 0; m < imaps; ++ m)
+                                                        {
+                                                                imat(i, m) += omat(o, kcol(m, k));
+                                                        }
+                                                }
                                         }
                                 }
-                                break;
                         }
                 }
         }
+
+        template <typename tidata, typename tkdata, typename tbdata, typename todata>
+        void conv4d_t::output_nhwc(const tidata& idata, const tkdata& kdata, const tbdata& bdata, todata&& odata)
+        {
+                const auto count = idata.template size<0>();
+                const auto imaps = m_params.imaps();
+                const auto kconn = m_params.kconn(), krows = m_params.krows(), kcols = m_params.kcols();
+                const auto omaps = m_params.omaps(), orows = m_params.orows(), ocols = m_params.ocols();
+
+//                output[x] = input[x] * kernel^T (for each group g)
+//
+//                oodata                          = kodata *                                     okdata^T
+//                (orows * ocols, omaps/kconn)    = (orows * ocols, krows * kcols * imaps/kconn) x (krows * kcols * imaps/kconn, omaps/kconn)
+
+                const auto grows = gimaps() * krows * kcols;
+
+                // reorder the kernels to match the unrolled patches: (imaps/kconn, krows x kcols) -> (krows x kcols, imaps/kconn)
+                for (tensor_size_t o = 0; o < omaps; ++ o)
+                {
+                        map_matrix(m_okdata.row(o).data(), krows * kcols, gimaps()) =
+                        map_matrix(kdata.data() + o * grows, gimaps(), krows * kcols).transpose();
+                }
+
+                if (m_kodata.size<0>() < count)
+                {
+                        m_kodata.resize(count, orows * ocols, imaps * krows * kcols);
+                }
+                for (tensor_size_t x = 0; x < count; ++ x)
+                {
+                        auto xodata = nhwc_matrix(odata, x);
+                        auto kodata = m_kodata.matrix(x);
+
+                        // bias
+                        xodata.rowwise() = bdata.transpose();
+
+                        // +convolution
+                        img2col_nhwc(nhwc_matrix(idata, x), kodata);
+
+                        for (tensor_size_t g = 0; g < kconn; ++ g)
+                        {
+                                gemm(kodata.middleCols(g * grows, grows), false, gkdata(m_okdata, g), true,
+                                     map_matrix(xodata.data() + g, orows * ocols, gomaps(), omaps, kconn), 1);
+                        }
+                }
+        }
+
+        template <typename tidata, typename tkdata, typename tbdata, typename todata>
+        void conv4d_t::ginput_nhwc(tidata&& idata, const tkdata& kdata, const tbdata& bdata, const todata& odata)
+        {
+                NANO_UNUSED2(kdata, bdata);
+                assert(cached_kdata(kdata));
+
+                const auto count = idata.template size<0>();
+                const auto kconn = m_params.kconn(), krows = m_params.krows(), kcols = m_params.kcols();
+                const auto omaps = m_params.omaps(), orows = m_params.orows(), ocols = m_params.ocols();
+
+                const auto grows = gimaps() * krows * kcols;
+
+                for (tensor_size_t x = 0; x < count; ++ x)
+                {
+                        auto xidata = nhwc_matrix(idata, x);
+                        auto xodata = nhwc_matrix(odata, x);
+
+                        for (tensor_size_t g = 0; g < kconn; ++ g)
+                        {
+                                gemm(map_matrix(xodata.data() + g, orows * ocols, gomaps(), omaps, kconn), false,
+                                     gkdata(m_okdata, g), false, m_kxdata.middleCols(g * grows, grows), 0);
+                        }
+
+                        xidata.setZero();
+                        col2img_nhwc(xidata, m_kxdata);
+                }
+        }
+
+        template <typename tidata, typename tkdata, typename tbdata, typename todata>
+        void conv4d_t::gparam_nhwc(const tidata& idata, tkdata&& kdata, tbdata&& bdata, const todata& odata)
+        {
+                const auto count = idata.template size<0>();
+                const auto kconn = m_params.kconn(), krows = m_params.krows(), kcols = m_params.kcols();
+                const auto omaps = m_params.omaps(), orows = m_params.orows(), ocols = m_params.ocols();
+
+                const auto grows = gimaps() * krows * kcols;
+
+                assert(cached_idata(idata));
+
+                bdata.setZero();
+                m_xkdata.setZero();
+                for (tensor_size_t x = 0; x < count; ++ x)
+                {
+                        auto xodata = nhwc_matrix(odata, x);
+                        auto kodata = m_kodata.matrix(x);
+
+                        // bias
+                        bdata += xodata.colwise().sum().transpose();
+
+                        // convolution
+                        for (tensor_size_t g = 0; g < kconn; ++ g)
+                        {
+                                gemm(map_matrix(xodata.data() + g, orows * ocols, gomaps(), omaps, kconn), true,
+                                     kodata.middleCols(g * grows, grows), false, gkdata(m_xkdata, g), 1);
+                        }
+                }
+
+                // reorder the kernels back: (krows x kcols, imaps/kconn) -> (imaps/kconn, krows x kcols)
+                for (tensor_size_t o = 0; o < omaps; ++ o)
+                {
+                        map_matrix(kdata.data() + o * grows, gimaps(), krows * kcols) =
+                        map_matrix(m_xkdata.row(o).data(), krows * kcols, gimaps()).transpose();
+                }
+        }
+
+        template <typename tkdata>
+        bool conv4d_t::cached_kdata(const tkdata& kdata) const
+        {
+                const auto krows = m_params.krows(), kcols = m_params.kcols();
+                const auto grows = gimaps() * krows * kcols;
+
+                for (tensor_size_t o = 0; o < m_params.omaps(); ++ o)
+                {
+                        if (map_matrix(m_okdata.row(o).data(), krows * kcols, gimaps()) !=
+                            map_matrix(kdata.data() + o * grows, gimaps(), krows * kcols).transpose())
+                        {
+                                return false;
+                        }
+                }
+
+                return true;
+        }
+
+        template <typename tidata>
+        bool conv4d_t::cached_idata(const tidata& idata) const
+        {
+                const auto count = idata.template size<0>();
+                const auto krows = m_params.krows(), kcols = m_params.kcols();
+
+                if (    m_kodata.size<0>() < count ||
+                        m_kodata.size<1>() != m_params.orows() * m_params.ocols() ||
+                        m_kodata.size<2>() != m_params.imaps() * krows * kcols)
+                {
+                        return false;
+                }
+
+                matrix_t kodata(m_kodata.size<1>(), m_kodata.size<2>());
+                for (tensor_size_t x = 0; x < count; ++ x)
+                {
+                        img2col_nhwc(nhwc_matrix(idata, x), kodata);
+                        if (kodata != m_kodata.matrix(x))
+                        {
+                                return false;
+                        }
+                }
+
+                return true;
+        }
 }
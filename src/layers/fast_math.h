@@ -0,0 +1,90 @@
+#pragma once
+
+#include <type_traits>
+
+namespace nano
+{
+        ///
+        /// \brief fast approximations of transcendental functions for Eigen arrays.
+        ///
+        /// NB: only element-wise additions, multiplications, divisions and min/max are used,
+        ///     so that Eigen vectorizes them for all scalar types (unlike e.g. tanh or log for double).
+        /// NB: the maximum absolute error (in double precision) is given for each function.
+        ///
+        namespace fast
+        {
+                template <typename tarray>
+                using array_scalar_t = typename std::remove_reference_t<tarray>::Scalar;
+
+                ///
+                /// \brief tanh(x) with a (13, 6) rational approximation on [-7.905, +7.905]
+                ///     (saturated outside): max error < 3e-7.
+                ///
+                template <typename tiarray, typename toarray>
+                void tanh(const tiarray& idata, toarray&& odata)
+                {
+                        using tscalar = array_scalar_t<toarray>;
+
+                        const auto clamp = tscalar(7.90531110763549805);
+
+                        const auto a01 = tscalar(+4.89352455891786e-03);
+                        const auto a03 = tscalar(+6.37261928875436e-04);
+                        const auto a05 = tscalar(+1.48572235717979e-05);
+                        const auto a07 = tscalar(+5.12229709037114e-08);
+                        const auto a09 = tscalar(-8.60467152213735e-11);
+                        const auto a11 = tscalar(+2.00018790482477e-13);
+                        const auto a13 = tscalar(-2.76076847742355e-16);
+
+                        const auto b00 = tscalar(+4.89352518554385e-03);
+                        const auto b02 = tscalar(+2.26843463243900e-03);
+                        const auto b04 = tscalar(+1.18534705686654e-04);
+                        const auto b06 = tscalar(+1.19825839466702e-06);
+
+                        odata = idata.max(-clamp).min(+clamp);
+                        odata = odata *
+                                (a01 + odata.square() * (a03 + odata.square() * (a05 + odata.square() *
+                                (a07 + odata.square() * (a09 + odata.square() * (a11 + odata.square() * a13)))))) /
+                                (b00 + odata.square() * (b02 + odata.square() * (b04 + odata.square() * b06)));
+                }
+
+                ///
+                /// \brief e^x/(1+e^x) = (1 + tanh(x/2))/2: max error < 2e-7.
+                ///
+                template <typename tiarray, typename toarray>
+                void sigm(const tiarray& idata, toarray&& odata)
+                {
+                        using tscalar = array_scalar_t<toarray>;
+
+                        fast::tanh(idata * tscalar(0.5), odata);
+                        odata = tscalar(0.5) + tscalar(0.5) * odata;
+                }
+
+                ///
+                /// \brief log(1+e^x) = max(x, 0) + log(1 + e^-|x|): max error < 1e-8.
+                ///
+                /// NB: e^-|x| is computed as (e^(-|x|/64))^64 with a Taylor polynomial of degree 10,
+                ///     log(1 + t) is computed as 2 * atanh(t / (2 + t)) with the first 8 terms of the series.
+                /// NB: the output is used as a buffer, so it should not alias the input.
+                ///
+                template <typename tiarray, typename toarray>
+                void splus(const tiarray& idata, toarray&& odata)
+                {
+                        using tscalar = array_scalar_t<toarray>;
+
+                        const auto r = idata.abs().min(tscalar(40)) * tscalar(-1.0 / 64.0);
+
+                        // t = e^-|x|, s = t / (2 + t) = 1 - 2 / (2 + t)
+                        odata = 1 - 2 / (2 +
+                                (1 + r * (1 + r * tscalar(1.0 / 2) * (1 + r * tscalar(1.0 / 3) * (1 + r * tscalar(1.0 / 4) *
+                                (1 + r * tscalar(1.0 / 5) * (1 + r * tscalar(1.0 / 6) * (1 + r * tscalar(1.0 / 7) *
+                                (1 + r * tscalar(1.0 / 8) * (1 + r * tscalar(1.0 / 9) * (1 + r * tscalar(1.0 / 10)))))))))))
+                                .square().square().square().square().square().square());
+
+                        // log(1 + t) = 2 * (s + s^3/3 + ... + s^15/15)
+                        odata = idata.max(tscalar(0)) + 2 * odata *
+                                (tscalar(1.0 / 1) + odata.square() * (tscalar(1.0 / 3) + odata.square() * (tscalar(1.0 / 5) +
+                                 odata.square() * (tscalar(1.0 / 7) + odata.square() * (tscalar(1.0 / 9) + odata.square() * (tscalar(1.0 / 11) +
+                                 odata.square() * (tscalar(1.0 / 13) + odata.square() * tscalar(1.0 / 15))))))));
+                }
+        }
+}
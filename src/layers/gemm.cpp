@@ -0,0 +1,98 @@
+#include "gemm.h"
+#include <atomic>
+#include <type_traits>
+
+#ifdef NANO_WITH_BLAS
+extern "C"
+{
+        void sgemm_(const char* transa, const char* transb, const int* m, const int* n, const int* k,
+                const float* alpha, const float* a, const int* lda, const float* b, const int* ldb,
+                const float* beta, float* c, const int* ldc);
+
+        void dgemm_(const char* transa, const char* transb, const int* m, const int* n, const int* k,
+                const double* alpha, const double* a, const int* lda, const double* b, const int* ldb,
+                const double* beta, double* c, const int* ldc);
+}
+#endif
+
+using namespace nano;
+
+static std::atomic<gemm_backend>& backend()
+{
+        static std::atomic<gemm_backend> the_backend{gemm_backend::eigen};
+        return the_backend;
+}
+
+void nano::set_gemm_backend(const gemm_backend value)
+{
+        backend() = value;
+}
+
+gemm_backend nano::get_gemm_backend()
+{
+        return backend();
+}
+
+bool nano::has_blas()
+{
+#ifdef NANO_WITH_BLAS
+        return  std::is_same<scalar_t, float>::value ||
+                std::is_same<scalar_t, double>::value;
+#else
+        return false;
+#endif
+}
+
+#ifdef NANO_WITH_BLAS
+inline void xgemm(const char* transa, const char* transb, const int* m, const int* n, const int* k,
+        const float* alpha, const float* a, const int* lda, const float* b, const int* ldb,
+        const float* beta, float* c, const int* ldc)
+{
+        sgemm_(transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+}
+
+inline void xgemm(const char* transa, const char* transb, const int* m, const int* n, const int* k,
+        const double* alpha, const double* a, const int* lda, const double* b, const int* ldb,
+        const double* beta, double* c, const int* ldc)
+{
+        dgemm_(transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+}
+
+template <typename tscalar>
+inline void xgemm(const char*, const char*, const int*, const int*, const int*,
+        const tscalar*, const tscalar*, const int*, const tscalar*, const int*,
+        const tscalar*, tscalar*, const int*)
+{
+}
+#endif
+
+bool nano::blas_gemm(const bool transa, const bool transb,
+        const tensor_size_t m, const tensor_size_t n, const tensor_size_t k,
+        const scalar_t* a, const tensor_size_t lda,
+        const scalar_t* b, const tensor_size_t ldb,
+        const scalar_t beta, scalar_t* c, const tensor_size_t ldc)
+{
+#ifdef NANO_WITH_BLAS
+        if (!has_blas())
+        {
+                return false;
+        }
+
+        const auto ta = transa ? 'T' : 'N';
+        const auto tb = transb ? 'T' : 'N';
+        const auto im = static_cast<int>(m), in = static_cast<int>(n), ik = static_cast<int>(k);
+        const auto ilda = static_cast<int>(std::max(lda, tensor_size_t(1)));
+        const auto ildb = static_cast<int>(std::max(ldb, tensor_size_t(1)));
+        const auto ildc = static_cast<int>(std::max(ldc, tensor_size_t(1)));
+        const auto alpha = scalar_t(1);
+
+        xgemm(&ta, &tb, &im, &in, &ik, &alpha, a, &ilda, b, &ildb, &beta, c, &ildc);
+        return true;
+#else
+        NANO_UNUSED3(transa, transb, m);
+        NANO_UNUSED3(n, k, a);
+        NANO_UNUSED3(lda, b, ldb);
+        NANO_UNUSED3(beta, c, ldc);
+        return false;
+#endif
+}
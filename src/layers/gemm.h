@@ -0,0 +1,335 @@
+#pragma once
+
+#include "arch.h"
+#include "tensor.h"
+#include "core/cast.h"
+#include "core/tpool.h"
+#include <algorithm>
+
+namespace nano
+{
+        ///
+        /// \brief implementations of the general matrix multiplication (GEMM) used by the computation nodes:
+        ///     C = op(A) * op(B) + beta * C, where op(X) is either X or X^T.
+        ///
+        enum class gemm_backend
+        {
+                eigen,                  ///< Eigen's matrix product (default)
+                tpool,                  ///< packed & cache-blocked kernel scheduled on the thread pool
+                blas,                   ///< system BLAS library (if available at configure time, otherwise Eigen)
+        };
+
+        template <>
+        inline enum_map_t<gemm_backend> enum_string<gemm_backend>()
+        {
+                return
+                {
+                        { gemm_backend::eigen,  "eigen" },
+                        { gemm_backend::tpool,  "tpool" },
+                        { gemm_backend::blas,   "blas" }
+                };
+        }
+
+        ///
+        /// \brief change the GEMM backend used by all computation nodes.
+        ///
+        NANO_PUBLIC void set_gemm_backend(const gemm_backend);
+
+        ///
+        /// \brief returns the GEMM backend currently in use.
+        ///
+        NANO_PUBLIC gemm_backend get_gemm_backend();
+
+        ///
+        /// \brief returns true if the library was built with a system BLAS library.
+        ///
+        NANO_PUBLIC bool has_blas();
+
+        ///
+        /// \brief call the system BLAS library using column-major conventions (if available).
+        /// NB: returns false if not available (e.g. no BLAS library found or the scalar type not supported).
+        ///
+        NANO_PUBLIC bool blas_gemm(const bool transa, const bool transb,
+                const tensor_size_t m, const tensor_size_t n, const tensor_size_t k,
+                const scalar_t* a, const tensor_size_t lda,
+                const scalar_t* b, const tensor_size_t ldb,
+                const scalar_t beta, scalar_t* c, const tensor_size_t ldc);
+
+        namespace detail
+        {
+                ///
+                /// \brief block sizes: (MC x KC) from op(A) and (KC x NC) from op(B) are packed to update (MC x NC) from C.
+                ///
+                constexpr tensor_size_t gemm_mc = 64;
+                constexpr tensor_size_t gemm_nc = 256;
+                constexpr tensor_size_t gemm_kc = 256;
+
+                ///
+                /// \brief strided access to the elements of a row-major matrix (optionally transposed).
+                ///
+                struct gemm_view_t
+                {
+                        template <typename tmatrix>
+                        gemm_view_t(const tmatrix& matrix, const bool trans) :
+                                m_data(matrix.data()),
+                                m_rstride(trans ? matrix.innerStride() : matrix.outerStride()),
+                                m_cstride(trans ? matrix.outerStride() : matrix.innerStride())
+                        {
+                                static_assert(std::remove_reference<tmatrix>::type::IsRowMajor, "row-major matrix expected");
+                        }
+
+                        scalar_t operator()(const tensor_size_t r, const tensor_size_t c) const
+                        {
+                                return m_data[r * m_rstride + c * m_cstride];
+                        }
+
+                        const scalar_t* m_data;
+                        tensor_size_t   m_rstride, m_cstride;
+                };
+
+                ///
+                /// \brief update the (mc x nc) block of C starting at (r0, c0) using the packed blocks of op(A) and op(B).
+                ///
+                inline void gemm_block(const gemm_view_t& a, const gemm_view_t& b, const tensor_size_t k,
+                        const scalar_t beta, scalar_t* c, const tensor_size_t crstride, const tensor_size_t ccstride,
+                        const tensor_size_t r0, const tensor_size_t mc,
+                        const tensor_size_t c0, const tensor_size_t nc)
+                {
+                        static thread_local std::vector<scalar_t> apack, bpack, cpack;
+                        apack.resize(static_cast<size_t>(gemm_mc * gemm_kc));
+                        bpack.resize(static_cast<size_t>(gemm_kc * gemm_nc));
+                        cpack.resize(static_cast<size_t>(gemm_mc * gemm_nc));
+
+                        scalar_t* __restrict cp = cpack.data();
+                        for (tensor_size_t r = 0; r < mc; ++ r)
+                        {
+                                for (tensor_size_t cc = 0; cc < nc; ++ cc)
+                                {
+                                        cp[r * nc + cc] = (beta == 0) ? scalar_t(0) : beta * c[(r0 + r) * crstride + (c0 + cc) * ccstride];
+                                }
+                        }
+
+                        for (tensor_size_t k0 = 0; k0 < k; k0 += gemm_kc)
+                        {
+                                const auto kc = std::min(gemm_kc, k - k0);
+
+                                // pack (mc x kc) block from op(A) & (kc x nc) block from op(B) as contiguous row-major
+                                scalar_t* __restrict ap = apack.data();
+                                scalar_t* __restrict bp = bpack.data();
+                                for (tensor_size_t r = 0; r < mc; ++ r)
+                                {
+                                        for (tensor_size_t p = 0; p < kc; ++ p)
+                                        {
+                                                ap[r * kc + p] = a(r0 + r, k0 + p);
+                                        }
+                                }
+                                for (tensor_size_t p = 0; p < kc; ++ p)
+                                {
+                                        for (tensor_size_t cc = 0; cc < nc; ++ cc)
+                                        {
+                                                bp[p * nc + cc] = b(k0 + p, c0 + cc);
+                                        }
+                                }
+
+                                // micro-kernel: 4 rows of C at once to reuse the loaded rows of op(B)
+                                tensor_size_t r = 0;
+                                for ( ; r + 4 <= mc; r += 4)
+                                {
+                                        scalar_t* __restrict c0p = cp + (r + 0) * nc;
+                                        scalar_t* __restrict c1p = cp + (r + 1) * nc;
+                                        scalar_t* __restrict c2p = cp + (r + 2) * nc;
+                                        scalar_t* __restrict c3p = cp + (r + 3) * nc;
+                                        for (tensor_size_t p = 0; p < kc; ++ p)
+                                        {
+                                                const auto a0 = ap[(r + 0) * kc + p];
+                                                const auto a1 = ap[(r + 1) * kc + p];
+                                                const auto a2 = ap[(r + 2) * kc + p];
+                                                const auto a3 = ap[(r + 3) * kc + p];
+                                                const scalar_t* __restrict brow = bp + p * nc;
+                                                for (tensor_size_t cc = 0; cc < nc; ++ cc)
+                                                {
+                                                        const auto bv = brow[cc];
+                                                        c0p[cc] += a0 * bv;
+                                                        c1p[cc] += a1 * bv;
+                                                        c2p[cc] += a2 * bv;
+                                                        c3p[cc] += a3 * bv;
+                                                }
+                                        }
+                                }
+                                for ( ; r < mc; ++ r)
+                                {
+                                        scalar_t* __restrict crow = cp + r * nc;
+                                        for (tensor_size_t p = 0; p < kc; ++ p)
+                                        {
+                                                const auto av = ap[r * kc + p];
+                                                const scalar_t* __restrict brow = bp + p * nc;
+                                                for (tensor_size_t cc = 0; cc < nc; ++ cc)
+                                                {
+                                                        crow[cc] += av * brow[cc];
+                                                }
+                                        }
+                                }
+                        }
+
+                        for (tensor_size_t r = 0; r < mc; ++ r)
+                        {
+                                for (tensor_size_t cc = 0; cc < nc; ++ cc)
+                                {
+                                        c[(r0 + r) * crstride + (c0 + cc) * ccstride] = cp[r * nc + cc];
+                                }
+                        }
+                }
+
+                ///
+                /// \brief packed & cache-blocked GEMM with the blocks of C distributed to the thread pool.
+                /// NB: the blocks are processed sequentially if called from a worker thread (e.g. the accumulator)
+                ///     or if the matrices are too small to benefit from multi-threading.
+                ///
+                template <typename tmatrixa, typename tmatrixb, typename tmatrixc>
+                void gemm_tpool(const tmatrixa& a, const bool transa, const tmatrixb& b, const bool transb,
+                        tmatrixc&& c, const scalar_t beta)
+                {
+                        static_assert(std::remove_reference<tmatrixc>::type::IsRowMajor, "row-major matrix expected");
+
+                        const auto m = c.rows();
+                        const auto n = c.cols();
+                        const auto k = transa ? a.rows() : a.cols();
+
+                        const auto va = gemm_view_t{a, transa};
+                        const auto vb = gemm_view_t{b, transb};
+
+                        const auto mblocks = (m + gemm_mc - 1) / gemm_mc;
+                        const auto nblocks = (n + gemm_nc - 1) / gemm_nc;
+
+                        const auto op = [&] (const tensor_size_t block)
+                        {
+                                const auto r0 = (block / nblocks) * gemm_mc;
+                                const auto c0 = (block % nblocks) * gemm_nc;
+                                gemm_block(va, vb, k, beta, c.data(), c.outerStride(), c.innerStride(),
+                                        r0, std::min(gemm_mc, m - r0), c0, std::min(gemm_nc, n - c0));
+                        };
+
+                        const auto blocks = mblocks * nblocks;
+                        if (    blocks == 1 ||
+                                m * n * k < gemm_mc * gemm_nc * gemm_kc ||
+                                tpool_t::instance().workers() < 2 ||
+                                tpool_t::is_worker())
+                        {
+                                for (tensor_size_t block = 0; block < blocks; ++ block)
+                                {
+                                        op(block);
+                                }
+                        }
+                        else
+                        {
+                                loopi(blocks, tensor_size_t(1), [&] (const tensor_size_t begin, const tensor_size_t end)
+                                {
+                                        for (auto block = begin; block < end; ++ block)
+                                        {
+                                                op(block);
+                                        }
+                                });
+                        }
+                }
+
+                ///
+                /// \brief Eigen's matrix product.
+                ///
+                template <typename tmatrixa, typename tmatrixb, typename tmatrixc>
+                void gemm_eigen(const tmatrixa& a, const tmatrixb& b, tmatrixc&& c, const scalar_t beta)
+                {
+                        if (beta == 0)
+                        {
+                                c.noalias() = a * b;
+                        }
+                        else if (beta == 1)
+                        {
+                                c.noalias() += a * b;
+                        }
+                        else
+                        {
+                                c *= beta;
+                                c.noalias() += a * b;
+                        }
+                }
+
+                template <typename tmatrixa, typename tmatrixb, typename tmatrixc>
+                void gemm_eigen(const tmatrixa& a, const bool transa, const tmatrixb& b, const bool transb,
+                        tmatrixc&& c, const scalar_t beta)
+                {
+                        if (!transa && !transb)
+                        {
+                                gemm_eigen(a, b, c, beta);
+                        }
+                        else if (!transa && transb)
+                        {
+                                gemm_eigen(a, b.transpose(), c, beta);
+                        }
+                        else if (transa && !transb)
+                        {
+                                gemm_eigen(a.transpose(), b, c, beta);
+                        }
+                        else
+                        {
+                                gemm_eigen(a.transpose(), b.transpose(), c, beta);
+                        }
+                }
+
+                ///
+                /// \brief system BLAS: the row-major product is mapped to the column-major C^T = op(B)^T * op(A)^T.
+                /// NB: returns false if the matrices are not compatible (e.g. non-unit inner strides).
+                ///
+                template <typename tmatrixa, typename tmatrixb, typename tmatrixc>
+                bool gemm_blas(const tmatrixa& a, const bool transa, const tmatrixb& b, const bool transb,
+                        tmatrixc&& c, const scalar_t beta)
+                {
+                        if (    a.innerStride() != 1 ||
+                                b.innerStride() != 1 ||
+                                c.innerStride() != 1)
+                        {
+                                return false;
+                        }
+
+                        const auto m = c.rows();
+                        const auto n = c.cols();
+                        const auto k = transa ? a.rows() : a.cols();
+
+                        return blas_gemm(transb, transa, n, m, k,
+                                b.data(), b.outerStride(), a.data(), a.outerStride(), beta, c.data(), c.outerStride());
+                }
+        }
+
+        ///
+        /// \brief general matrix multiplication: C = op(A) * op(B) + beta * C using the current backend.
+        ///
+        /// NB: the matrices must be row-major (e.g. matrix_t, maps or blocks), but they can have arbitrary strides.
+        /// NB: C must not alias A or B.
+        ///
+        template <typename tmatrixa, typename tmatrixb, typename tmatrixc>
+        void gemm(const tmatrixa& a, const bool transa, const tmatrixb& b, const bool transb,
+                tmatrixc&& c, const scalar_t beta = 0)
+        {
+                assert(c.rows() == (transa ? a.cols() : a.rows()));
+                assert(c.cols() == (transb ? b.rows() : b.cols()));
+                assert((transa ? a.rows() : a.cols()) == (transb ? b.cols() : b.rows()));
+
+                switch (get_gemm_backend())
+                {
+                case gemm_backend::tpool:
+                        detail::gemm_tpool(a, transa, b, transb, c, beta);
+                        break;
+
+                case gemm_backend::blas:
+                        if (!detail::gemm_blas(a, transa, b, transb, c, beta))
+                        {
+                                detail::gemm_eigen(a, transa, b, transb, c, beta);
+                        }
+                        break;
+
+                case gemm_backend::eigen:
+                default:
+                        detail::gemm_eigen(a, transa, b, transb, c, beta);
+                        break;
+                }
+        }
+}
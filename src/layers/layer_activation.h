@@ -1,6 +1,7 @@
 #pragma once
 
 #include "layer.h"
+#include "fast_math.h"
 #include "tensor/numeric.h"
 
 namespace nano
@@ -8,21 +9,26 @@ namespace nano
         ///
         /// \brief activation layer: applies a non-linear scalar function to the each scalar input.
         ///
-        template <typename top>
+        /// parameters:
+        ///     fast    - use the fast (approximate) version of the activation function (0 or 1),
+        ///             only for the activation functions having one and only stored in the configuration when set.
+        ///
+        template <typename top, typename tfastop = top>
         class activation_layer_t final : public layer_t
         {
         public:
 
                 rlayer_t clone() const final;
-                void to_json(json_t&) const final {};
-                void from_json(const json_t&) final {};
+                void to_json(json_t&) const final;
+                void from_json(const json_t&) final;
 
                 bool resize(const tensor3d_dims_t& idims) final;
+                bool layout(const tensor_layout) final { return true; }
 
                 void random(vector_map_t pdata) const final;
-                void output(tensor4d_cmaps_t idata, vector_cmap_t pdata, tensor4d_map_t odata) final;
-                void ginput(tensor4d_maps_t idata, vector_cmap_t pdata, tensor4d_cmap_t odata) final;
-                void gparam(tensor4d_cmaps_t idata, vector_map_t pdata, tensor4d_cmap_t odata) final;
+                void output(const tensor4d_cmaps_t& idata, vector_cmap_t pdata, tensor4d_map_t odata) final;
+                void ginput(const tensor4d_maps_t& idata, vector_cmap_t pdata, tensor4d_cmap_t odata) final;
+                void gparam(const tensor4d_cmaps_t& idata, vector_map_t pdata, tensor4d_cmap_t odata) final;
 
                 tensor_size_t psize() const final { return 0; }
                 tensor3d_dim_t odims() const final { return m_xdims; }
@@ -32,18 +38,39 @@ namespace nano
 
         private:
 
+                static constexpr bool has_fast() { return !std::is_same<top, tfastop>::value; }
+
                 // attributes
                 tensor3d_dim_t m_xdims{{0, 0, 0}};     ///< input/output dimensions
+                int             m_fast{0};              ///< use the fast approximation
         };
 
-        template <typename top>
-        rlayer_t activation_layer_t<top>::clone() const
+        template <typename top, typename tfastop>
+        rlayer_t activation_layer_t<top, tfastop>::clone() const
+        {
+                return std::make_unique<activation_layer_t<top, tfastop>>(*this);
+        }
+
+        template <typename top, typename tfastop>
+        void activation_layer_t<top, tfastop>::to_json(json_t& json) const
+        {
+                if (has_fast() && m_fast)
+                {
+                        nano::to_json(json, "fast", m_fast);
+                }
+        }
+
+        template <typename top, typename tfastop>
+        void activation_layer_t<top, tfastop>::from_json(const json_t& json)
         {
-                return std::make_unique<activation_layer_t<top>>(*this);
+                if (has_fast())
+                {
+                        nano::from_json(json, "fast", m_fast);
+                }
         }
 
-        template <typename top>
-        bool activation_layer_t<top>::resize(const tensor3d_dims_t& idims)
+        template <typename top, typename tfastop>
+        bool activation_layer_t<top, tfastop>::resize(const tensor3d_dims_t& idims)
         {
                 if (idims.size() != 1)
                 {
@@ -54,39 +81,53 @@ namespace nano
                 return true;
         }
 
-        template <typename top>
-        void activation_layer_t<top>::random(vector_map_t pdata) const
+        template <typename top, typename tfastop>
+        void activation_layer_t<top, tfastop>::random(vector_map_t pdata) const
         {
                 assert(pdata.size() == psize());
                 NANO_UNUSED1_RELEASE(pdata);
         }
 
-        template <typename top>
-        void activation_layer_t<top>::output(tensor4d_cmaps_t idata, vector_cmap_t pdata, tensor4d_map_t odata)
+        template <typename top, typename tfastop>
+        void activation_layer_t<top, tfastop>::output(const tensor4d_cmaps_t& idata, vector_cmap_t pdata, tensor4d_map_t odata)
         {
                 assert(idata.size() == 1);
                 assert(idata[0].dims() == odata.dims());
                 assert(pdata.size() == psize());
 
-                top::output(idata[0].array(), odata.array());
+                if (m_fast)
+                {
+                        tfastop::output(idata[0].array(), odata.array());
+                }
+                else
+                {
+                        top::output(idata[0].array(), odata.array());
+                }
 
                 NANO_UNUSED1_RELEASE(pdata);
         }
 
-        template <typename top>
-        void activation_layer_t<top>::ginput(tensor4d_maps_t idata, vector_cmap_t pdata, tensor4d_cmap_t odata)
+        template <typename top, typename tfastop>
+        void activation_layer_t<top, tfastop>::ginput(const tensor4d_maps_t& idata, vector_cmap_t pdata, tensor4d_cmap_t odata)
         {
                 assert(idata.size() == 1);
                 assert(idata[0].dims() == odata.dims());
                 assert(pdata.size() == psize());
 
-                top::ginput(idata[0].array(), odata.array());
+                if (m_fast)
+                {
+                        tfastop::ginput(idata[0].array(), odata.array());
+                }
+                else
+                {
+                        top::ginput(idata[0].array(), odata.array());
+                }
 
                 NANO_UNUSED1_RELEASE(pdata);
         }
 
-        template <typename top>
-        void activation_layer_t<top>::gparam(tensor4d_cmaps_t idata, vector_map_t pdata, tensor4d_cmap_t odata)
+        template <typename top, typename tfastop>
+        void activation_layer_t<top, tfastop>::gparam(const tensor4d_cmaps_t& idata, vector_map_t pdata, tensor4d_cmap_t odata)
         {
                 assert(idata.size() == 1);
                 assert(idata[0].dims() == odata.dims());
@@ -152,7 +193,27 @@ namespace nano
                 }
         };
 
-        using activation_layer_tanh_t = activation_layer_t<activation_tanh_t>;
+        ///
+        /// \brief fast approximation of the hyperbolic tangent activation function (see fast::tanh for its accuracy)
+        ///     with the gradient computed from the approximation (max error < 6e-7).
+        ///
+        struct activation_fast_tanh_t
+        {
+                template <typename tiarray, typename toarray>
+                static void output(const tiarray& idata, toarray&& odata)
+                {
+                        fast::tanh(idata, odata);
+                }
+
+                template <typename tiarray, typename toarray>
+                static void ginput(tiarray&& idata, const toarray& odata)
+                {
+                        fast::tanh(idata, idata);
+                        idata = odata * (1 - idata.square());
+                }
+        };
+
+        using activation_layer_tanh_t = activation_layer_t<activation_tanh_t, activation_fast_tanh_t>;
 
         ///
         /// \brief e^x/(1+e^x) sigmoid activation function.
@@ -172,7 +233,27 @@ namespace nano
                 }
         };
 
-        using activation_layer_sigm_t = activation_layer_t<activation_sigm_t>;
+        ///
+        /// \brief fast approximation of the sigmoid activation function (see fast::sigm for its accuracy)
+        ///     with the gradient computed from the approximation (max error < 2e-7).
+        ///
+        struct activation_fast_sigm_t
+        {
+                template <typename tiarray, typename toarray>
+                static void output(const tiarray& idata, toarray&& odata)
+                {
+                        fast::sigm(idata, odata);
+                }
+
+                template <typename tiarray, typename toarray>
+                static void ginput(tiarray&& idata, const toarray& odata)
+                {
+                        fast::sigm(idata, idata);
+                        idata = odata * idata * (1 - idata);
+                }
+        };
+
+        using activation_layer_sigm_t = activation_layer_t<activation_sigm_t, activation_fast_sigm_t>;
 
         ///
         /// \brief x/(1+abs(x)) soft-sign activation function.
@@ -212,7 +293,27 @@ namespace nano
                 }
         };
 
-        using activation_layer_splus_t = activation_layer_t<activation_splus_t>;
+        ///
+        /// \brief fast approximation of the soft-plus activation function (see fast::splus for its accuracy)
+        ///     with the gradient computed from the approximation (max error < 2e-7).
+        ///
+        struct activation_fast_splus_t
+        {
+                template <typename tiarray, typename toarray>
+                static void output(const tiarray& idata, toarray&& odata)
+                {
+                        fast::splus(idata, odata);
+                }
+
+                template <typename tiarray, typename toarray>
+                static void ginput(tiarray&& idata, const toarray& odata)
+                {
+                        fast::sigm(idata, idata);
+                        idata = odata * idata;
+                }
+        };
+
+        using activation_layer_splus_t = activation_layer_t<activation_splus_t, activation_fast_splus_t>;
 
         ///
         /// \brief identity activation function.
@@ -53,19 +53,19 @@ void affine_layer_t::random(vector_map_t pdata) const
         nano::set_random(make_udist<scalar_t>(bmin, bmax), make_rng(), bdata(pdata));
 }
 
-void affine_layer_t::output(tensor4d_cmaps_t idata, vector_cmap_t pdata, tensor4d_map_t odata)
+void affine_layer_t::output(const tensor4d_cmaps_t& idata, vector_cmap_t pdata, tensor4d_map_t odata)
 {
         assert(idata.size() == 1);
         m_kernel.output(idata[0], wdata(pdata), bdata(pdata), odata);
 }
 
-void affine_layer_t::ginput(tensor4d_maps_t idata, vector_cmap_t pdata, tensor4d_cmap_t odata)
+void affine_layer_t::ginput(const tensor4d_maps_t& idata, vector_cmap_t pdata, tensor4d_cmap_t odata)
 {
         assert(idata.size() == 1);
         m_kernel.ginput(idata[0], wdata(pdata), bdata(pdata), odata);
 }
 
-void affine_layer_t::gparam(tensor4d_cmaps_t idata, vector_map_t pdata, tensor4d_cmap_t odata)
+void affine_layer_t::gparam(const tensor4d_cmaps_t& idata, vector_map_t pdata, tensor4d_cmap_t odata)
 {
         assert(idata.size() == 1);
         m_kernel.gparam(idata[0], wdata(pdata), bdata(pdata), odata);
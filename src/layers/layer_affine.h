@@ -13,6 +13,8 @@ namespace nano
         ///     orows   - number of output rows (=1)
         ///     ocols   - number of output cols (=1)
         ///
+        /// NB: the weights are specific to the memory layout of the input tensors.
+        ///
         class affine_layer_t final : public layer_t
         {
         public:
@@ -22,11 +24,12 @@ namespace nano
                 void from_json(const json_t&) final;
 
                 bool resize(const tensor3d_dims_t& idims) final;
+                bool layout(const tensor_layout) final { return true; }
 
                 void random(vector_map_t pdata) const final;
-                void output(tensor4d_cmaps_t idata, vector_cmap_t pdata, tensor4d_map_t odata) final;
-                void ginput(tensor4d_maps_t idata, vector_cmap_t pdata, tensor4d_cmap_t odata) final;
-                void gparam(tensor4d_cmaps_t idata, vector_map_t pdata, tensor4d_cmap_t odata) final;
+                void output(const tensor4d_cmaps_t& idata, vector_cmap_t pdata, tensor4d_map_t odata) final;
+                void ginput(const tensor4d_maps_t& idata, vector_cmap_t pdata, tensor4d_cmap_t odata) final;
+                void gparam(const tensor4d_cmaps_t& idata, vector_map_t pdata, tensor4d_cmap_t odata) final;
 
                 tensor_size_t psize() const final { return m_params.psize(); }
                 tensor3d_dim_t odims() const final { return m_params.odims(); }
@@ -34,6 +37,8 @@ namespace nano
                 tensor_size_t flops_ginput() const final { return m_params.flops_ginput(); }
                 tensor_size_t flops_gparam() const final { return m_params.flops_gparam(); }
 
+                const affine_params_t& params() const { return m_params; }
+
         private:
 
                 auto isize() const { return m_params.isize(); }
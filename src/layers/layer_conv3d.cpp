@@ -21,6 +21,12 @@ rlayer_t conv3d_layer_t::clone() const
         return std::make_unique<conv3d_layer_t>(*this);
 }
 
+bool conv3d_layer_t::layout(const tensor_layout layout)
+{
+        m_layout = layout;
+        return true;
+}
+
 bool conv3d_layer_t::resize(const tensor3d_dims_t& idims)
 {
         if (idims.size() != 1)
@@ -36,7 +42,7 @@ bool conv3d_layer_t::resize(const tensor3d_dims_t& idims)
                 return false;
         }
 
-        m_kernel = conv4d_t{m_params};
+        m_kernel = conv4d_t{m_params, m_layout};
         return true;
 }
 
@@ -55,19 +61,19 @@ void conv3d_layer_t::random(vector_map_t pdata) const
         nano::set_random(make_udist<scalar_t>(bmin, bmax), make_rng(), bdata(pdata));
 }
 
-void conv3d_layer_t::output(tensor4d_cmaps_t idata, vector_cmap_t pdata, tensor4d_map_t odata)
+void conv3d_layer_t::output(const tensor4d_cmaps_t& idata, vector_cmap_t pdata, tensor4d_map_t odata)
 {
         assert(idata.size() == 1);
         m_kernel.output(idata[0], kdata(pdata), bdata(pdata), odata);
 }
 
-void conv3d_layer_t::ginput(tensor4d_maps_t idata, vector_cmap_t pdata, tensor4d_cmap_t odata)
+void conv3d_layer_t::ginput(const tensor4d_maps_t& idata, vector_cmap_t pdata, tensor4d_cmap_t odata)
 {
         assert(idata.size() == 1);
         m_kernel.ginput(idata[0], kdata(pdata), bdata(pdata), odata);
 }
 
-void conv3d_layer_t::gparam(tensor4d_cmaps_t idata, vector_map_t pdata, tensor4d_cmap_t odata)
+void conv3d_layer_t::gparam(const tensor4d_cmaps_t& idata, vector_map_t pdata, tensor4d_cmap_t odata)
 {
         assert(idata.size() == 1);
         m_kernel.gparam(idata[0], kdata(pdata), bdata(pdata), odata);
@@ -25,11 +25,12 @@ namespace nano
                 void from_json(const json_t&) final;
 
                 bool resize(const tensor3d_dims_t& idims) final;
+                bool layout(const tensor_layout) final;
 
                 void random(vector_map_t pdata) const final;
-                void output(tensor4d_cmaps_t idata, vector_cmap_t pdata, tensor4d_map_t odata) final;
-                void ginput(tensor4d_maps_t idata, vector_cmap_t pdata, tensor4d_cmap_t odata) final;
-                void gparam(tensor4d_cmaps_t idata, vector_map_t pdata, tensor4d_cmap_t odata) final;
+                void output(const tensor4d_cmaps_t& idata, vector_cmap_t pdata, tensor4d_map_t odata) final;
+                void ginput(const tensor4d_maps_t& idata, vector_cmap_t pdata, tensor4d_cmap_t odata) final;
+                void gparam(const tensor4d_cmaps_t& idata, vector_map_t pdata, tensor4d_cmap_t odata) final;
 
                 tensor_size_t psize() const final { return m_params.psize(); }
                 tensor3d_dim_t odims() const final { return m_params.odims(); }
@@ -55,5 +56,6 @@ namespace nano
                 // attributes
                 conv3d_params_t m_params;
                 conv4d_t        m_kernel;
+                tensor_layout   m_layout{tensor_layout::nchw};
         };
 }
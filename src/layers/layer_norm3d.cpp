@@ -23,6 +23,12 @@ void norm3d_layer_t::random(vector_map_t pdata) const
         NANO_UNUSED1_RELEASE(pdata);
 }
 
+bool norm3d_layer_t::layout(const tensor_layout layout)
+{
+        m_layout = layout;
+        return true;
+}
+
 bool norm3d_layer_t::resize(const tensor3d_dims_t& idims)
 {
         if (idims.size() != 1)
@@ -38,11 +44,11 @@ bool norm3d_layer_t::resize(const tensor3d_dims_t& idims)
                 return false;
         }
 
-        m_kernel = norm4d_t{m_params};
+        m_kernel = norm4d_t{m_params, m_layout};
         return true;
 }
 
-void norm3d_layer_t::output(tensor4d_cmaps_t idata, vector_cmap_t pdata, tensor4d_map_t odata)
+void norm3d_layer_t::output(const tensor4d_cmaps_t& idata, vector_cmap_t pdata, tensor4d_map_t odata)
 {
         assert(idata.size() == 1);
         assert(pdata.size() == psize());
@@ -51,7 +57,7 @@ void norm3d_layer_t::output(tensor4d_cmaps_t idata, vector_cmap_t pdata, tensor4
         m_kernel.output(idata[0], odata);
 }
 
-void norm3d_layer_t::ginput(tensor4d_maps_t idata, vector_cmap_t pdata, tensor4d_cmap_t odata)
+void norm3d_layer_t::ginput(const tensor4d_maps_t& idata, vector_cmap_t pdata, tensor4d_cmap_t odata)
 {
         assert(idata.size() == 1);
         assert(pdata.size() == psize());
@@ -60,7 +66,7 @@ void norm3d_layer_t::ginput(tensor4d_maps_t idata, vector_cmap_t pdata, tensor4d
         m_kernel.ginput(idata[0], odata);
 }
 
-void norm3d_layer_t::gparam(tensor4d_cmaps_t idata, vector_map_t pdata, tensor4d_cmap_t odata)
+void norm3d_layer_t::gparam(const tensor4d_cmaps_t& idata, vector_map_t pdata, tensor4d_cmap_t odata)
 {
         assert(idata.size() == 1);
         assert(pdata.size() == psize());
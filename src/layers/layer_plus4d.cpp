@@ -36,7 +36,7 @@ void plus4d_layer_t::random(vector_map_t pdata) const
         NANO_UNUSED1_RELEASE(pdata);
 }
 
-void plus4d_layer_t::output(tensor4d_cmaps_t idata, vector_cmap_t pdata, tensor4d_map_t odata)
+void plus4d_layer_t::output(const tensor4d_cmaps_t& idata, vector_cmap_t pdata, tensor4d_map_t odata)
 {
         const auto count = odata.size<0>();
         assert(odata.dims() == cat_dims(count, odims()));
@@ -47,7 +47,10 @@ void plus4d_layer_t::output(tensor4d_cmaps_t idata, vector_cmap_t pdata, tensor4
         assert(idata.size() == static_cast<size_t>(m_fanin));
         assert(idata[0].dims() == odata.dims());
 
-        odata = idata[0];
+        if (idata[0].data() != odata.data())
+        {
+                odata = idata[0];
+        }
         for (size_t i = 1; i < idata.size(); ++ i)
         {
                 assert(idata[i].dims() == odata.dims());
@@ -55,7 +58,7 @@ void plus4d_layer_t::output(tensor4d_cmaps_t idata, vector_cmap_t pdata, tensor4
         }
 }
 
-void plus4d_layer_t::ginput(tensor4d_maps_t idata, vector_cmap_t pdata, tensor4d_cmap_t odata)
+void plus4d_layer_t::ginput(const tensor4d_maps_t& idata, vector_cmap_t pdata, tensor4d_cmap_t odata)
 {
         const auto count = odata.size<0>();
         assert(odata.dims() == cat_dims(count, odims()));
@@ -65,14 +68,17 @@ void plus4d_layer_t::ginput(tensor4d_maps_t idata, vector_cmap_t pdata, tensor4d
         assert(idata.size() == static_cast<size_t>(m_fanin));
         assert(idata[0].dims() == odata.dims());
 
-        for (auto& itensor : idata)
+        for (const auto& itensor : idata)
         {
                 assert(itensor.dims() == odata.dims());
-                itensor = odata;
+                if (itensor.data() != odata.data())
+                {
+                        itensor.vector() = odata.vector();
+                }
         }
 }
 
-void plus4d_layer_t::gparam(tensor4d_cmaps_t idata, vector_map_t pdata, tensor4d_cmap_t odata)
+void plus4d_layer_t::gparam(const tensor4d_cmaps_t& idata, vector_map_t pdata, tensor4d_cmap_t odata)
 {
         const auto count = odata.size<0>();
         assert(odata.dims() == cat_dims(count, odims()));
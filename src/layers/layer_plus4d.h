@@ -7,6 +7,8 @@ namespace nano
         ///
         /// \brief add together multiple 4D inputs of the same size.
         ///
+        /// NB: the accumulation is performed in-place if the first input is stored in the output buffer.
+        ///
         class plus4d_layer_t final : public layer_t
         {
         public:
@@ -16,11 +18,12 @@ namespace nano
                 void from_json(const json_t&) final {}
 
                 bool resize(const tensor3d_dims_t& idims) final;
+                bool layout(const tensor_layout) final { return true; }
 
                 void random(vector_map_t pdata) const final;
-                void output(tensor4d_cmaps_t idata, vector_cmap_t pdata, tensor4d_map_t odata) final;
-                void ginput(tensor4d_maps_t idata, vector_cmap_t pdata, tensor4d_cmap_t odata) final;
-                void gparam(tensor4d_cmaps_t idata, vector_map_t pdata, tensor4d_cmap_t odata) final;
+                void output(const tensor4d_cmaps_t& idata, vector_cmap_t pdata, tensor4d_map_t odata) final;
+                void ginput(const tensor4d_maps_t& idata, vector_cmap_t pdata, tensor4d_cmap_t odata) final;
+                void gparam(const tensor4d_cmaps_t& idata, vector_map_t pdata, tensor4d_cmap_t odata) final;
 
                 tensor_size_t psize() const final { return 0; }
                 tensor3d_dim_t odims() const final { return m_odims; }
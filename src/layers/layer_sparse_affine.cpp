@@ -0,0 +1,160 @@
+#include "core/random.h"
+#include "layer_affine.h"
+#include "tensor/numeric.h"
+#include "layer_sparse_affine.h"
+
+using namespace nano;
+
+void sparse_affine_layer_t::from_json(const json_t& json)
+{
+        nano::from_json(json, "omaps", m_params.m_omaps, "orows", m_params.m_orows, "ocols", m_params.m_ocols,
+                "density", m_density);
+
+        m_rowptr.clear();
+        m_colidx.clear();
+        if (json.count("rowptr") && json.count("colidx"))
+        {
+                m_rowptr = json.at("rowptr").get<sparse_indices_t>();
+                m_colidx = json.at("colidx").get<sparse_indices_t>();
+        }
+}
+
+void sparse_affine_layer_t::to_json(json_t& json) const
+{
+        nano::to_json(json, "omaps", m_params.m_omaps, "orows", m_params.m_orows, "ocols", m_params.m_ocols,
+                "density", m_density);
+
+        if (!m_rowptr.empty())
+        {
+                json["rowptr"] = m_rowptr;
+                json["colidx"] = m_colidx;
+        }
+}
+
+rlayer_t sparse_affine_layer_t::clone() const
+{
+        return std::make_unique<sparse_affine_layer_t>(*this);
+}
+
+void sparse_affine_layer_t::pattern(sparse_indices_t rowptr, sparse_indices_t colidx)
+{
+        m_rowptr = std::move(rowptr);
+        m_colidx = std::move(colidx);
+}
+
+bool sparse_affine_layer_t::resize(const tensor3d_dims_t& idims)
+{
+        if (idims.size() != 1)
+        {
+                return false;
+        }
+
+        m_params.m_imaps = std::get<0>(idims[0]);
+        m_params.m_irows = std::get<1>(idims[0]);
+        m_params.m_icols = std::get<2>(idims[0]);
+        if (!m_params.valid() || !(m_density > 0 && m_density <= 1))
+        {
+                return false;
+        }
+
+        // keep the given sparsity pattern if compatible, otherwise generate one
+        m_kernel = sparse_affine4d_t{m_params, m_rowptr, m_colidx};
+        if (!m_kernel.valid())
+        {
+                sparse_affine4d_t::make_pattern(m_params, m_density, m_rowptr, m_colidx);
+                m_kernel = sparse_affine4d_t{m_params, m_rowptr, m_colidx};
+        }
+
+        return m_kernel.valid();
+}
+
+void sparse_affine_layer_t::random(vector_map_t pdata) const
+{
+        assert(pdata.size() == psize());
+
+        const auto fanin = static_cast<scalar_t>(wsize()) / static_cast<scalar_t>(osize());
+        const auto wmin = -std::sqrt(1 / (1 + fanin));
+        const auto wmax = +std::sqrt(1 / (1 + fanin));
+
+        const auto bmin = scalar_t(-0.1);
+        const auto bmax = scalar_t(+0.1);
+
+        nano::set_random(make_udist<scalar_t>(wmin, wmax), make_rng(), wdata(pdata));
+        nano::set_random(make_udist<scalar_t>(bmin, bmax), make_rng(), bdata(pdata));
+}
+
+void sparse_affine_layer_t::output(const tensor4d_cmaps_t& idata, vector_cmap_t pdata, tensor4d_map_t odata)
+{
+        assert(idata.size() == 1);
+        m_kernel.output(idata[0], wdata(pdata), bdata(pdata), odata);
+}
+
+void sparse_affine_layer_t::ginput(const tensor4d_maps_t& idata, vector_cmap_t pdata, tensor4d_cmap_t odata)
+{
+        assert(idata.size() == 1);
+        m_kernel.ginput(idata[0], wdata(pdata), bdata(pdata), odata);
+}
+
+void sparse_affine_layer_t::gparam(const tensor4d_cmaps_t& idata, vector_map_t pdata, tensor4d_cmap_t odata)
+{
+        assert(idata.size() == 1);
+        m_kernel.gparam(idata[0], wdata(pdata), bdata(pdata), odata);
+}
+
+rlayer_t nano::prune_affine(const layer_t& node, vector_cmap_t pdata, const scalar_t density, vector_t& sparse_pdata)
+{
+        const auto* affine = dynamic_cast<const affine_layer_t*>(&node);
+        if (!affine || !(density > 0 && density <= 1))
+        {
+                return nullptr;
+        }
+
+        const auto& params = affine->params();
+        const auto isize = params.isize();
+        const auto osize = params.osize();
+        assert(pdata.size() == params.psize());
+
+        const auto wdata = map_matrix(pdata.data(), osize, isize);
+        const auto bdata = map_vector(pdata.data() + osize * isize, osize);
+
+        // magnitude threshold to keep the requested fraction of weights
+        const auto wsize = osize * isize;
+        const auto nnz = std::max(tensor_size_t(1), std::min(wsize,
+                static_cast<tensor_size_t>(std::lround(density * static_cast<scalar_t>(wsize)))));
+
+        vector_t wabs = map_vector(pdata.data(), wsize).array().abs();
+        std::nth_element(wabs.data(), wabs.data() + (wsize - nnz), wabs.data() + wsize);
+        const auto threshold = wabs(wsize - nnz);
+
+        // CSR pattern & the associated weights
+        sparse_indices_t rowptr(static_cast<size_t>(osize + 1), 0), colidx;
+        scalars_t values;
+        for (tensor_size_t o = 0; o < osize; ++ o)
+        {
+                for (tensor_size_t i = 0; i < isize && static_cast<tensor_size_t>(colidx.size()) < nnz; ++ i)
+                {
+                        if (std::fabs(wdata(o, i)) >= threshold)
+                        {
+                                colidx.push_back(i);
+                                values.push_back(wdata(o, i));
+                        }
+                }
+                rowptr[o + 1] = static_cast<tensor_size_t>(colidx.size());
+        }
+
+        auto sparse = std::make_unique<sparse_affine_layer_t>();
+        sparse->from_json(to_json(
+                "omaps", params.omaps(), "orows", params.orows(), "ocols", params.ocols(), "density", density));
+        sparse->pattern(std::move(rowptr), std::move(colidx));
+        if (!sparse->resize({params.idims()}))
+        {
+                return nullptr;
+        }
+
+        const auto wcount = static_cast<tensor_size_t>(values.size());
+        sparse_pdata.resize(sparse->psize());
+        sparse_pdata.segment(0, wcount) = map_vector(values.data(), wcount);
+        sparse_pdata.segment(wcount, osize) = bdata;
+
+        return sparse;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "layer.h"
+#include "sparse_affine4d.h"
+
+namespace nano
+{
+        ///
+        /// \brief sparse fully-connected affine layer with a fixed sparsity pattern of the weights.
+        ///
+        /// parameters:
+        ///     omaps   - number of output feature maps
+        ///     orows   - number of output rows (=1)
+        ///     ocols   - number of output cols (=1)
+        ///     density - fraction of non-zero weights used to generate the sparsity pattern (if not given)
+        ///     rowptr  - CSR sparsity pattern: offsets of the non-zero weights for each output (optional)
+        ///     colidx  - CSR sparsity pattern: input index of each non-zero weight (optional)
+        ///
+        /// NB: the parameters are the non-zero weights (in CSR order) followed by the bias.
+        ///
+        class sparse_affine_layer_t final : public layer_t
+        {
+        public:
+
+                rlayer_t clone() const final;
+                void to_json(json_t&) const final;
+                void from_json(const json_t&) final;
+
+                bool resize(const tensor3d_dims_t& idims) final;
+                bool layout(const tensor_layout) final { return true; }
+
+                void random(vector_map_t pdata) const final;
+                void output(const tensor4d_cmaps_t& idata, vector_cmap_t pdata, tensor4d_map_t odata) final;
+                void ginput(const tensor4d_maps_t& idata, vector_cmap_t pdata, tensor4d_cmap_t odata) final;
+                void gparam(const tensor4d_cmaps_t& idata, vector_map_t pdata, tensor4d_cmap_t odata) final;
+
+                tensor_size_t psize() const final { return m_kernel.psize(); }
+                tensor3d_dim_t odims() const final { return m_params.odims(); }
+                tensor_size_t flops_output() const final { return m_kernel.flops_output(); }
+                tensor_size_t flops_ginput() const final { return m_kernel.flops_ginput(); }
+                tensor_size_t flops_gparam() const final { return m_kernel.flops_gparam(); }
+
+                ///
+                /// \brief set the sparsity pattern (to be followed by a call to ::resize)
+                ///
+                void pattern(sparse_indices_t rowptr, sparse_indices_t colidx);
+
+        private:
+
+                auto osize() const { return m_params.osize(); }
+                auto wsize() const { return m_kernel.nnz(); }
+
+                template <typename tvector>
+                auto wdata(tvector&& pdata) const { return map_vector(pdata.data(), wsize()); }
+
+                template <typename tvector>
+                auto bdata(tvector&& pdata) const { return map_vector(pdata.data() + wsize(), osize()); }
+
+                // attributes
+                affine_params_t         m_params;
+                scalar_t                m_density{scalar_t(0.1)};
+                sparse_indices_t        m_rowptr;
+                sparse_indices_t        m_colidx;
+                sparse_affine4d_t       m_kernel;
+        };
+
+        ///
+        /// \brief prune a dense affine node by keeping only the given fraction of its weights (the largest in magnitude).
+        ///     returns the equivalent sparse affine node and its parameters (or nullptr if not an affine node).
+        ///
+        NANO_PUBLIC rlayer_t prune_affine(const layer_t& node, vector_cmap_t pdata,
+                const scalar_t density, vector_t& sparse_pdata);
+}
@@ -2,6 +2,14 @@
 
 using namespace nano;
 
+template <typename titensor, typename totensor>
+static bool aliased(const titensor& itensor, const totensor& odata, const tensor_size_t odata_offset)
+{
+        // the input was written directly in its slice of the (single sample, nchw) output
+        return  odata.template size<0>() == 1 &&
+                itensor.data() == odata.data() + odata_offset;
+}
+
 rlayer_t tcat4d_layer_t::clone() const
 {
         return std::make_unique<tcat4d_layer_t>(*this);
@@ -32,13 +40,19 @@ bool tcat4d_layer_t::resize(const tensor3d_dims_t& idims)
         return true;
 }
 
+bool tcat4d_layer_t::layout(const tensor_layout layout)
+{
+        m_layout = layout;
+        return true;
+}
+
 void tcat4d_layer_t::random(vector_map_t pdata) const
 {
         assert(pdata.size() == psize());
         NANO_UNUSED1_RELEASE(pdata);
 }
 
-void tcat4d_layer_t::output(tensor4d_cmaps_t idata, vector_cmap_t pdata, tensor4d_map_t odata)
+void tcat4d_layer_t::output(const tensor4d_cmaps_t& idata, vector_cmap_t pdata, tensor4d_map_t odata)
 {
         const auto count = odata.size<0>();
         const auto omaps = odata.size<1>();
@@ -59,9 +73,18 @@ void tcat4d_layer_t::output(tensor4d_cmaps_t idata, vector_cmap_t pdata, tensor4
 
                 const auto imaps = itensor.size<1>();
                 const auto isize = imaps * orows * ocols;
-                for (tensor_size_t x = 0; x < count; ++ x)
+                for (tensor_size_t x = 0; x < count && !aliased(itensor, odata, odata_offset); ++ x)
                 {
-                        odata.vector(x).segment(odata_offset, isize) = itensor.vector(x);
+                        switch (m_layout)
+                        {
+                        case tensor_layout::nchw:
+                                odata.vector(x).segment(odata_offset, isize) = itensor.vector(x);
+                                break;
+
+                        case tensor_layout::nhwc:
+                                nhwc_matrix(odata, x).middleCols(imaps_offset, imaps) = nhwc_matrix(itensor, x);
+                                break;
+                        }
                 }
 
                 imaps_offset += imaps;
@@ -71,7 +94,7 @@ void tcat4d_layer_t::output(tensor4d_cmaps_t idata, vector_cmap_t pdata, tensor4
         assert(imaps_offset == omaps);
 }
 
-void tcat4d_layer_t::ginput(tensor4d_maps_t idata, vector_cmap_t pdata, tensor4d_cmap_t odata)
+void tcat4d_layer_t::ginput(const tensor4d_maps_t& idata, vector_cmap_t pdata, tensor4d_cmap_t odata)
 {
         const auto count = odata.size<0>();
         const auto omaps = odata.size<1>();
@@ -92,9 +115,18 @@ void tcat4d_layer_t::ginput(tensor4d_maps_t idata, vector_cmap_t pdata, tensor4d
 
                 const auto imaps = itensor.size<1>();
                 const auto isize = imaps * orows * ocols;
-                for (tensor_size_t x = 0; x < count; ++ x)
+                for (tensor_size_t x = 0; x < count && !aliased(itensor, odata, odata_offset); ++ x)
                 {
-                        itensor.vector(x) = odata.vector(x).segment(odata_offset, isize);
+                        switch (m_layout)
+                        {
+                        case tensor_layout::nchw:
+                                itensor.vector(x) = odata.vector(x).segment(odata_offset, isize);
+                                break;
+
+                        case tensor_layout::nhwc:
+                                nhwc_matrix(itensor, x) = nhwc_matrix(odata, x).middleCols(imaps_offset, imaps);
+                                break;
+                        }
                 }
 
                 imaps_offset += imaps;
@@ -104,7 +136,7 @@ void tcat4d_layer_t::ginput(tensor4d_maps_t idata, vector_cmap_t pdata, tensor4d
         assert(imaps_offset == omaps);
 }
 
-void tcat4d_layer_t::gparam(tensor4d_cmaps_t idata, vector_map_t pdata, tensor4d_cmap_t odata)
+void tcat4d_layer_t::gparam(const tensor4d_cmaps_t& idata, vector_map_t pdata, tensor4d_cmap_t odata)
 {
         const auto count = odata.size<0>();
         assert(odata.dims() == cat_dims(count, odims()));
@@ -9,6 +9,9 @@ namespace nano
         ///     - with the same number of samples: first dimension
         ///     - with the same feature map sizes: third & fourth dimensions
         ///
+        /// NB: no copy is performed for the inputs already stored in their slice of the output buffer,
+        ///     which the model arranges only for single samples with the nchw layout (e.g. inference).
+        ///
         class tcat4d_layer_t final : public layer_t
         {
         public:
@@ -18,11 +21,12 @@ namespace nano
                 void from_json(const json_t&) final {}
 
                 bool resize(const tensor3d_dims_t& idims) final;
+                bool layout(const tensor_layout) final;
 
                 void random(vector_map_t pdata) const final;
-                void output(tensor4d_cmaps_t idata, vector_cmap_t pdata, tensor4d_map_t odata) final;
-                void ginput(tensor4d_maps_t idata, vector_cmap_t pdata, tensor4d_cmap_t odata) final;
-                void gparam(tensor4d_cmaps_t idata, vector_map_t pdata, tensor4d_cmap_t odata) final;
+                void output(const tensor4d_cmaps_t& idata, vector_cmap_t pdata, tensor4d_map_t odata) final;
+                void ginput(const tensor4d_maps_t& idata, vector_cmap_t pdata, tensor4d_cmap_t odata) final;
+                void gparam(const tensor4d_cmaps_t& idata, vector_map_t pdata, tensor4d_cmap_t odata) final;
 
                 tensor_size_t psize() const final { return 0; }
                 tensor3d_dim_t odims() const final { return m_odims; }
@@ -34,5 +38,6 @@ namespace nano
 
                 // attributes
                 tensor3d_dim_t  m_odims{{0, 0, 0}};
+                tensor_layout   m_layout{tensor_layout::nchw};
         };
 }
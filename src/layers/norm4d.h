@@ -1,6 +1,8 @@
 #pragma once
 
 #include "norm3d_params.h"
+#include "core/numeric.h"
+#include "tensor/layout.h"
 #include "tensor/numeric.h"
 
 namespace nano
@@ -16,23 +18,29 @@ namespace nano
         /// operation:
         ///     odata = norm(idata)
         ///
+        /// NB: the mean and the inverse standard deviation of each sample (or plane) are computed
+        ///     in a single stable pass (Welford-style merging of cache-sized chunks) and
+        ///     they are cached by ::output to be reused by ::ginput.
+        ///     Thus ::ginput must be called after ::output on the same inputs (checked in debug builds).
+        ///
         class norm4d_t
         {
         public:
                 ///
                 /// \brief constructor
                 ///
-                explicit norm4d_t(const norm3d_params_t& params = norm3d_params_t()) :
-                        m_params(params) {}
+                explicit norm4d_t(const norm3d_params_t& params = norm3d_params_t(),
+                        const tensor_layout layout = tensor_layout::nchw) :
+                        m_params(params), m_layout(layout) {}
 
                 ///
                 /// \brief output
                 ///
                 template <typename tidata, typename todata>
-                void output(const tidata& idata, todata&& odata) const;
+                void output(const tidata& idata, todata&& odata);
 
                 ///
-                /// \brief gradient wrt inputs
+                /// \brief gradient wrt inputs (using the statistics cached by the last call to ::output)
                 ///
                 template <typename tidata, typename todata>
                 void ginput(tidata&& idata, const todata& odata) const;
@@ -42,43 +50,95 @@ namespace nano
                 ///
                 const norm3d_params_t& params() const { return m_params; }
 
+                ///
+                /// \brief cached statistics: (count, 1) or (count, maps)
+                ///
+                const matrix_t& means() const { return m_means; }
+                const matrix_t& istdvs() const { return m_istdvs; }
+
+                ///
+                /// \brief compute the mean and the (population) variance of the given array in a single pass
+                ///
+                template <typename tarray>
+                static void moments(const tarray& array, scalar_t& mean, scalar_t& variance);
+
         private:
 
+                ///
+                /// \brief check if the cached statistics correspond to the given inputs
+                ///
+                template <typename tidata>
+                bool cached(const tidata& idata) const;
+
+                template <typename tarray>
+                bool cached(const tarray& array, const tensor_size_t x, const tensor_size_t i) const
+                {
+                        scalar_t mean, variance;
+                        moments(array, mean, variance);
+
+                        const auto istdv = 1 / std::sqrt(variance);
+                        const auto close = [] (const scalar_t a, const scalar_t b)
+                        {
+                                return a == b || std::fabs(a - b) <= epsilon1<scalar_t>() * (1 + std::fabs(a));
+                        };
+                        return close(mean, m_means(x, i)) && close(istdv, m_istdvs(x, i));
+                }
+
                 template <typename tiarray, typename toarray>
-                static void onorm(const tiarray& iarray, toarray&& oarray)
+                static void onorm(const tiarray& iarray, toarray&& oarray, scalar_t& imean, scalar_t& istdv)
                 {
-                        const auto isum1 = iarray.sum();
-                        const auto isum2 = iarray.square().sum();
-                        const auto count = static_cast<scalar_t>(iarray.size());
-                        const auto imean = isum1 / count;
-                        const auto istdv = std::sqrt(isum2 * count - isum1 * isum1) / count;
+                        scalar_t ivar;
+                        moments(iarray, imean, ivar);
+                        istdv = 1 / std::sqrt(ivar);
 
-                        oarray = (iarray - imean) / istdv;
+                        oarray = (iarray - imean) * istdv;
                 }
 
                 template <typename tiarray, typename toarray>
-                static void gnorm(tiarray&& iarray, const toarray& oarray)
+                static void gnorm(tiarray&& iarray, const toarray& oarray, const scalar_t imean, const scalar_t istdv)
                 {
-                        const auto isum1 = iarray.sum();
-                        const auto isum2 = iarray.square().sum();
                         const auto count = static_cast<scalar_t>(iarray.size());
-                        const auto imean = isum1 / count;
-                        const auto istdv = std::sqrt(isum2 * count - isum1 * isum1) / count;
-
-                        const auto osum1 = oarray.sum();
-                        const auto oisum = (oarray * (iarray - imean)).sum();
+                        const auto omean = oarray.sum() / count;
+                        const auto oxmean = (oarray * (iarray - imean)).sum() * istdv / count;
 
-                        iarray = oarray / (istdv) -
-                                 osum1 / (count * istdv) -
-                                 (iarray - imean) * oisum / (count * istdv * istdv * istdv);
+                        iarray = istdv * (oarray - omean - (iarray - imean) * (istdv * oxmean));
                 }
 
                 // attributes
                 norm3d_params_t m_params;
+                tensor_layout   m_layout;
+                matrix_t        m_means;        ///< cached mean per sample or plane
+                matrix_t        m_istdvs;       ///< cached inverse standard deviation per sample or plane
         };
 
+        template <typename tarray>
+        void norm4d_t::moments(const tarray& array, scalar_t& mean, scalar_t& variance)
+        {
+                // NB: two vectorized passes per chunk (while in cache), then merge the chunks (Chan et al.)
+                const auto chunk = tensor_size_t(1024);
+                const auto size = static_cast<tensor_size_t>(array.size());
+
+                auto m2 = scalar_t(0);
+                mean = 0;
+                for (tensor_size_t begin = 0; begin < size; begin += chunk)
+                {
+                        const auto length = std::min(chunk, size - begin);
+                        const auto segment = array.segment(begin, length);
+
+                        const auto cmean = segment.sum() / static_cast<scalar_t>(length);
+                        const auto cm2 = (segment - cmean).square().sum();
+
+                        const auto delta = cmean - mean;
+                        const auto weight = static_cast<scalar_t>(length) / static_cast<scalar_t>(begin + length);
+                        mean += delta * weight;
+                        m2 += cm2 + delta * delta * static_cast<scalar_t>(begin) * weight;
+                }
+
+                variance = m2 / static_cast<scalar_t>(size);
+        }
+
         template <typename tidata, typename todata>
-        void norm4d_t::output(const tidata& idata, todata&& odata) const
+        void norm4d_t::output(const tidata& idata, todata&& odata)
         {
                 assert(m_params.valid(idata) && m_params.valid(odata));
 
@@ -88,17 +148,34 @@ namespace nano
                 switch (m_params.m_ntype)
                 {
                 case norm_type::global:
+                        m_means.resize(count, 1);
+                        m_istdvs.resize(count, 1);
                         for (auto x = 0; x < count; ++ x)
                         {
-                                onorm(idata.array(x), odata.array(x));
+                                onorm(idata.array(x), odata.array(x), m_means(x, 0), m_istdvs(x, 0));
                         }
                         break;
                 case norm_type::plane:
+                        m_means.resize(count, imaps);
+                        m_istdvs.resize(count, imaps);
                         for (auto x = 0; x < count; ++ x)
                         {
-                                for (auto i = 0; i < imaps; ++ i)
+                                switch (m_layout)
                                 {
-                                        onorm(idata.array(x, i), odata.array(x, i));
+                                case tensor_layout::nchw:
+                                        for (auto i = 0; i < imaps; ++ i)
+                                        {
+                                                onorm(idata.array(x, i), odata.array(x, i), m_means(x, i), m_istdvs(x, i));
+                                        }
+                                        break;
+
+                                case tensor_layout::nhwc:
+                                        for (auto i = 0; i < imaps; ++ i)
+                                        {
+                                                onorm(nhwc_matrix(idata, x).col(i).array(), nhwc_matrix(odata, x).col(i).array(),
+                                                        m_means(x, i), m_istdvs(x, i));
+                                        }
+                                        break;
                                 }
                         }
                         break;
@@ -109,6 +186,7 @@ namespace nano
         void norm4d_t::ginput(tidata&& idata, const todata& odata) const
         {
                 assert(m_params.valid(idata) && m_params.valid(odata));
+                assert(cached(idata));
 
                 const auto count = idata.template size<0>();
                 const auto imaps = idata.template size<1>();
@@ -118,18 +196,76 @@ namespace nano
                 case norm_type::global:
                         for (auto x = 0; x < count; ++ x)
                         {
-                                gnorm(idata.array(x), odata.array(x));
+                                gnorm(idata.array(x), odata.array(x), m_means(x, 0), m_istdvs(x, 0));
                         }
                         break;
                 case norm_type::plane:
+                        for (auto x = 0; x < count; ++ x)
+                        {
+                                switch (m_layout)
+                                {
+                                case tensor_layout::nchw:
+                                        for (auto i = 0; i < imaps; ++ i)
+                                        {
+                                                gnorm(idata.array(x, i), odata.array(x, i), m_means(x, i), m_istdvs(x, i));
+                                        }
+                                        break;
+
+                                case tensor_layout::nhwc:
+                                        for (auto i = 0; i < imaps; ++ i)
+                                        {
+                                                gnorm(nhwc_matrix(idata, x).col(i).array(), nhwc_matrix(odata, x).col(i).array(),
+                                                        m_means(x, i), m_istdvs(x, i));
+                                        }
+                                        break;
+                                }
+                        }
+                        break;
+                }
+        }
+
+        template <typename tidata>
+        bool norm4d_t::cached(const tidata& idata) const
+        {
+                const auto count = idata.template size<0>();
+                const auto imaps = idata.template size<1>();
+
+                switch (m_params.m_ntype)
+                {
+                case norm_type::global:
+                        if (m_means.rows() != count || m_means.cols() != 1)
+                        {
+                                return false;
+                        }
+                        for (auto x = 0; x < count; ++ x)
+                        {
+                                if (!cached(idata.array(x), x, 0))
+                                {
+                                        return false;
+                                }
+                        }
+                        break;
+                case norm_type::plane:
+                        if (m_means.rows() != count || m_means.cols() != imaps)
+                        {
+                                return false;
+                        }
                         for (auto x = 0; x < count; ++ x)
                         {
                                 for (auto i = 0; i < imaps; ++ i)
                                 {
-                                        gnorm(idata.array(x, i), odata.array(x, i));
+                                        const auto ok = (m_layout == tensor_layout::nchw) ?
+                                                cached(idata.array(x, i), x, i) :
+                                                cached(nhwc_matrix(idata, x).col(i).array(), x, i);
+                                        if (!ok)
+                                        {
+                                                return false;
+                                        }
                                 }
                         }
                         break;
                 }
+
+                return true;
         }
 }
@@ -0,0 +1,303 @@
+#pragma once
+
+#include "affine_params.h"
+
+namespace nano
+{
+        using sparse_indices_t = std::vector<tensor_size_t>;
+
+        ///
+        /// \brief sparse affine transformation with 4D input and output tensors.
+        ///
+        /// NB: the weight matrix has a fixed sparsity pattern stored in the compressed sparse row (CSR) format:
+        ///     the non-zero weights of the output o are wdata[rowptr[o], rowptr[o + 1]) for the inputs colidx[...].
+        /// NB: the transposed (CSC) pattern is built once to visit the weights by input,
+        ///     so that the zero inputs (e.g. bag-of-words features) are skipped.
+        ///
+        /// parameters:
+        ///     idata: 4D input tensor (count x imaps x irows x icols, with isize = imaps x irows x icols)
+        ///     wdata: non-zero weights (nnz)
+        ///     bdata: bias vector (osize)
+        ///     odata: 4D output tensor (count x omaps x orows x ocols, with osize = omaps x orows x ocols)
+        ///
+        /// operation:
+        ///     odata = W(wdata) * idata + bdata
+        ///
+        class sparse_affine4d_t
+        {
+        public:
+                ///
+                /// \brief constructor
+                ///
+                sparse_affine4d_t() = default;
+                sparse_affine4d_t(const affine_params_t& params, sparse_indices_t rowptr, sparse_indices_t colidx);
+
+                ///
+                /// \brief output
+                ///
+                template <typename tidata, typename twdata, typename tbdata, typename todata>
+                void output(const tidata& idata, const twdata& wdata, const tbdata& bdata, todata&& odata) const;
+
+                ///
+                /// \brief gradient wrt inputs
+                ///
+                template <typename tidata, typename twdata, typename tbdata, typename todata>
+                void ginput(tidata&& idata, const twdata& wdata, const tbdata& bdata, const todata& odata) const;
+
+                ///
+                /// \brief accumulate the gradient wrt parameters (non-zero weights and bias)
+                ///
+                template <typename tidata, typename twdata, typename tbdata, typename todata>
+                void gparam(const tidata& idata, twdata&& wdata, tbdata&& bdata, const todata& odata) const;
+
+                ///
+                /// \brief check if the sparsity pattern is valid
+                ///
+                bool valid() const;
+
+                ///
+                /// \brief parameters
+                ///
+                const affine_params_t& params() const { return m_params; }
+                const sparse_indices_t& rowptr() const { return m_rowptr; }
+                const sparse_indices_t& colidx() const { return m_colidx; }
+
+                tensor_size_t nnz() const { return static_cast<tensor_size_t>(m_colidx.size()); }
+                tensor_size_t psize() const { return nnz() + m_params.osize(); }
+
+                tensor_size_t flops_output() const { return 2 * nnz() + m_params.osize(); }
+                tensor_size_t flops_ginput() const { return 2 * nnz(); }
+                tensor_size_t flops_gparam() const { return 2 * nnz() + m_params.osize(); }
+
+                ///
+                /// \brief create a sparsity pattern with (approximately) the given density
+                ///     by selecting uniformly spaced inputs for each output.
+                ///
+                static void make_pattern(const affine_params_t& params, const scalar_t density,
+                        sparse_indices_t& rowptr, sparse_indices_t& colidx);
+
+        private:
+
+                template <typename tidata, typename twdata, typename tbdata, typename todata>
+                bool valid(const tidata&, const twdata&, const tbdata&, const todata&) const;
+
+                // attributes
+                affine_params_t         m_params;
+                sparse_indices_t        m_rowptr;       ///< CSR: (osize + 1) offsets in colidx
+                sparse_indices_t        m_colidx;       ///< CSR: (nnz) input index of each non-zero weight
+                sparse_indices_t        m_colptr;       ///< CSC: (isize + 1) offsets in rowidx & windex
+                sparse_indices_t        m_rowidx;       ///< CSC: (nnz) output index of each non-zero weight
+                sparse_indices_t        m_windex;       ///< CSC: (nnz) index of each non-zero weight in wdata
+        };
+
+        inline sparse_affine4d_t::sparse_affine4d_t(const affine_params_t& params,
+                sparse_indices_t rowptr, sparse_indices_t colidx) :
+                m_params(params),
+                m_rowptr(std::move(rowptr)),
+                m_colidx(std::move(colidx))
+        {
+                if (!valid())
+                {
+                        return;
+                }
+
+                const auto isize = m_params.isize();
+                const auto osize = m_params.osize();
+
+                // transpose the pattern: count the non-zeros per input, then scatter them
+                m_colptr.assign(static_cast<size_t>(isize + 1), 0);
+                for (const auto i : m_colidx)
+                {
+                        ++ m_colptr[i + 1];
+                }
+                for (tensor_size_t i = 0; i < isize; ++ i)
+                {
+                        m_colptr[i + 1] += m_colptr[i];
+                }
+
+                auto offsets = m_colptr;
+                m_rowidx.resize(m_colidx.size());
+                m_windex.resize(m_colidx.size());
+                for (tensor_size_t o = 0; o < osize; ++ o)
+                {
+                        for (auto k = m_rowptr[o]; k < m_rowptr[o + 1]; ++ k)
+                        {
+                                const auto t = offsets[m_colidx[k]] ++;
+                                m_rowidx[t] = o;
+                                m_windex[t] = k;
+                        }
+                }
+        }
+
+        inline bool sparse_affine4d_t::valid() const
+        {
+                const auto isize = m_params.isize();
+                const auto osize = m_params.osize();
+
+                if (    !m_params.valid() ||
+                        m_rowptr.size() != static_cast<size_t>(osize + 1) ||
+                        m_rowptr.front() != 0 ||
+                        m_rowptr.back() != nnz())
+                {
+                        return false;
+                }
+
+                for (tensor_size_t o = 0; o < osize; ++ o)
+                {
+                        const auto begin = m_rowptr[o];
+                        const auto end = m_rowptr[o + 1];
+                        if (begin > end)
+                        {
+                                return false;
+                        }
+
+                        for (auto k = begin; k < end; ++ k)
+                        {
+                                const auto i = m_colidx[k];
+                                if (    i < 0 || i >= isize ||
+                                        (k > begin && i <= m_colidx[k - 1]))
+                                {
+                                        return false;
+                                }
+                        }
+                }
+
+                return true;
+        }
+
+        inline void sparse_affine4d_t::make_pattern(const affine_params_t& params, const scalar_t density,
+                sparse_indices_t& rowptr, sparse_indices_t& colidx)
+        {
+                const auto isize = params.isize();
+                const auto osize = params.osize();
+                const auto rnnz = std::max(tensor_size_t(1), std::min(isize,
+                        static_cast<tensor_size_t>(std::lround(density * static_cast<scalar_t>(isize)))));
+
+                rowptr.resize(static_cast<size_t>(osize + 1));
+                colidx.resize(static_cast<size_t>(osize * rnnz));
+
+                rowptr[0] = 0;
+                for (tensor_size_t o = 0; o < osize; ++ o)
+                {
+                        // NB: shift the selected inputs with each output to cover all inputs
+                        auto* row = colidx.data() + o * rnnz;
+                        for (tensor_size_t k = 0; k < rnnz; ++ k)
+                        {
+                                row[k] = (o + (k * isize) / rnnz) % isize;
+                        }
+                        std::sort(row, row + rnnz);
+
+                        rowptr[o + 1] = rowptr[o] + rnnz;
+                }
+        }
+
+        template <typename tidata, typename twdata, typename tbdata, typename todata>
+        bool sparse_affine4d_t::valid(const tidata& idata, const twdata& wdata, const tbdata& bdata, const todata& odata) const
+        {
+                const auto count = idata.template size<0>();
+                return  idata.template size<1>() == m_params.imaps() &&
+                        idata.template size<2>() == m_params.irows() &&
+                        idata.template size<3>() == m_params.icols() &&
+                        wdata.size() == nnz() &&
+                        bdata.size() == m_params.osize() &&
+                        odata.template size<0>() == count &&
+                        odata.template size<1>() == m_params.omaps() &&
+                        odata.template size<2>() == m_params.orows() &&
+                        odata.template size<3>() == m_params.ocols();
+        }
+
+        template <typename tidata, typename twdata, typename tbdata, typename todata>
+        void sparse_affine4d_t::output(const tidata& idata, const twdata& wdata, const tbdata& bdata, todata&& odata) const
+        {
+                assert(valid(idata, wdata, bdata, odata));
+
+                const auto count = idata.template size<0>();
+                const auto isize = m_params.isize();
+                const auto osize = m_params.osize();
+
+                auto midata = idata.reshape(count, isize).matrix();
+                auto modata = odata.reshape(count, osize).matrix();
+
+                modata.rowwise() = bdata.transpose();
+                for (tensor_size_t x = 0; x < count; ++ x)
+                {
+                        for (tensor_size_t i = 0; i < isize; ++ i)
+                        {
+                                const auto ivalue = midata(x, i);
+                                if (ivalue == 0)
+                                {
+                                        continue;
+                                }
+
+                                for (auto t = m_colptr[i]; t < m_colptr[i + 1]; ++ t)
+                                {
+                                        modata(x, m_rowidx[t]) += wdata(m_windex[t]) * ivalue;
+                                }
+                        }
+                }
+        }
+
+        template <typename tidata, typename twdata, typename tbdata, typename todata>
+        void sparse_affine4d_t::ginput(tidata&& idata, const twdata& wdata, const tbdata& bdata, const todata& odata) const
+        {
+                assert(valid(idata, wdata, bdata, odata));
+                NANO_UNUSED1_RELEASE(bdata);
+
+                const auto count = idata.template size<0>();
+                const auto isize = m_params.isize();
+                const auto osize = m_params.osize();
+
+                auto midata = idata.reshape(count, isize).matrix();
+                auto modata = odata.reshape(count, osize).matrix();
+
+                midata.setZero();
+                for (tensor_size_t x = 0; x < count; ++ x)
+                {
+                        for (tensor_size_t o = 0; o < osize; ++ o)
+                        {
+                                const auto ovalue = modata(x, o);
+                                if (ovalue == 0)
+                                {
+                                        continue;
+                                }
+
+                                for (auto k = m_rowptr[o]; k < m_rowptr[o + 1]; ++ k)
+                                {
+                                        midata(x, m_colidx[k]) += wdata(k) * ovalue;
+                                }
+                        }
+                }
+        }
+
+        template <typename tidata, typename twdata, typename tbdata, typename todata>
+        void sparse_affine4d_t::gparam(const tidata& idata, twdata&& wdata, tbdata&& bdata, const todata& odata) const
+        {
+                assert(valid(idata, wdata, bdata, odata));
+
+                const auto count = idata.template size<0>();
+                const auto isize = m_params.isize();
+                const auto osize = m_params.osize();
+
+                auto midata = idata.reshape(count, isize).matrix();
+                auto modata = odata.reshape(count, osize).matrix();
+
+                wdata.setZero();
+                for (tensor_size_t x = 0; x < count; ++ x)
+                {
+                        for (tensor_size_t i = 0; i < isize; ++ i)
+                        {
+                                const auto ivalue = midata(x, i);
+                                if (ivalue == 0)
+                                {
+                                        continue;
+                                }
+
+                                for (auto t = m_colptr[i]; t < m_colptr[i + 1]; ++ t)
+                                {
+                                        wdata(m_windex[t]) += modata(x, m_rowidx[t]) * ivalue;
+                                }
+                        }
+                }
+                bdata.noalias() = modata.colwise().sum();
+        }
+}
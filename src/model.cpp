@@ -7,6 +7,7 @@
 #include "core/ibstream.h"
 #include "core/obstream.h"
 #include "core/algorithm.h"
+#include "layers/layer_sparse_affine.h"
 
 using namespace nano;
 
@@ -34,6 +35,39 @@ static void reindex(indices_t& indices, const indices_t& order)
         }
 }
 
+static vector_t cat_params(const std::vector<vector_t>& pdatas)
+{
+        tensor_size_t size = 0;
+        for (const auto& pdata : pdatas)
+        {
+                size += pdata.size();
+        }
+
+        vector_t params(size);
+        tensor_size_t begin = 0;
+        for (const auto& pdata : pdatas)
+        {
+                params.segment(begin, pdata.size()) = pdata;
+                begin += pdata.size();
+        }
+
+        return params;
+}
+
+static std::vector<vector_t> split_params(const vector_t& params, const cnodes_t& nodes)
+{
+        std::vector<vector_t> pdatas;
+        tensor_size_t begin = 0;
+        for (const auto& cnode : nodes)
+        {
+                pdatas.emplace_back(params.segment(begin, cnode.m_node->psize()));
+                begin += cnode.m_node->psize();
+        }
+
+        assert(begin == params.size());
+        return pdatas;
+}
+
 rmodel_t model_t::clone() const
 {
         return std::make_unique<model_t>(*this);
@@ -44,30 +78,170 @@ void model_t::clear()
         m_nodes.clear();
 }
 
-tensor_size_t model_t::xsize(const tensor_size_t count) const
+tensor_size_t model_t::arrange(const tensor_size_t count, std::vector<tensor_size_t>& obegins) const
+{
+        return arrange(count, obegins, m_checkpoints);
+}
+
+tensor_size_t model_t::arrange(const tensor_size_t count, std::vector<tensor_size_t>& obegins, const indices_t& checkpoints) const
 {
         assert(!m_nodes.empty());
 
-        tensor_size_t sum = nano::size(m_idims);
+        const auto npos = string_t::npos;
+
+        // the outputs of the checkpointed nodes are kept till the backward pass,
+        //      while the other outputs are recomputed segment by segment (if gradient checkpointing is enabled)
+        std::vector<size_t> segments(m_nodes.size(), npos);
+        for (size_t k = 0, i = 0; k < checkpoints.size(); ++ k)
+        {
+                for ( ; i < checkpoints[k]; ++ i)
+                {
+                        segments[i] = k;
+                }
+                ++ i;
+        }
+
+        // number of consumers of each node's output
+        std::vector<size_t> fanouts(m_nodes.size(), 0);
         for (const auto& cnode : m_nodes)
         {
-                sum += nano::osize(cnode.m_node);
+                for (const auto inode : cnode.m_inodes)
+                {
+                        ++ fanouts[inode];
+                }
         }
-        return sum * count;
+
+        // the output of a node consumed only by a mixing node can be stored directly in the mixing node's output:
+        //      - mix-plus: the first input is accumulated in-place (for any number of samples)
+        //      - mix-tcat: the inputs are written directly in their slices of the output, but only to evaluate
+        //              single samples (e.g. inference) with nchw, as the tensor maps have no sample stride:
+        //              the minibatches (e.g. training) still copy the inputs into the concatenated output
+        //
+        // NB: the checkpointed outputs cannot be shared as they are overwritten by gradients before being used again.
+        const auto shareable = [&] (const size_t inode, const size_t onode)
+        {
+                return  fanouts[inode] == 1 &&
+                        (checkpoints.empty() || (segments[inode] != npos && segments[onode] != npos));
+        };
+
+        const auto inplace_tcat = m_layout == tensor_layout::nchw && count == 1;
+
+        std::vector<std::pair<size_t, tensor_size_t>> owners(m_nodes.size(), std::make_pair(npos, tensor_size_t(0)));
+        for (size_t i = 0; i < m_nodes.size(); ++ i)
+        {
+                const auto& cnode = m_nodes[i];
+                if (cnode.m_type == plus4d_node_name() && !cnode.m_inodes.empty())
+                {
+                        const auto inode = cnode.m_inodes[0];
+                        if (shareable(inode, i))
+                        {
+                                owners[inode] = std::make_pair(i, tensor_size_t(0));
+                        }
+                }
+                else if (cnode.m_type == tcat4d_node_name() && inplace_tcat)
+                {
+                        tensor_size_t offset = 0;
+                        for (const auto inode : cnode.m_inodes)
+                        {
+                                if (shareable(inode, i))
+                                {
+                                        owners[inode] = std::make_pair(i, offset);
+                                }
+                                offset += nano::osize(m_nodes[inode].m_node);
+                        }
+                }
+        }
+
+        // assign the output buffers starting from the output node (the owners are processed first):
+        //      the stored outputs first and then the recomputed ones (overlapping across segments)
+        tensor_size_t oend = count * nano::size(m_idims);
+
+        obegins.resize(m_nodes.size());
+        for (const auto stored : {true, false})
+        {
+                const auto obase = oend;
+
+                auto obegin = obase;
+                auto segment = npos;
+                for (size_t i = m_nodes.size(); i > 0; -- i)
+                {
+                        if ((segments[i - 1] == npos) != stored)
+                        {
+                                continue;
+                        }
+                        if (segments[i - 1] != segment)
+                        {
+                                obegin = obase;
+                                segment = segments[i - 1];
+                        }
+
+                        const auto& owner = owners[i - 1];
+                        if (owner.first == npos)
+                        {
+                                obegins[i - 1] = obegin;
+                                obegin += count * nano::osize(m_nodes[i - 1].m_node);
+                                oend = std::max(oend, obegin);
+                        }
+                        else
+                        {
+                                assert(owner.first >= i);
+                                obegins[i - 1] = obegins[owner.first] + owner.second;
+                        }
+                }
+        }
+
+        return oend;
+}
+
+tensor_size_t model_t::xsize(const tensor_size_t count) const
+{
+        std::vector<tensor_size_t> obegins;
+        return arrange(count, obegins);
 }
 
-void model_t::allocate(const tensor_size_t count)
+void model_t::reserve(const tensor_size_t count)
 {
-        m_xdata.resize(xsize(count));
+        reserve(m_xdata, m_plan, count);
+}
 
-        tensor_size_t obegin = count * nano::size(m_idims);
-        for (auto& cnode : m_nodes)
+void model_t::reserve(vector_t& xdata, cplan_t& cplan, const tensor_size_t count) const
+{
+        assert(count > 0);
+
+        std::vector<tensor_size_t> obegins;
+        const auto xsize = arrange(count, obegins);
+        if (xdata.size() < xsize)
         {
-                cnode.m_obegin = obegin;
-                obegin += count * nano::osize(cnode.m_node);
+                // NB: the buffers are moved, so the maps of the execution plan are invalidated
+                xdata.resize(xsize);
+                xdata.setZero();
+                cplan.clear();
         }
+}
 
-        assert(obegin == m_xdata.size());
+const cplan_t::csteps_t& model_t::plan(const tensor_size_t count)
+{
+        return plan(m_nodes, m_xdata, m_plan, count);
+}
+
+const cplan_t::csteps_t& model_t::plan(cnodes_t& nodes, vector_t& xdata, cplan_t& cplan, const tensor_size_t count)
+{
+        const auto* steps = cplan.find(count);
+        if (steps)
+        {
+                return *steps;
+        }
+
+        reserve(xdata, cplan, count);
+
+        std::vector<tensor_size_t> obegins;
+        arrange(count, obegins);
+        for (size_t i = 0; i < nodes.size(); ++ i)
+        {
+                nodes[i].m_obegin = obegins[i];
+        }
+
+        return cplan.compile(nodes, count, m_idims, xdata, m_pdata, m_fdata, m_gdata);
 }
 
 size_t model_t::find_node(const string_t& name) const
@@ -98,7 +272,11 @@ bool model_t::add(const json_t& json)
                 }
                 node->from_json(json);
 
+                int frozen = 0;
+                nano::from_json(json, "frozen", frozen);
+
                 m_nodes.emplace_back(name, type, std::move(node));
+                m_nodes.rbegin()->m_frozen = frozen != 0;
                 return true;
         }
         catch (std::exception& e)
@@ -153,6 +331,19 @@ bool model_t::from_json(const json_t& json)
                 const auto& json_nodes = json.at("nodes");
                 const auto& json_model = json.at("model");
 
+                m_layout = tensor_layout::nchw;
+                nano::from_json(json, "layout", m_layout);
+
+                m_checkpoint_names.clear();
+                m_checkpoint_budget = 0;
+                if (json.count("checkpoints"))
+                {
+                        const auto& json_checkpoints = json.at("checkpoints");
+                        m_checkpoint_names = json_checkpoints.is_string() ?
+                                strings_t{json_checkpoints.get<string_t>()} : json_checkpoints.get<strings_t>();
+                        nano::from_json(json, "checkpoint_budget", m_checkpoint_budget);
+                }
+
                 for (const auto& json_node : json_nodes)
                 {
                         if (!add(json_node))
@@ -266,6 +457,12 @@ bool model_t::done()
 json_t model_t::to_json() const
 {
         json_t json;
+        nano::to_json(json, "layout", m_layout);
+        if (!m_checkpoint_names.empty())
+        {
+                json["checkpoints"] = m_checkpoint_names;
+                nano::to_json(json, "checkpoint_budget", m_checkpoint_budget);
+        }
 
         auto&& json_nodes = (json["nodes"] = json_t::array());
         for (const auto& node : m_nodes)
@@ -275,6 +472,10 @@ json_t model_t::to_json() const
                 json_node["name"] = node.m_name;
                 json_node["type"] = node.m_type;
                 node.m_node->to_json(json_node);
+                if (node.m_frozen)
+                {
+                        nano::to_json(json_node, "frozen", 1);
+                }
         }
 
         auto&& json_model = json["model"];
@@ -299,6 +500,78 @@ json_t model_t::to_json() const
         return json;
 }
 
+bool model_t::prune(const string_t& name, const scalar_t density)
+{
+        log_info() << "model: pruning node [" << name << "] to a density of [" << density << "]...";
+
+        const auto index = find_node(name);
+        if (index == string_t::npos)
+        {
+                log_error() << "model: unknown node [" << name << "]!";
+                return false;
+        }
+
+        auto& cnode = m_nodes[index];
+        if (cnode.m_type != affine_node_name() || m_pdata.size() + m_fdata.size() == 0)
+        {
+                log_error() << "model: only resized nodes of type [" << affine_node_name() << "] can be pruned!";
+                return false;
+        }
+
+        vector_t sparse_pdata;
+        const vector_t& cpbuffer = pbuffer(cnode);
+        auto node = prune_affine(*cnode.m_node, cnode.pdata(cpbuffer), density, sparse_pdata);
+        if (!node)
+        {
+                log_error() << "model: failed to prune node [" << name << "]!";
+                return false;
+        }
+
+        auto pdatas = nparams();
+        pdatas[index] = sparse_pdata;
+
+        cnode.m_type = sparse_affine_node_name();
+        cnode.m_node = std::move(node);
+        if (!resize(m_idims, m_odims))
+        {
+                return false;
+        }
+
+        nparams(pdatas);
+        return true;
+}
+
+bool model_t::freeze(const strings_t& names, const bool frozen)
+{
+        for (const auto& name : names)
+        {
+                if (find_node(name) == string_t::npos)
+                {
+                        log_error() << "model: unknown node [" << name << "]!";
+                        return false;
+                }
+        }
+
+        const auto resized = m_nodes.empty() ? false : (m_pdata.size() + m_fdata.size() > 0);
+        const auto pdatas = resized ? nparams() : std::vector<vector_t>{};
+
+        for (const auto& name : names)
+        {
+                m_nodes[find_node(name)].m_frozen = frozen;
+        }
+
+        if (resized)
+        {
+                if (!resize(m_idims, m_odims))
+                {
+                        return false;
+                }
+                nparams(pdatas);
+        }
+
+        return true;
+}
+
 bool model_t::save(const string_t& path) const
 {
         const auto json = to_json();
@@ -307,7 +580,7 @@ bool model_t::save(const string_t& path) const
         return  ob.write(idims()) &&
                 ob.write(odims()) &&
                 ob.write(json.dump()) &&
-                ob.write_vector(params());
+                ob.write_vector(cat_params(nparams()));
 }
 
 bool model_t::load(const string_t& path)
@@ -323,8 +596,8 @@ bool model_t::load(const string_t& path)
                 ib.read_vector(pdata) &&
                 from_json(json_t::parse(json)) &&
                 resize(idims, odims) &&
-                pdata.size() == psize() &&
-                [&] () { params(pdata); return true; }();
+                pdata.size() == psize() + m_fdata.size() &&
+                [&] () { nparams(split_params(pdata, m_nodes)); return true; }();
 }
 
 void model_t::params(const vector_t& pdata)
@@ -340,12 +613,13 @@ void model_t::random()
         {
                 if (cnode.m_node->psize() > 0)
                 {
-                        cnode.m_node->random(cnode.pdata(m_pdata));
+                        cnode.m_node->random(cnode.pdata(pbuffer(cnode)));
                 }
         }
         m_gdata.setZero();
 
         assert(m_pdata.array().isFinite().all());
+        assert(m_fdata.array().isFinite().all());
 }
 
 tensor4d_cmap_t model_t::output(const tensor4d_t& idata)
@@ -358,27 +632,79 @@ tensor4d_cmap_t model_t::output(const tensor4d_t& idata)
         const auto count = idata.size<0>();
         m_probe_output.measure([&] ()
         {
-                // allocate buffers if the count (aka the number of samples to process at once) changed
-                if (m_xdata.size() != xsize(count))
-                {
-                        allocate(count);
-                }
+                // allocate buffers only if more samples than ever before are processed at once
+                const auto& steps = plan(count);
 
                 // forward step
-                cnode_t::idata(m_xdata, count, m_idims) = idata;
-                for (auto& cnode : m_nodes)
-                {
-                        cnode.output(
-                                cnode.idata(cxdata(), count, m_nodes, m_idims),
-                                cnode.pdata(cpdata()),
-                                cnode.odata(m_xdata, count));
-                }
+                nano::convert(idata, tensor_layout::nchw, cnode_t::idata(m_xdata, count, m_idims), m_layout);
+                forward(m_nodes, steps, 0, m_nodes.size());
         }, count);
 
         assert(m_xdata.array().isFinite().all());
         assert(m_pdata.array().isFinite().all());
 
-        return onode().odata(cxdata(), count);
+        return odata(*m_plan.find(count), m_odata, count);
+}
+
+tensor4d_cmap_t model_t::prefix_output(const tensor4d_t& idata)
+{
+        assert(idata.tensor(0).dims() == idims());
+        assert(m_fprefix > 0);
+
+        const auto count = idata.size<0>();
+        const auto& steps = plan(count);
+
+        nano::convert(idata, tensor_layout::nchw, cnode_t::idata(m_xdata, count, m_idims), m_layout);
+        forward(m_nodes, steps, 0, m_fprefix);
+
+        return steps[m_fprefix - 1].m_ocdata;
+}
+
+tensor4d_cmap_t model_t::suffix_output(const tensor4d_t& fdata)
+{
+        assert(fdata.tensor(0).dims() == prefix_odims());
+        assert(fdata.array().isFinite().all());
+        assert(m_fprefix > 0);
+
+        const auto count = fdata.size<0>();
+        m_probe_output.measure([&] ()
+        {
+                const auto& steps = plan(count);
+
+                steps[m_fprefix - 1].m_odata.vector() = fdata.vector();
+                forward(m_nodes, steps, m_fprefix, m_nodes.size());
+        }, count);
+
+        return odata(*m_plan.find(count), m_odata, count);
+}
+
+void model_t::forward(cnodes_t& nodes, const cplan_t::csteps_t& steps, const size_t begin, const size_t end)
+{
+        for (size_t i = begin; i < end; ++ i)
+        {
+                const auto& step = steps[i];
+                nodes[i].output(step.m_icdata, step.m_pdata, step.m_odata);
+        }
+}
+
+tensor4d_cmap_t model_t::odata(const cplan_t::csteps_t& steps, tensor4d_t& obuffer, const tensor_size_t count)
+{
+        const auto& ocdata = steps.rbegin()->m_ocdata;
+        if (m_layout == tensor_layout::nchw || nano::size(m_odims) == std::get<0>(m_odims))
+        {
+                return ocdata;
+        }
+        else
+        {
+                if (obuffer.size() < count * nano::size(m_odims))
+                {
+                        obuffer.resize(cat_dims(count, m_odims));
+                }
+                nano::convert(ocdata, m_layout, map_tensor(obuffer.data(), cat_dims(count, m_odims)), tensor_layout::nchw);
+
+                const auto& codata = obuffer;
+                return map_tensor(codata.data(), cat_dims(count, m_odims));
+        }
 }
 
 const vector_t& model_t::gparam(const tensor4d_t& odata)
@@ -392,25 +718,13 @@ const vector_t& model_t::gparam(const tensor4d_t& odata)
         const auto count = odata.size<0>();
         m_probe_gparam.measure([&] ()
         {
-                assert(m_xdata.size() == xsize(count));
+                const auto* psteps = m_plan.find(count);
+                assert(psteps);
+                const auto& steps = *psteps;
 
                 // backward step
-                onode().odata(m_xdata, count) = odata;
-                for (auto it = m_nodes.rbegin(); it != m_nodes.rend(); ++ it)
-                {
-                        auto& cnode = *it;
-                        cnode.gparam(
-                                cnode.idata(cxdata(), count, m_nodes, m_idims),
-                                cnode.pdata(m_gdata),
-                                cnode.odata(cxdata(), count));
-                        if (!cnode.m_inodes.empty())
-                        {
-                                cnode.ginput(
-                                        cnode.idata(m_xdata, count, m_nodes, m_idims),
-                                        cnode.pdata(cpdata()),
-                                        cnode.odata(cxdata(), count));
-                        }
-                }
+                nano::convert(odata, tensor_layout::nchw, steps.rbegin()->m_odata, m_layout);
+                backprop(m_nodes, steps, 0, m_nodes.size());
         }, count);
 
         assert(m_xdata.array().isFinite().all());
@@ -420,13 +734,330 @@ const vector_t& model_t::gparam(const tensor4d_t& odata)
         return m_gdata;
 }
 
+void model_t::backprop(cnodes_t& nodes, const cplan_t::csteps_t& steps, const size_t begin, const size_t end)
+{
+        if (m_checkpoints.empty())
+        {
+                backward(nodes, steps, std::max(begin, m_fprefix), std::max(end, m_fprefix));
+        }
+        else
+        {
+                // NB: the frozen prefix ends with a checkpoint
+                for (size_t k = m_checkpoints.size(); k > 0 && m_checkpoints[k - 1] >= m_fprefix; -- k)
+                {
+                        const auto sbegin = (k > 1) ? (m_checkpoints[k - 2] + 1) : size_t(0);
+                        const auto send = m_checkpoints[k - 1] + 1;
+                        if (send <= begin || sbegin >= end)
+                        {
+                                continue;
+                        }
+                        assert(begin <= sbegin && send <= end);
+
+                        // recompute the outputs of the segment (the last one is still available)
+                        for (size_t i = sbegin; i + 1 < send && k < m_checkpoints.size(); ++ i)
+                        {
+                                const auto& step = steps[i];
+                                nodes[i].output(step.m_icdata, step.m_pdata, step.m_odata);
+                        }
+
+                        backward(nodes, steps, sbegin, send);
+                }
+        }
+}
+
+void model_t::backward(cnodes_t& nodes, const cplan_t::csteps_t& steps, const size_t begin, const size_t end)
+{
+        for (size_t i = end; i > begin; -- i)
+        {
+                auto& cnode = nodes[i - 1];
+                const auto& step = steps[i - 1];
+                if (!cnode.m_frozen)
+                {
+                        cnode.gparam(step.m_icdata, step.m_gdata, step.m_ocdata);
+                }
+
+                // NB: the gradient wrt the outputs of the frozen prefix is not needed
+                const auto& inodes = cnode.m_inodes;
+                if (std::any_of(inodes.begin(), inodes.end(), [&] (const size_t inode) { return inode >= m_fprefix; }))
+                {
+                        cnode.ginput(step.m_idata, step.m_pdata, step.m_ocdata);
+                }
+        }
+}
+
+indices_t model_t::stages(const size_t count) const
+{
+        assert(count > 0);
+        assert(!m_nodes.empty());
+
+        const auto cost = [] (const cnode_t& cnode)
+        {
+                return  cnode.m_node->flops_output() +
+                        cnode.m_node->flops_gparam() +
+                        cnode.m_node->flops_ginput();
+        };
+
+        tensor_size_t total = 0;
+        for (const auto& cnode : m_nodes)
+        {
+                total += cost(cnode);
+        }
+
+        // greedily cut when the cumulated cost reaches the next multiple of the average cost per stage
+        indices_t stages{0};
+        tensor_size_t cumulated = 0;
+        for (size_t i = 0; i + 1 < m_nodes.size(); ++ i)
+        {
+                cumulated += cost(m_nodes[i]);
+
+                const auto cut = m_checkpoints.empty() ||
+                        std::binary_search(m_checkpoints.begin(), m_checkpoints.end(), i);
+                if (cut && stages.size() < count &&
+                    cumulated * static_cast<tensor_size_t>(count) >= total * static_cast<tensor_size_t>(stages.size()))
+                {
+                        stages.push_back(i + 1);
+                }
+        }
+        stages.push_back(m_nodes.size());
+
+        return stages;
+}
+
+void model_t::micros(const size_t count)
+{
+        // NB: the model's own buffers are not needed while the micro-batches are processed
+        m_xdata = vector_t();
+        m_odata = tensor4d_t();
+        m_plan.clear();
+
+        m_micros.m_states.clear();
+        m_micros.m_states.reserve(count);
+        for (size_t m = 0; m < count; ++ m)
+        {
+                m_micros.m_states.emplace_back(m_nodes);
+        }
+}
+
+tensor4d_cmap_t model_t::output(const size_t micro, const tensor4d_t& idata, const size_t begin, const size_t end)
+{
+        assert(micro < micros());
+        assert(idata.tensor(0).dims() == idims());
+        assert(begin < end && end <= m_nodes.size());
+
+        auto& state = m_micros.m_states[micro];
+
+        const auto count = idata.size<0>();
+        const auto& steps = plan(state.m_nodes, state.m_xdata, state.m_plan, count);
+
+        if (begin == 0)
+        {
+                nano::convert(idata, tensor_layout::nchw, cnode_t::idata(state.m_xdata, count, m_idims), m_layout);
+        }
+        forward(state.m_nodes, steps, begin, end);
+
+        return (end == m_nodes.size()) ? odata(steps, state.m_odata, count) : steps[end - 1].m_ocdata;
+}
+
+void model_t::gparam(const size_t micro, const tensor4d_t& odata, const size_t begin, const size_t end, vector_t& gdata)
+{
+        assert(micro < micros());
+        assert(odata.tensor(0).dims() == odims());
+        assert(begin < end && end <= m_nodes.size());
+        assert(gdata.size() == psize());
+
+        auto& state = m_micros.m_states[micro];
+
+        const auto count = odata.size<0>();
+        const auto* psteps = state.m_plan.find(count);
+        assert(psteps);
+        const auto& steps = *psteps;
+
+        if (end == m_nodes.size())
+        {
+                nano::convert(odata, tensor_layout::nchw, steps.rbegin()->m_odata, m_layout);
+        }
+        backprop(state.m_nodes, steps, begin, end);
+
+        // NB: the gradient buffer is shared, but each stage overwrites only the segments of its own nodes
+        for (size_t i = std::max(begin, m_fprefix); i < end; ++ i)
+        {
+                const auto& cnode = m_nodes[i];
+                if (!cnode.m_frozen)
+                {
+                        gdata.segment(cnode.m_pbegin, cnode.m_node->psize()) +=
+                        m_gdata.segment(cnode.m_pbegin, cnode.m_node->psize());
+                }
+        }
+}
+
+std::vector<bool> model_t::splits() const
+{
+        // a node splits the computation graph in two if no connection skips over it
+        std::vector<size_t> last_consumers(m_nodes.size(), 0);
+        for (size_t i = 0; i < m_nodes.size(); ++ i)
+        {
+                for (const auto inode : m_nodes[i].m_inodes)
+                {
+                        last_consumers[inode] = std::max(last_consumers[inode], i);
+                }
+        }
+
+        std::vector<bool> splits(m_nodes.size(), false);
+        for (size_t i = 0, last_consumer = 0; i < m_nodes.size(); ++ i)
+        {
+                splits[i] = last_consumer <= i;
+                last_consumer = std::max(last_consumer, last_consumers[i]);
+        }
+
+        return splits;
+}
+
+std::vector<vector_t> model_t::nparams() const
+{
+        std::vector<vector_t> pdatas;
+        for (const auto& cnode : m_nodes)
+        {
+                pdatas.emplace_back(cnode.pdata(pbuffer(cnode)));
+        }
+        return pdatas;
+}
+
+void model_t::nparams(const std::vector<vector_t>& pdatas)
+{
+        assert(pdatas.size() == m_nodes.size());
+        for (size_t i = 0; i < m_nodes.size(); ++ i)
+        {
+                m_nodes[i].pdata(pbuffer(m_nodes[i])) = pdatas[i];
+        }
+        m_gdata.setZero();
+}
+
+tensor3d_dim_t model_t::prefix_odims() const
+{
+        assert(m_fprefix > 0);
+        return m_nodes[m_fprefix - 1].m_node->odims();
+}
+
+void model_t::checkpoints(const strings_t& names, const tensor_size_t budget)
+{
+        m_checkpoint_names = names;
+        m_checkpoint_budget = budget;
+        m_checkpoints.clear();
+        m_plan.clear();
+}
+
+bool model_t::resize_checkpoints()
+{
+        m_checkpoints.clear();
+        if (m_checkpoint_names.empty())
+        {
+                return true;
+        }
+
+        const auto splits = this->splits();
+
+        if (m_checkpoint_names == strings_t{"auto"})
+        {
+                // greedily fill segments of (per sample) size given by the budget,
+                //      by default the square root of the total output size times the largest output size
+                tensor_size_t total = 0, largest = 0;
+                for (const auto& cnode : m_nodes)
+                {
+                        total += nano::osize(cnode.m_node);
+                        largest = std::max(largest, nano::osize(cnode.m_node));
+                }
+
+                const auto budget = (m_checkpoint_budget > 0) ? m_checkpoint_budget :
+                        static_cast<tensor_size_t>(std::sqrt(static_cast<double>(total) * static_cast<double>(largest)));
+
+                tensor_size_t segment = 0;
+                for (size_t i = 0; i + 1 < m_nodes.size(); ++ i)
+                {
+                        if (splits[i] && segment >= budget)
+                        {
+                                m_checkpoints.push_back(i);
+                                segment = 0;
+                        }
+                        else
+                        {
+                                segment += nano::osize(m_nodes[i].m_node);
+                        }
+                }
+        }
+        else
+        {
+                for (const auto& name : m_checkpoint_names)
+                {
+                        const auto index = find_node(name);
+                        if (index == string_t::npos)
+                        {
+                                log_error() << "model: unknown checkpoint node [" << name << "]!";
+                                return false;
+                        }
+                        if (!splits[index])
+                        {
+                                log_error() << "model: checkpoint node [" << name << "] does not split the computation graph!";
+                                return false;
+                        }
+                        m_checkpoints.push_back(index);
+                }
+
+                std::sort(m_checkpoints.begin(), m_checkpoints.end());
+                m_checkpoints.erase(std::unique(m_checkpoints.begin(), m_checkpoints.end()), m_checkpoints.end());
+        }
+
+        // the output node and the output of the frozen prefix are always stored
+        if (m_checkpoints.empty() || *m_checkpoints.rbegin() + 1 != m_nodes.size())
+        {
+                m_checkpoints.push_back(m_nodes.size() - 1);
+        }
+        if (m_fprefix > 0 && !std::binary_search(m_checkpoints.begin(), m_checkpoints.end(), m_fprefix - 1))
+        {
+                m_checkpoints.insert(std::lower_bound(m_checkpoints.begin(), m_checkpoints.end(), m_fprefix - 1), m_fprefix - 1);
+        }
+
+        // report the recomputation overhead and the memory savings (per sample)
+        int64_t flops = 0;
+        for (size_t i = 0; m_checkpoints.size() > 1 && i < m_checkpoints[m_checkpoints.size() - 2]; ++ i)
+        {
+                if (!std::binary_search(m_checkpoints.begin(), m_checkpoints.end(), i))
+                {
+                        flops += m_nodes[i].m_node->flops_output();
+                }
+        }
+
+        std::vector<tensor_size_t> obegins;
+        const auto xsize = arrange(1, obegins);
+        const auto xsize_all = arrange(1, obegins, {});
+
+        log_info() << "model: gradient checkpointing at " << join(node_names(m_checkpoints))
+                << ": recomputing " << (flops / 1024) << " kflops/sample to store "
+                << xsize << " instead of " << xsize_all << " values/sample.";
+
+        if (m_checkpoint_names == strings_t{"auto"} && xsize >= xsize_all)
+        {
+                log_info() << "model: gradient checkpointing disabled as it does not save memory.";
+                m_checkpoints.clear();
+        }
+
+        return true;
+}
+
 bool model_t::resize(const tensor3d_dim_t& idims, const tensor3d_dim_t& odims)
 {
-        log_info() << "model: resizing the computation nodes [" << idims << "->" << odims << "]...";
+        log_info() << "model: resizing the computation nodes [" << idims << "->" << odims
+                << "] using the [" << to_string(m_layout) << "] tensor layout...";
 
         // resize computation nodes starting from the input
         for (auto& cnode : m_nodes)
         {
+                if (!cnode.m_node->layout(m_layout))
+                {
+                        log_error() << "model: node [" << cnode.m_name << "] does not support the ["
+                                << to_string(m_layout) << "] tensor layout!";
+                        return false;
+                }
+
                 tensor3d_dims_t cidims;
                 if (cnode.m_inodes.empty())
                 {
@@ -469,29 +1100,54 @@ bool model_t::resize(const tensor3d_dim_t& idims, const tensor3d_dim_t& odims)
         int64_t flops_ginput = 0;
         int64_t flops_gparam = 0;
 
+        tensor_size_t fsize = 0;
         for (const auto& cnode : m_nodes)
         {
-                psize += cnode.m_node->psize();
+                (cnode.m_frozen ? fsize : psize) += cnode.m_node->psize();
                 flops_output += cnode.m_node->flops_output();
                 flops_ginput += cnode.m_node->flops_ginput();
                 flops_gparam += cnode.m_node->flops_gparam();
         }
 
         m_pdata.resize(psize);
+        m_fdata.resize(fsize);
         m_gdata.resize(psize);
+        m_plan.clear();
+        m_micros.m_states.clear();
         m_probe_output = probe_t{"model", "model(output)", flops_output};
         m_probe_ginput = probe_t{"model", "model(ginput)", flops_ginput};
         m_probe_gparam = probe_t{"model", "model(gparam)", flops_gparam};
 
-        tensor_size_t pbegin = 0;
+        tensor_size_t pbegin = 0, fbegin = 0;
         for (auto& cnode : m_nodes)
         {
-                cnode.m_pbegin = pbegin;
-                pbegin += cnode.m_node->psize();
+                auto& begin = cnode.m_frozen ? fbegin : pbegin;
+                cnode.m_pbegin = begin;
+                begin += cnode.m_node->psize();
         }
         assert(pbegin == m_pdata.size());
+        assert(fbegin == m_fdata.size());
 
-        return true;
+        // the frozen prefix: the leading frozen nodes splitting the computation graph
+        //      (and such that the following nodes don't use the model's input)
+        const auto splits = this->splits();
+
+        m_fprefix = 0;
+        for (size_t i = 0; i + 1 < m_nodes.size() && m_nodes[i].m_frozen; ++ i)
+        {
+                const auto begin = m_nodes.begin() + static_cast<std::ptrdiff_t>(i + 1);
+                if (splits[i] && std::none_of(begin, m_nodes.end(), [] (const auto& cnode) { return cnode.m_inodes.empty(); }))
+                {
+                        m_fprefix = i + 1;
+                }
+        }
+
+        if (m_fprefix > 0)
+        {
+                log_info() << "model: frozen prefix ending with node [" << m_nodes[m_fprefix - 1].m_name << "].";
+        }
+
+        return resize_checkpoints();
 }
 
 strings_t model_t::node_names(const indices_t& indices) const
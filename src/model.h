@@ -1,7 +1,7 @@
 #pragma once
 
 #include "task.h"
-#include "cnode.h"
+#include "cplan.h"
 
 namespace nano
 {
@@ -76,6 +76,46 @@ namespace nano
                 ///
                 bool resize(const tensor3d_dim_t& idims, const tensor3d_dim_t& odims);
 
+                ///
+                /// \brief change the memory layout of the tensors passed between the computation nodes
+                ///     (to be followed by a call to ::resize).
+                ///
+                /// NB: the inputs and the outputs of the model are always given as (count, maps, rows, cols).
+                /// NB: the conversion between layouts takes place only at the model's input and output.
+                ///
+                void layout(const tensor_layout layout) { m_layout = layout; m_plan.clear(); }
+                tensor_layout layout() const { return m_layout; }
+
+                ///
+                /// \brief gradient checkpointing: keep only the outputs of the given nodes (and of the output node)
+                ///     after the forward pass and recompute the other outputs segment by segment in the backward pass
+                ///     (to be followed by a call to ::resize).
+                ///
+                /// NB: the checkpoints must split the computation graph (no connection can skip over them).
+                /// NB: {"auto"} places the checkpoints such that each recomputed segment stores about the given
+                ///     number of values per sample (by default the square root of the total times the largest output size).
+                /// NB: an empty list disables gradient checkpointing (the default).
+                ///
+                void checkpoints(const strings_t& names, const tensor_size_t budget = 0);
+                const strings_t& checkpoints() const { return m_checkpoint_names; }
+
+                ///
+                /// \brief replace the given (resized) dense affine node with a sparse affine node
+                ///     by keeping only the given fraction of its weights (the largest in magnitude).
+                ///
+                /// NB: the parameters of all the other nodes are preserved.
+                ///
+                bool prune(const string_t& name, const scalar_t density);
+
+                ///
+                /// \brief freeze (or unfreeze) the parameters of the given nodes:
+                ///     the frozen parameters are not optimized (nor returned by ::params or ::gparam).
+                ///
+                /// NB: the node JSON configuration can also set the "frozen" flag.
+                /// NB: the parameters of all nodes are preserved.
+                ///
+                bool freeze(const strings_t& names, const bool frozen = true);
+
                 ///
                 /// \brief serialize model to disk
                 ///
@@ -92,16 +132,85 @@ namespace nano
                 ///
                 void random();
 
+                ///
+                /// \brief size of the input-output buffers needed to process the given number of samples at once
+                ///
+                /// NB: the outputs consumed only by a mixing node are stored in the mixing node's output buffer:
+                ///     always for the first input of mix-plus, but for mix-tcat only when evaluating single samples
+                ///     (e.g. inference) with the nchw layout, so the training minibatches still copy the concatenated inputs.
+                ///
+                tensor_size_t xsize(const tensor_size_t count) const;
+
+                ///
+                /// \brief allocate the input-output buffers for processing up to the given number of samples at once
+                ///     (smaller batches reuse the same buffers with their own layout, compiled on first use)
+                ///
+                /// NB: growing the buffers invalidates the cached execution plans.
+                ///
+                void reserve(const tensor_size_t count);
+
                 ///
                 /// \brief compute the model's output given its input
                 ///
                 tensor4d_cmap_t output(const tensor4d_t& idata);
 
+                ///
+                /// \brief frozen prefix: the leading nodes with frozen parameters that split the computation graph.
+                ///     its output does not depend on the trainable parameters and thus it can be cached (e.g. when fine-tuning).
+                ///
+                /// NB: the outputs of the frozen prefix are given using the model's tensor layout.
+                /// NB: ::gparam can follow ::suffix_output to compute the gradient wrt the trainable parameters.
+                ///
+                size_t prefix_size() const { return m_fprefix; }
+                tensor3d_dim_t prefix_odims() const;
+                tensor4d_cmap_t prefix_output(const tensor4d_t& idata);
+                tensor4d_cmap_t suffix_output(const tensor4d_t& fdata);
+
                 ///
                 /// \brief compute the model's gradient wrt parameters given its output
                 ///
                 const vector_t& gparam(const tensor4d_t& odata);
 
+                ///
+                /// \brief pipeline-parallel execution: split the computation nodes into (at most) the given number
+                ///     of contiguous stages of similar computational cost.
+                ///
+                /// NB: returns the index of the first node of each stage followed by the number of nodes.
+                /// NB: the stages end with checkpoints (if any), as the backward pass recomputes the outputs by segment.
+                ///
+                indices_t stages(const size_t count) const;
+
+                ///
+                /// \brief pipeline-parallel execution: allocate the state of the given number of micro-batches in flight,
+                ///     a copy of the computation nodes (e.g. with their internal buffers) and of the input-output buffers.
+                ///
+                /// NB: the micro-batches share the parameters and the gradient buffer of the model,
+                ///     while the model's own input-output buffers are released (until used again).
+                /// NB: the micro-batches are not copied with the model and they are released by ::resize.
+                ///
+                void micros(const size_t count);
+                size_t micros() const { return m_micros.m_states.size(); }
+
+                ///
+                /// \brief pipeline-parallel execution: compute the output of the given micro-batch for the given stage,
+                ///     the range [begin, end) of computation nodes (see ::stages).
+                ///
+                /// NB: the input is used only by the first stage, but its number of samples is needed by all stages.
+                /// NB: the stages of a micro-batch must be processed in order,
+                ///     but different stages can process different micro-batches concurrently.
+                ///
+                tensor4d_cmap_t output(const size_t micro, const tensor4d_t& idata, const size_t begin, const size_t end);
+
+                ///
+                /// \brief pipeline-parallel execution: back-propagate the given micro-batch through the given stage
+                ///     and add the gradient wrt the parameters of the stage's nodes to the given vector.
+                ///
+                /// NB: the gradient wrt the output is used only by the last stage.
+                /// NB: the stages of a micro-batch must be processed in reverse order after its forward pass,
+                ///     but different stages can process different micro-batches concurrently.
+                ///
+                void gparam(const size_t micro, const tensor4d_t& odata, const size_t begin, const size_t end, vector_t& gdata);
+
                 ///
                 /// \brief retrieve timing information for all components
                 ///
@@ -125,15 +234,58 @@ namespace nano
                 ///
                 /// \brief returns the current parameters and their gradient
                 ///
+                /// NB: the parameters of the frozen nodes are not included.
+                ///
                 const vector_t& params() const { return m_pdata; }
 
         private:
 
-                void allocate(const tensor_size_t count);
-                tensor_size_t xsize(const tensor_size_t count) const;
+                ///
+                /// \brief pipeline-parallel execution: the state of a micro-batch in flight through the stages.
+                ///
+                struct micro_t
+                {
+                        explicit micro_t(const cnodes_t& nodes) : m_nodes(nodes) {}
+
+                        cnodes_t        m_nodes;        ///< copy of the computation nodes
+                        vector_t        m_xdata;        ///< input-output buffers
+                        tensor4d_t      m_odata;        ///< output buffer (if the output needs a layout conversion)
+                        cplan_t         m_plan;         ///< execution plans for the input-output buffers
+                };
+
+                ///
+                /// \brief the micro-batches in flight (not copied with the model, as the execution plans).
+                ///
+                struct micros_t
+                {
+                        micros_t() = default;
+                        micros_t(const micros_t&) {}
+                        micros_t(micros_t&&) = default;
+                        micros_t& operator=(micros_t&&) = default;
+                        micros_t& operator=(const micros_t&) = delete;
+
+                        std::vector<micro_t>    m_states;
+                };
+
+                const cplan_t::csteps_t& plan(const tensor_size_t count);
+                const cplan_t::csteps_t& plan(cnodes_t&, vector_t& xdata, cplan_t&, const tensor_size_t count);
+                void reserve(vector_t& xdata, cplan_t&, const tensor_size_t count) const;
+                tensor_size_t arrange(const tensor_size_t count, std::vector<tensor_size_t>& obegins) const;
+                tensor_size_t arrange(const tensor_size_t count, std::vector<tensor_size_t>& obegins, const indices_t& checkpoints) const;
+                void forward(cnodes_t&, const cplan_t::csteps_t& steps, const size_t begin, const size_t end);
+                void backward(cnodes_t&, const cplan_t::csteps_t& steps, const size_t begin, const size_t end);
+                void backprop(cnodes_t&, const cplan_t::csteps_t& steps, const size_t begin, const size_t end);
+                tensor4d_cmap_t odata(const cplan_t::csteps_t& steps, tensor4d_t& obuffer, const tensor_size_t count);
+
+                std::vector<bool> splits() const;
+                std::vector<vector_t> nparams() const;
+                void nparams(const std::vector<vector_t>&);
+
+                const vector_t& pbuffer(const cnode_t& cnode) const { return cnode.m_frozen ? m_fdata : m_pdata; }
+                vector_t& pbuffer(const cnode_t& cnode) { return cnode.m_frozen ? m_fdata : m_pdata; }
+                bool resize_checkpoints();
 
                 const vector_t& cxdata() { return m_xdata; }
-                const vector_t& cpdata() { return m_pdata; }
                 const vector_t& cgdata() { return m_gdata; }
 
                 strings_t node_names(const indices_t& indices) const;
@@ -144,10 +296,19 @@ namespace nano
                 // attributes
                 tensor3d_dim_t  m_idims{{0, 0, 0}};     ///< input dimensions
                 tensor3d_dim_t  m_odims{{0, 0, 0}};     ///< output dimensions
+                tensor_layout   m_layout{tensor_layout::nchw}; ///< memory layout of the inner tensors
                 cnodes_t        m_nodes;                ///< computation nodes
                 vector_t        m_pdata;                ///< current parameters
+                vector_t        m_fdata;                ///< current parameters of the frozen nodes
+                size_t          m_fprefix{0};           ///< number of nodes in the frozen prefix
                 vector_t        m_gdata;                ///< current gradient wrt parameters
                 vector_t        m_xdata;                ///< current input-output buffers
+                strings_t       m_checkpoint_names;     ///< gradient checkpointing: nodes to keep the outputs of (or "auto")
+                tensor_size_t   m_checkpoint_budget{0}; ///< gradient checkpointing: size of a recomputed segment (per sample)
+                indices_t       m_checkpoints;          ///< gradient checkpointing: stored nodes (if enabled)
+                cplan_t         m_plan;                 ///< execution plans for the current input-output buffers
+                tensor4d_t      m_odata;                ///< output buffer (if the output needs a layout conversion)
+                micros_t        m_micros;               ///< pipeline-parallel execution: micro-batches in flight
                 probe_t         m_probe_output;
                 probe_t         m_probe_ginput;
                 probe_t         m_probe_gparam;
@@ -7,8 +7,11 @@
 #include "tasks/task_affine.h"
 #include "tasks/task_peak2d.h"
 #include "tasks/task_parity.h"
+#include "tasks/task_stream.h"
 #include "core/table.h"
+#include "core/tpool.h"
 #include <mutex>
+#include <algorithm>
 #include <iostream>
 
 using namespace nano;
@@ -30,17 +33,30 @@ task_factory_t& nano::get_tasks()
                 manager.add<parity_task_t>("synth-parity", "synthetic: predict the parity bit");
                 manager.add<affine_task_t>("synth-affine", "synthetic: predict random noisy affine transformations");
                 manager.add<peak2d_task_t>("synth-peak2d", "synthetic: predict random peaks in noisy images");
+                manager.add<stream_task_t>("stream", "out-of-core task streamed from a binary file (see convert_task)");
         });
 
         return manager;
 }
 
-template <typename tvalues>
-static size_t count_duplicates(const tvalues& values)
+using hashes_t = std::vector<size_t>;
+
+static const protocol protocols[] = {protocol::train, protocol::valid, protocol::test};
+
+static size_t count_duplicates(const hashes_t& train, const hashes_t& valid, const hashes_t& test)
 {
+        hashes_t hashes;
+        hashes.reserve(train.size() + valid.size() + test.size());
+        hashes.insert(hashes.end(), train.begin(), train.end());
+        hashes.insert(hashes.end(), valid.begin(), valid.end());
+        std::inplace_merge(hashes.begin(), hashes.begin() + static_cast<std::ptrdiff_t>(train.size()), hashes.end());
+        const auto middle = hashes.size();
+        hashes.insert(hashes.end(), test.begin(), test.end());
+        std::inplace_merge(hashes.begin(), hashes.begin() + static_cast<std::ptrdiff_t>(middle), hashes.end());
+
         size_t count = 0;
-        auto it = values.begin();
-        while ((it = std::adjacent_find(it, values.end())) != values.end())
+        auto it = hashes.begin();
+        while ((it = std::adjacent_find(it, hashes.end())) != hashes.end())
         {
                 ++ count;
                 ++ it;
@@ -48,37 +64,108 @@ static size_t count_duplicates(const tvalues& values)
         return count;
 }
 
-template <typename tvalues>
-static size_t count_intersects(const tvalues& values1, const tvalues& values2)
+static size_t count_intersects(const hashes_t& hashes1, const hashes_t& hashes2)
 {
-        tvalues intersection;
-        std::set_intersection(
-                values1.begin(), values1.end(), values2.begin(), values2.end(),
-                std::back_inserter(intersection));
-        return intersection.size();
+        // NB: same as std::set_intersection, but without storing the intersection
+        size_t count = 0;
+        for (auto it1 = hashes1.begin(), it2 = hashes2.begin(); it1 != hashes1.end() && it2 != hashes2.end(); )
+        {
+                if (*it1 < *it2)
+                {
+                        ++ it1;
+                }
+                else if (*it2 < *it1)
+                {
+                        ++ it2;
+                }
+                else
+                {
+                        ++ count, ++ it1, ++ it2;
+                }
+        }
+        return count;
 }
 
-template <typename thashes>
-static void add_hashes(const task_t& task, const fold_t& fold, thashes& hashes)
+static size_t count_intersects(const hashes_t& train, const hashes_t& valid, const hashes_t& test)
 {
-        const auto size = task.size(fold);
-        for (size_t i = 0; i < size; ++ i)
+        return  std::max(std::max(
+                count_intersects(train, valid),
+                count_intersects(valid, test)),
+                count_intersects(test, train));
+}
+
+///
+/// \brief retrieve the sorted input hashes of the [fbegin, fend) folds (indexed by fold and then by protocol)
+///
+static std::vector<hashes_t> sorted_hashes(const task_t& task, const size_t fbegin, const size_t fend)
+{
+        std::vector<hashes_t> hashes((fend - fbegin) * 3);
+        loopi(hashes.size(), size_t(1), [&] (const size_t begin, const size_t end)
         {
-                hashes.push_back(task.ihash(fold, i));
-        }
+                for (auto i = begin; i < end; ++ i)
+                {
+                        const auto fold = fold_t{fbegin + i / 3, protocols[i % 3]};
+
+                        auto& fhashes = hashes[i];
+                        fhashes.resize(task.size(fold));
+                        for (size_t s = 0; s < fhashes.size(); ++ s)
+                        {
+                                fhashes[s] = task.ihash(fold, s);
+                        }
+                        std::sort(fhashes.begin(), fhashes.end());
+                }
+        });
+        return hashes;
 }
 
-void task_t::describe(const string_t& name) const
+///
+/// \brief compute the maximum over the [fbegin, fend) folds of the given count (e.g. duplicates, intersections)
+///
+template <typename toperator>
+static size_t max_count(const task_t& task, const size_t fbegin, const size_t fend, const toperator& op)
 {
-        const auto glcounts = labels();
+        const auto hashes = sorted_hashes(task, fbegin, fend);
 
+        std::vector<size_t> counts(fend - fbegin, 0);
+        loopi(counts.size(), size_t(1), [&] (const size_t begin, const size_t end)
+        {
+                for (auto f = begin; f < end; ++ f)
+                {
+                        counts[f] = op(hashes[3 * f + 0], hashes[3 * f + 1], hashes[3 * f + 2]);
+                }
+        });
+
+        return counts.empty() ? size_t(0) : *std::max_element(counts.begin(), counts.end());
+}
+
+///
+/// \brief count the samples of each label for all folds (indexed by fold and then by protocol)
+///
+static std::vector<std::map<string_t, size_t>> count_labels(const task_t& task)
+{
+        std::vector<std::map<string_t, size_t>> counts(task.fsize() * 3);
+        loopi(counts.size(), size_t(1), [&] (const size_t begin, const size_t end)
+        {
+                for (auto i = begin; i < end; ++ i)
+                {
+                        counts[i] = task.labels(fold_t{i / 3, protocols[i % 3]});
+                }
+        });
+        return counts;
+}
+
+void task_t::describe(const string_t& name) const
+{
         std::map<fold_t, std::map<string_t, size_t>> flcounts;
-        for (size_t f = 0; f < fsize(); ++ f)
+        std::map<string_t, size_t> glcounts;
+
+        const auto counts = count_labels(*this);
+        for (size_t i = 0; i < counts.size(); ++ i)
         {
-                for (const auto p : {protocol::train, protocol::valid, protocol::test})
+                flcounts[fold_t{i / 3, protocols[i % 3]}] = counts[i];
+                for (const auto& count : counts[i])
                 {
-                        const auto fold = fold_t{f, p};
-                        flcounts[fold] = labels(fold);
+                        glcounts[count.first] += count.second;
                 }
         }
 
@@ -153,52 +240,29 @@ void task_t::describe(const string_t& name) const
 size_t task_t::duplicates(const size_t f) const
 {
         assert(f < fsize());
-
-        std::vector<size_t> hashes;
-
-        add_hashes(*this, fold_t{f, protocol::train}, hashes);
-        add_hashes(*this, fold_t{f, protocol::valid}, hashes);
-        add_hashes(*this, fold_t{f, protocol::test}, hashes);
-
-        return count_duplicates(hashes);
+        return max_count(*this, f, f + 1, count_duplicates);
 }
 
 size_t task_t::duplicates() const
 {
-        size_t max_duplicates = 0;
-        for (size_t f = 0; f < fsize(); ++ f)
-        {
-                max_duplicates = std::max(max_duplicates, duplicates(f));
-        }
-        return max_duplicates;
+        return max_count(*this, 0, fsize(), count_duplicates);
 }
 
 size_t task_t::intersections(const size_t f) const
 {
         assert(f < fsize());
-
-        std::vector<size_t> train_hashes;
-        std::vector<size_t> valid_hashes;
-        std::vector<size_t> test_hashes;
-
-        add_hashes(*this, fold_t{f, protocol::train}, train_hashes);
-        add_hashes(*this, fold_t{f, protocol::valid}, valid_hashes);
-        add_hashes(*this, fold_t{f, protocol::test}, test_hashes);
-
-        return  std::max(std::max(
-                count_intersects(train_hashes, valid_hashes),
-                count_intersects(valid_hashes, test_hashes)),
-                count_intersects(test_hashes, train_hashes));
+        return max_count(*this, f, f + 1, [] (const auto& train, const auto& valid, const auto& test)
+        {
+                return count_intersects(train, valid, test);
+        });
 }
 
 size_t task_t::intersections() const
 {
-        size_t max_duplicates = 0;
-        for (size_t f = 0; f < fsize(); ++ f)
+        return max_count(*this, 0, fsize(), [] (const auto& train, const auto& valid, const auto& test)
         {
-                max_duplicates = std::max(max_duplicates, intersections(f));
-        }
-        return max_duplicates;
+                return count_intersects(train, valid, test);
+        });
 }
 
 std::map<string_t, size_t> task_t::labels(const fold_t& fold) const
@@ -215,15 +279,11 @@ std::map<string_t, size_t> task_t::labels(const fold_t& fold) const
 std::map<string_t, size_t> task_t::labels() const
 {
         std::map<string_t, size_t> labels;
-        for (size_t f = 0; f < fsize(); ++ f)
+        for (const auto& counts : count_labels(*this))
         {
-                for (const auto p : {protocol::train, protocol::valid, protocol::test})
+                for (const auto& count : counts)
                 {
-                        const auto fold = fold_t{f, p};
-                        for (size_t i = 0, size = this->size(fold); i < size; ++ i)
-                        {
-                                labels[label(fold, i)] ++;
-                        }
+                        labels[count.first] += count.second;
                 }
         }
 
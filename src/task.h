@@ -62,6 +62,12 @@ namespace nano
                 ///
                 virtual minibatch_t get(const fold_t&, const size_t begin, const size_t end) const = 0;
 
+                ///
+                /// \brief check if the inputs of the given fold are randomly transformed each time they are retrieved
+                ///     (e.g. augmentation), so that they should not be cached
+                ///
+                virtual bool augmented(const fold_t&) const { return false; }
+
                 ///
                 /// \brief retrieve the hash for a given input/target
                 ///
@@ -80,6 +86,7 @@ namespace nano
 
                 ///
                 /// \brief returns the number of duplicated samples globally or for the given fold index
+                ///     NB: the input hashes are collected, sorted and compared in parallel for all folds
                 ///
                 size_t duplicates() const;
                 size_t duplicates(const size_t fold_index) const;
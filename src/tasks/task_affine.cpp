@@ -4,60 +4,39 @@
 using namespace nano;
 
 affine_task_t::affine_task_t() :
-        mem_tensor_task_t(make_dims(32, 1, 1), make_dims(32, 1, 1), 10)
+        synth_task_t(make_dims(32, 1, 1), make_dims(32, 1, 1), 1024, 10)
 {
 }
 
 void affine_task_t::from_json(const json_t& json)
 {
-        nano::from_json(json, "isize", m_isize, "osize", m_osize, "noise", m_noise, "count", m_count, "folds", m_folds);
-        reconfig(make_dims(m_isize, 1, 1), make_dims(m_osize, 1, 1), m_folds);
+        auto seed = make_seed();
+        nano::from_json(json, "isize", m_isize, "osize", m_osize, "noise", m_noise, "count", m_count, "folds", m_folds,
+                "seed", seed);
+        reconfig(make_dims(m_isize, 1, 1), make_dims(m_osize, 1, 1), m_count, m_folds, seed);
 }
 
 void affine_task_t::to_json(json_t& json) const
 {
-        nano::to_json(json, "isize", m_isize, "osize", m_osize, "noise", m_noise, "count", m_count, "folds", m_folds);
+        nano::to_json(json, "isize", m_isize, "osize", m_osize, "noise", m_noise, "count", m_count, "folds", m_folds,
+                "seed", seed());
 }
 
-bool affine_task_t::populate()
+void affine_task_t::setup(counter_rng_t& rng)
 {
-        auto rng = make_rng();
-        auto udist_noise = make_udist<scalar_t>(-m_noise, +m_noise);
+        m_weights.resize(m_osize, m_isize);
+        m_bias.resize(m_osize);
 
-        tensor2d_t weights(m_osize, m_isize);
-        tensor1d_t bias(m_osize);
-        tensor3d_t input(m_isize, 1, 1);
-        tensor3d_t target(m_osize, 1, 1);
-
-        weights.random();
-        bias.random();
-
-        // generate samples
-        reserve_chunks(m_count);
-        for (size_t i = 0; i < m_count; ++ i)
-        {
-                input.random();
-
-                const auto hash = i;
-                add_chunk(input, hash);
-        }
-
-        // generate folds
-        for (size_t f = 0; f < m_folds; ++ f)
-        {
-                const auto protocols = split3(m_count, protocol::train, 40, protocol::valid, 30, protocol::test);
-
-                for (size_t i = 0; i < m_count; ++ i)
-                {
-                        target.vector() = weights.matrix() * input.vector() + bias.vector();
-                        add_random(udist_noise, rng, target);
+        urand<scalar_t>(-1, +1, m_weights.data(), m_weights.data() + m_weights.size(), rng);
+        urand<scalar_t>(-1, +1, m_bias.data(), m_bias.data() + m_bias.size(), rng);
+}
 
-                        const auto label = string_t();
-                        const auto fold = fold_t{f, protocols[i]};
+string_t affine_task_t::generate(counter_rng_t& irng, counter_rng_t& trng, tensor3d_map_t input, tensor3d_map_t target) const
+{
+        urand<scalar_t>(-1, +1, input.data(), input.data() + input.size(), irng);
 
-                        add_sample(fold, i, target, label);
-                }
-        }
+        target.vector() = m_weights.matrix() * input.vector() + m_bias.vector();
+        add_random(make_udist<scalar_t>(-m_noise, +m_noise), trng, target);
 
-        return true;
+        return string_t();
 }
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "task_mem_tensor.h"
+#include "task_synth.h"
 
 namespace nano
 {
@@ -15,23 +15,28 @@ namespace nano
         ///     osize   - output dimensions
         ///     noise   - additive noise sampled uniformly from [-noise,+noise]
         ///     count   - number of samples (training + validation + test)
+        ///     seed    - seed of the random number generators (random if not given, the same seed generates the same samples)
         ///
-        class affine_task_t final : public mem_tensor_task_t
+        class affine_task_t final : public synth_task_t
         {
         public:
 
                 affine_task_t();
-                bool populate() override;
                 void to_json(json_t&) const final;
                 void from_json(const json_t&) final;
 
         private:
 
+                void setup(counter_rng_t&) final;
+                string_t generate(counter_rng_t&, counter_rng_t&, tensor3d_map_t, tensor3d_map_t) const final;
+
                 // attributes
                 tensor_size_t           m_isize{32};
                 tensor_size_t           m_osize{32};
                 size_t                  m_folds{10};
                 size_t                  m_count{1024};
                 scalar_t                m_noise{static_cast<scalar_t>(1e-3)};
+                tensor2d_t              m_weights;      ///< A
+                tensor1d_t              m_bias;         ///< b
         };
 }
@@ -0,0 +1,77 @@
+#include "task_augment.h"
+#include "core/random.h"
+#include "core/numeric.h"
+
+using namespace nano;
+
+void augment_t::from_json(const json_t& json)
+{
+        nano::from_json(json, "crop", m_crop, "flip", m_flip, "jitter", m_jitter);
+
+        m_crop = std::max(m_crop, coord_t(0));
+        m_flip = std::min(m_flip, size_t(1));
+        m_jitter = clamp(m_jitter, scalar_t(0), scalar_t(1));
+}
+
+void augment_t::to_json(json_t& json) const
+{
+        nano::to_json(json, "crop", m_crop, "flip", m_flip, "jitter", m_jitter);
+}
+
+void augment_t::erase(json_t& json)
+{
+        for (const auto* key : {"crop", "flip", "jitter"})
+        {
+                json.erase(key);
+        }
+}
+
+void augment_t::operator()(const image_t& image, const rect_t& region, tensor3d_map_t idata) const
+{
+        static thread_local auto rng = make_rng();
+
+        const auto rect = region.empty() ? rect_t(0, 0, image.cols(), image.rows()) : region;
+        assert(idata.dims() == make_dims(image.dims(), rect.height(), rect.width()));
+
+        // translate the region, the pixels outside the image are black (shifted by the brightness jitter)
+        const auto dx = (m_crop > 0) ? urand<coord_t>(-m_crop, +m_crop, rng) : coord_t(0);
+        const auto dy = (m_crop > 0) ? urand<coord_t>(-m_crop, +m_crop, rng) : coord_t(0);
+        const auto flip = (m_flip > 0) && urand<int>(0, 1, rng) > 0;
+
+        const auto moved = rect_t(rect.left() + dx, rect.top() + dy, rect.width(), rect.height());
+        const auto valid = moved & rect_t(0, 0, image.cols(), image.rows());
+
+        // position of the valid pixels in the input tensor
+        const auto top = valid.top() - moved.top();
+        const auto left = flip ?
+                moved.right() - valid.right() :
+                valid.left() - moved.left();
+
+        for (coord_t b = 0; b < image.dims(); ++ b)
+        {
+                const auto contrast = (m_jitter > 0) ? urand<scalar_t>(1 - m_jitter, 1 + m_jitter, rng) : scalar_t(1);
+                const auto brightness = (m_jitter > 0) ? urand<scalar_t>(-m_jitter, +m_jitter, rng) : scalar_t(0);
+                const auto scale = contrast / scalar_t(255);
+
+                auto omatrix = idata.matrix(b);
+                if (valid.area() != rect.area())
+                {
+                        omatrix.setConstant(clamp(brightness, scalar_t(0), scalar_t(1)));
+                }
+                if (valid.empty())
+                {
+                        continue;
+                }
+
+                const auto iplane = image.plane(b, valid).cast<scalar_t>().array();
+                auto oblock = omatrix.block(top, left, valid.height(), valid.width()).array();
+                if (flip)
+                {
+                        oblock = (iplane.rowwise().reverse() * scale + brightness).max(scalar_t(0)).min(scalar_t(1));
+                }
+                else
+                {
+                        oblock = (iplane * scale + brightness).max(scalar_t(0)).min(scalar_t(1));
+                }
+        }
+}
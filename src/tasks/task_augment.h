@@ -0,0 +1,53 @@
+#pragma once
+
+#include "core/json.h"
+#include "core/image.h"
+
+namespace nano
+{
+        ///
+        /// \brief on-the-fly augmentation of the images of the vision tasks:
+        ///     the samples of the training folds are randomly transformed each time a minibatch is built,
+        ///     so that the augmented samples are never stored.
+        ///
+        /// parameters:
+        ///     crop            - maximum translation in pixels (aka random crops of the padded image)
+        ///     flip            - flip horizontally half of the images (0 or 1)
+        ///     jitter          - maximum relative change of the contrast and of the brightness of each color channel
+        ///
+        /// NB: the pixels translated from outside the image are black, shifted by the brightness jitter (if any)
+        ///     and clamped to [0, 1] like the other pixels.
+        /// NB: the transformations are applied while scaling the 8-bit image planes to the input tensor (without copies),
+        ///     using a random number generator per thread (as the minibatches are built concurrently).
+        ///
+        class NANO_PUBLIC augment_t
+        {
+        public:
+
+                void to_json(json_t&) const;
+                void from_json(const json_t&);
+
+                ///
+                /// \brief remove the augmentation parameters from the given JSON configuration
+                ///
+                static void erase(json_t&);
+
+                ///
+                /// \brief check if any transformation is enabled
+                ///
+                bool enabled() const { return m_crop > 0 || m_flip > 0 || m_jitter > 0; }
+
+                ///
+                /// \brief write the randomly transformed region of the given image (or the whole image if empty)
+                ///     to the given [0, 1] tensor
+                ///
+                void operator()(const image_t&, const rect_t& region, tensor3d_map_t idata) const;
+
+        private:
+
+                // attributes
+                coord_t         m_crop{0};      ///< maximum translation in pixels
+                size_t          m_flip{0};      ///< flip horizontally
+                scalar_t        m_jitter{0};    ///< maximum relative change of the contrast and of the brightness
+        };
+}
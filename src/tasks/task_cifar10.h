@@ -19,6 +19,7 @@ namespace nano
 
                 cifar10_task_t();
                 bool populate() override;
+                strings_t sources() const override;
                 void to_json(json_t&) const final;
                 void from_json(const json_t&) final;
 
@@ -117,12 +117,19 @@ cifar100_task_t::cifar100_task_t() :
 void cifar100_task_t::from_json(const json_t& json)
 {
         nano::from_json(json, "dir", m_dir, "folds", m_folds);
+        augment().from_json(json);
         reconfig(make_dims(3, 32, 32), make_dims(100, 1, 1), m_folds);
 }
 
 void cifar100_task_t::to_json(json_t& json) const
 {
         nano::to_json(json, "dir", m_dir, "folds", m_folds);
+        augment().to_json(json);
+}
+
+strings_t cifar100_task_t::sources() const
+{
+        return {m_dir + "/cifar-100-binary.tar.gz"};
 }
 
 bool cifar100_task_t::populate()
@@ -157,6 +164,7 @@ bool cifar100_task_t::populate()
 
         log_info() << "CIFAR-100: loading file <" << bfile << "> ...";
 
+        reserve_chunks(n_train_samples + n_test_samples);
         return nano::load_archive(bfile, op, error_op);
 }
 
@@ -169,38 +177,37 @@ bool cifar100_task_t::load_binary(const string_t& filename, istream_t& stream, c
 
         const auto irows = std::get<1>(idims());
         const auto icols = std::get<2>(idims());
-        const auto buffer_size = irows * icols * 3;
+        const auto record_size = 2 + irows * icols * 3;
 
-        std::vector<char> buffer(static_cast<size_t>(buffer_size));
-        char label[2];
+        // generate samples (decode the images in parallel)
+        alloc_chunks(count);
 
-        // generate samples
-        std::vector<tensor_size_t> ilabels;
-        while ( stream.read(label, 2) == 2 &&       // coarse & fine labels!
-                stream.read(buffer.data(), buffer_size) == buffer_size &&
-                n_chunks() < chunk_begin + count)
+        std::vector<tensor_size_t> ilabels(count);
+        const auto op = [&] (const char* record, const size_t i)
         {
-                const tensor_size_t ilabel = label[1];
+                const tensor_size_t ilabel = record[1];         // coarse & fine labels!
                 if (ilabel < 0 || ilabel >= nano::size(odims()))
                 {
-                        log_error() << "CIFAR-100: invalid label!";
                         return false;
                 }
 
                 image_t image;
-                image.load_rgb(buffer.data(), irows, icols, irows * icols);
-                add_chunk(image, image.hash());
+                image.load_rgb(record + 2, irows, icols, irows * icols);
+                const auto hash = image.hash();
+                set_chunk(chunk_begin + i, std::move(image), hash);
 
-                ilabels.push_back(ilabel);
-        }
-        if (ilabels.size() != count)
+                ilabels[i] = ilabel;
+                return true;
+        };
+
+        if (!load_chunks(stream, count, record_size, op))
         {
-                log_error() << "CIFAR-100: invalid number of samples!";
+                log_error() << "CIFAR-100: invalid label or number of samples!";
                 return false;
         }
 
         // generate folds
-        add_samples(p, ilabels, tlabels);
+        add_samples(p, chunk_begin, ilabels, tlabels);
 
         // OK
         log_info() << "CIFAR-100: loaded " << (n_chunks() - chunk_begin) << " samples.";
@@ -1,7 +1,20 @@
 #pragma once
 
+#include <atomic>
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "task.h"
+#include "core/hash.h"
+#include "core/tpool.h"
+#include "core/istream.h"
 #include "core/random.h"
+#include "core/logger.h"
+#include "core/obstream.h"
+#include "core/mmap_ibstream.h"
 
 namespace nano
 {
@@ -11,12 +24,23 @@ namespace nano
         /// tchunk is a data piece (e.g. image, tensor)
         ///
         /// tsample is a sample associated to a chunk (e.g. can map to the whole or a part of the chunk):
+        ///     (index, target, label, ...)     - constructor (the target and the label are given by their ids)
         ///     ::index()                       - index of the associated chunk
-        ///     ::input(const tchunk&)          - input 3D tensor
+        ///     ::target()                      - id of the associated output/target 3D tensor
+        ///     ::label()                       - id of the associated label (if any)
+        ///     ::input(const tchunk&, map)     - write the input 3D tensor in place (e.g. into the minibatch)
         ///     ::ihash(size_t chunk_hash)      - hash of the input tensor given the hash of the associated chunk
-        ///     ::output()                      - output/target 3D tensor
-        ///     ::ohash()                       - hash of the output tensor
-        ///     ::label()                       - associated label (if any)
+        ///     ::operator==                    - check if two samples are the same
+        ///     ::write(obstream_t&)            - serialize the sample
+        ///     ::read(mmap_ibstream_t&)        - deserialize the sample
+        ///
+        /// NB: the distinct targets, labels and samples are stored only once and referenced by id,
+        ///     while the folds are arrays of sample ids (as the same samples are typically used in all folds).
+        /// NB: the ids are stored on 32 bits, so the loading fails if there are more distinct entities.
+        ///
+        /// NB: the tasks loaded from files (see ::sources) are cached as a binary snapshot next to the first file
+        ///     (chunks, hashes and folds), so that the next loads map the snapshot instead of decoding the files.
+        /// NB: the snapshot is keyed by the configuration and the size and the modification time of the files.
         ///
         template <typename tchunk, typename tsample>
         class mem_task_t : public task_t
@@ -40,6 +64,11 @@ namespace nano
                 void shuffle(const fold_t&) const final;
                 minibatch_t get(const fold_t&, const size_t begin, const size_t end) const final;
 
+                ///
+                /// \brief enable or disable caching the loaded task as a binary snapshot
+                ///
+                void cache(const bool enable) { m_cache = enable; }
+
         protected:
 
                 void reconfig(const tensor3d_dim_t& idims, const tensor3d_dim_t& odims, const size_t fsize)
@@ -48,8 +77,7 @@ namespace nano
                         m_odims = odims;
                         m_fsize = fsize;
 
-                        m_chunks.clear();
-                        m_samples.clear();
+                        clear();
                 }
 
                 void reserve_chunks(const size_t count)
@@ -64,18 +92,86 @@ namespace nano
                         m_hashes.push_back(hash);
                 }
 
-                template <typename... t>
-                void add_sample(const fold_t& fold, t&&... ts)
+                ///
+                /// \brief allocate the given number of chunks to be set later (e.g. concurrently) with ::set_chunk
+                /// \return the index of the first allocated chunk
+                ///
+                size_t alloc_chunks(const size_t count)
+                {
+                        const auto begin = n_chunks();
+                        m_chunks.resize(begin + count);
+                        m_hashes.resize(begin + count);
+                        return begin;
+                }
+
+                void set_chunk(const size_t index, tchunk&& chunk, const size_t hash)
+                {
+                        assert(index < n_chunks());
+                        m_chunks[index] = std::move(chunk);
+                        m_hashes[index] = hash;
+                }
+
+                ///
+                /// \brief decode the given number of fixed-size records from the stream:
+                ///     the records are read by blocks and decoded on the thread pool using op(record, index),
+                ///     where the index (in the [0, count) range) is typically used to set the allocated chunks.
+                ///
+                template <typename toperator>
+                static bool load_chunks(istream_t& stream, const size_t count, const tensor_size_t record_size,
+                        const toperator& op)
+                {
+                        const size_t block_size = 1024;
+
+                        std::vector<char> buffer(block_size * static_cast<size_t>(record_size));
+                        for (size_t begin = 0; begin < count; begin += block_size)
+                        {
+                                const auto size = std::min(block_size, count - begin);
+                                const auto bytes = static_cast<std::streamsize>(size) * record_size;
+                                if (stream.read(buffer.data(), bytes) != bytes)
+                                {
+                                        return false;
+                                }
+
+                                std::atomic<bool> ok{true};
+                                loopi(size, size_t(64), [&] (const size_t ibegin, const size_t iend)
+                                {
+                                        for (auto i = ibegin; i < iend; ++ i)
+                                        {
+                                                if (!op(buffer.data() + i * static_cast<size_t>(record_size), begin + i))
+                                                {
+                                                        ok = false;
+                                                }
+                                        }
+                                });
+
+                                if (!ok)
+                                {
+                                        return false;
+                                }
+                        }
+
+                        return true;
+                }
+
+                template <typename ttarget, typename... t>
+                void add_sample(const fold_t& fold, const size_t ichunk, const ttarget& target, const string_t& label, t&&... ts)
                 {
                         assert(fold.m_index < fsize());
-                        m_samples[fold].emplace_back(ts...);
+                        assert(ichunk < n_chunks());
+                        const auto sample = tsample(ichunk, target_id(target), label_id(label), std::forward<t>(ts)...);
+                        m_fsamples[fold].push_back(sample_id(sample));
                 }
 
                 void add_samples(const protocol p, const std::vector<tensor_size_t>& ilabels, const strings_t& tlabels)
                 {
                         assert(n_chunks() >= ilabels.size());
+                        add_samples(p, n_chunks() - ilabels.size(), ilabels, tlabels);
+                }
 
-                        const auto chunk_begin = n_chunks() - ilabels.size();
+                void add_samples(const protocol p, const size_t chunk_begin,
+                        const std::vector<tensor_size_t>& ilabels, const strings_t& tlabels)
+                {
+                        assert(chunk_begin + ilabels.size() <= n_chunks());
 
                         for (size_t f = 0; f < fsize(); ++ f)
                         {
@@ -98,7 +194,34 @@ namespace nano
 
                 virtual bool populate() = 0;
 
+                ///
+                /// \brief files the task is loaded from (if any)
+                ///
+                virtual strings_t sources() const { return strings_t(); }
+
+                ///
+                /// \brief configuration the binary snapshot is keyed by (see ::sources)
+                ///
+                virtual json_t snapshot_config() const
+                {
+                        json_t json;
+                        to_json(json);
+                        return json;
+                }
+
+                ///
+                /// \brief write the input of the given sample in place when building the minibatches
+                ///     (e.g. to transform the samples of the training folds on the fly)
+                ///
+                virtual void input(const fold_t&, const tsample& sample, const tchunk& chunk, tensor3d_map_t idata) const
+                {
+                        sample.input(chunk, idata);
+                }
+
                 size_t n_chunks() const { return m_chunks.size(); }
+                size_t n_targets() const { return m_thashes.size(); }
+                size_t n_labels() const { return m_labels.size(); }
+                size_t n_samples() const { return m_samples.size(); }
                 const tchunk& chunk(const size_t index) const
                 {
                         assert(index < n_chunks());
@@ -107,14 +230,48 @@ namespace nano
 
         private:
 
-                using tsamples = std::map<fold_t, std::vector<tsample>>;
+                using tids = std::vector<uint32_t>;
+                using tfolds = std::map<fold_t, tids>;
+                using tid_map = std::unordered_multimap<size_t, uint32_t>;
+
+                void clear();
 
-                const tsample& get_sample(const fold_t& fold, const size_t sample_index) const
+                ///
+                /// \brief id of a new interned entity (e.g. target, label, sample) given the number of the existing ones
+                /// NB: throws std::length_error if the id cannot be represented on 32 bits.
+                ///
+                static uint32_t next_id(const size_t count, const char* what);
+
+                template <typename ttarget>
+                uint32_t target_id(const ttarget& target);
+                uint32_t label_id(const string_t& label);
+                uint32_t sample_id(const tsample& sample);
+
+                string_t snapshot_path() const;
+                bool load_snapshot(const string_t& path);
+                bool save_snapshot(const string_t& path) const;
+                bool write_snapshot(obstream_t&) const;
+
+                const tsample& get_sample(const fold_t& fold, const size_t index) const
                 {
-                        const auto it = m_samples.find(fold);
-                        assert(it != m_samples.end());
-                        assert(sample_index < it->second.size());
-                        return it->second[sample_index];
+                        const auto it = m_fsamples.find(fold);
+                        assert(it != m_fsamples.end());
+                        assert(index < it->second.size());
+                        assert(it->second[index] < m_samples.size());
+                        return m_samples[it->second[index]];
+                }
+
+                auto get_target(const tsample& sample) const
+                {
+                        const auto osize = nano::size(m_odims);
+                        assert(sample.target() < m_thashes.size());
+                        return map_tensor(m_targets.data() + sample.target() * osize, m_odims);
+                }
+
+                const string_t& get_label(const tsample& sample) const
+                {
+                        assert(sample.label() < m_labels.size());
+                        return m_labels[sample.label()];
                 }
 
                 const tchunk& get_chunk(const tsample& sample) const
@@ -139,7 +296,15 @@ namespace nano
                 size_t                          m_fsize;        ///< number of folds
                 std::vector<tchunk>             m_chunks;       ///<
                 std::vector<size_t>             m_hashes;       ///< hash / chunk
-                mutable tsamples                m_samples;      ///< stored samples (training, validation, test)
+                std::vector<scalar_t>           m_targets;      ///< distinct targets (stored contiguously)
+                std::vector<size_t>             m_thashes;      ///< hash / target
+                strings_t                       m_labels;       ///< distinct labels
+                std::vector<tsample>            m_samples;      ///< distinct samples
+                mutable tfolds                  m_fsamples;     ///< sample ids / fold (training, validation, test)
+                tid_map                         m_target_ids;   ///< target hash -> target id (only when loading)
+                tid_map                         m_sample_ids;   ///< sample hash -> sample id (only when loading)
+                std::unordered_map<string_t, uint32_t> m_label_ids;///< label -> label id (only when loading)
+                bool                            m_cache{true};  ///< cache the loaded task as a binary snapshot
         };
 
         template <typename tchunk, typename tsample>
@@ -154,49 +319,456 @@ namespace nano
         }
 
         template <typename tchunk, typename tsample>
-        bool mem_task_t<tchunk, tsample>::load()
+        void mem_task_t<tchunk, tsample>::clear()
         {
                 m_chunks.clear();
+                m_hashes.clear();
+                m_targets.clear();
+                m_thashes.clear();
+                m_labels.clear();
                 m_samples.clear();
+                m_fsamples.clear();
+                m_target_ids.clear();
+                m_sample_ids.clear();
+                m_label_ids.clear();
+        }
 
-                if (!populate())
+        template <typename tchunk, typename tsample>
+        uint32_t mem_task_t<tchunk, tsample>::next_id(const size_t count, const char* what)
+        {
+                if (count >= std::numeric_limits<uint32_t>::max())
                 {
-                        m_chunks.clear();
-                        m_samples.clear();
+                        throw std::length_error(nano::strcat("task: too many ", what, " to be indexed on 32 bits"));
+                }
+                return static_cast<uint32_t>(count);
+        }
+
+        template <typename tchunk, typename tsample>
+        template <typename ttarget>
+        uint32_t mem_task_t<tchunk, tsample>::target_id(const ttarget& target)
+        {
+                const auto osize = static_cast<size_t>(nano::size(m_odims));
+                assert(static_cast<size_t>(target.size()) == osize);
+
+                const auto hash = nano::hash_range(target.data(), target.data() + osize);
+                const auto range = m_target_ids.equal_range(hash);
+                for (auto it = range.first; it != range.second; ++ it)
+                {
+                        const auto data = m_targets.data() + it->second * osize;
+                        if (std::equal(data, data + osize, target.data()))
+                        {
+                                return it->second;
+                        }
+                }
+
+                const auto id = next_id(m_thashes.size(), "targets");
+                m_targets.insert(m_targets.end(), target.data(), target.data() + osize);
+                m_thashes.push_back(hash);
+                m_target_ids.emplace(hash, id);
+                return id;
+        }
+
+        template <typename tchunk, typename tsample>
+        uint32_t mem_task_t<tchunk, tsample>::label_id(const string_t& label)
+        {
+                const auto it = m_label_ids.find(label);
+                if (it != m_label_ids.end())
+                {
+                        return it->second;
+                }
+
+                const auto id = next_id(m_labels.size(), "labels");
+                m_labels.push_back(label);
+                m_label_ids.emplace(label, id);
+                return id;
+        }
+
+        template <typename tchunk, typename tsample>
+        uint32_t mem_task_t<tchunk, tsample>::sample_id(const tsample& sample)
+        {
+                auto hash = sample.ihash(sample.index());
+                nano::hash_combine(hash, sample.target());
+                nano::hash_combine(hash, sample.label());
+
+                const auto range = m_sample_ids.equal_range(hash);
+                for (auto it = range.first; it != range.second; ++ it)
+                {
+                        if (m_samples[it->second] == sample)
+                        {
+                                return it->second;
+                        }
+                }
+
+                const auto id = next_id(m_samples.size(), "samples");
+                m_samples.push_back(sample);
+                m_sample_ids.emplace(hash, id);
+                return id;
+        }
+
+        template <typename tchunk, typename tsample>
+        bool mem_task_t<tchunk, tsample>::load()
+        {
+                clear();
+
+                const auto path = snapshot_path();
+                if (!path.empty() && load_snapshot(path))
+                {
+                        log_info() << "task: loaded " << n_chunks() << " chunks from the snapshot <" << path << ">.";
+                        return true;
+                }
+
+                clear();
+
+                bool ok = false;
+                try
+                {
+                        ok = populate();
+                }
+                catch (std::length_error& e)
+                {
+                        log_error() << e.what() << "!";
+                }
+
+                if (!ok)
+                {
+                        clear();
                         return false;
                 }
                 else
                 {
                         // tidy-up memory
+                        tid_map().swap(m_target_ids);
+                        tid_map().swap(m_sample_ids);
+                        std::unordered_map<string_t, uint32_t>().swap(m_label_ids);
+
                         m_chunks.shrink_to_fit();
-                        for (auto& data : m_samples)
+                        m_targets.shrink_to_fit();
+                        m_thashes.shrink_to_fit();
+                        m_samples.shrink_to_fit();
+                        for (auto& data : m_fsamples)
                         {
                                 data.second.shrink_to_fit();
                         }
+
+                        if (!path.empty() && !save_snapshot(path))
+                        {
+                                log_warning() << "task: failed to save the snapshot <" << path << ">!";
+                        }
                         return true;
                 }
         }
 
+        template <typename tchunk, typename tsample>
+        string_t mem_task_t<tchunk, tsample>::snapshot_path() const
+        {
+                const auto sources = this->sources();
+                if (!m_cache || sources.empty())
+                {
+                        return string_t();
+                }
+
+                // NB: the snapshot is invalidated by changing the configuration or the files
+                auto key = std::hash<string_t>()(snapshot_config().dump());
+                nano::hash_combine(key, nano::size(m_idims));
+                nano::hash_combine(key, nano::size(m_odims));
+                nano::hash_combine(key, m_fsize);
+                for (const auto& source : sources)
+                {
+                        struct stat info;
+                        if (::stat(source.c_str(), &info) != 0)
+                        {
+                                return string_t();
+                        }
+
+                        nano::hash_combine(key, source);
+                        nano::hash_combine(key, static_cast<int64_t>(info.st_size));
+                        nano::hash_combine(key, static_cast<int64_t>(info.st_mtime));
+                }
+
+                const auto dir = sources[0].substr(0, sources[0].find_last_of("/\\") + 1);
+
+                char name[32];
+                std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+                return dir + ".nano-task-" + name + ".snapshot";
+        }
+
+        namespace detail
+        {
+                static const uint64_t snapshot_magic = 0x6e616e6f7461736bULL;     ///< "nanotask"
+                static const uint32_t snapshot_version = 3;
+
+                ///
+                /// \brief unique path (per process and call) of the temporary file used to write the given snapshot.
+                ///
+                inline string_t snapshot_temp_path(const string_t& path)
+                {
+                        static std::atomic<size_t> counter{0};
+                        return nano::strcat(path, ".tmp.", ::getpid(), ".", counter ++);
+                }
+        }
+
+        template <typename tchunk, typename tsample>
+        bool mem_task_t<tchunk, tsample>::load_snapshot(const string_t& path)
+        {
+                mmap_ibstream_t stream(path);
+                if (!stream)
+                {
+                        return false;
+                }
+
+                // NB: the number of values of the inputs and of the targets is bounded by the size of the file
+                const auto valid = [&] (const tensor3d_dim_t& dims)
+                {
+                        size_t size = 1;
+                        for (const auto dim : dims)
+                        {
+                                if (dim <= 0 || static_cast<size_t>(dim) > stream.size() / size)
+                                {
+                                        return false;
+                                }
+                                size *= static_cast<size_t>(dim);
+                        }
+                        return true;
+                };
+
+                uint64_t magic = 0;
+                uint32_t version = 0;
+                tensor3d_dim_t idims, odims;
+                size_t fsize = 0, chunks = 0, folds = 0;
+                if (    !stream.read(magic) || magic != detail::snapshot_magic ||
+                        !stream.read(version) || version != detail::snapshot_version ||
+                        !stream.read(idims) || !valid(idims) ||
+                        !stream.read(odims) || !valid(odims) ||
+                        !stream.read(fsize) || fsize != m_fsize ||
+                        !stream.read(chunks))
+                {
+                        return false;
+                }
+
+                // NB: check the number of elements against the remaining bytes before allocating (e.g. corrupted files)
+                const auto fits = [&] (const size_t count, const size_t element_size)
+                {
+                        return count <= stream.remaining() / element_size;
+                };
+
+                // NB: each chunk is followed by its hash
+                if (!fits(chunks, sizeof(size_t)))
+                {
+                        return false;
+                }
+
+                m_chunks.resize(chunks);
+                m_hashes.resize(chunks);
+                for (auto& chunk : m_chunks)
+                {
+                        if (!read_chunk(stream, chunk))
+                        {
+                                return false;
+                        }
+                }
+
+                const auto read_array = [&] (auto& array)
+                {
+                        const auto size = static_cast<std::streamsize>(array.size() * sizeof(array[0]));
+                        return stream.read(reinterpret_cast<char*>(array.data()), size) == size;
+                };
+
+                size_t targets = 0, labels = 0, samples = 0;
+                const auto osize = static_cast<size_t>(nano::size(odims));
+                if (    !read_array(m_hashes) ||
+                        !stream.read(targets) ||
+                        !fits(targets, osize * sizeof(scalar_t) + sizeof(size_t)))
+                {
+                        return false;
+                }
+
+                m_targets.resize(targets * osize);
+                m_thashes.resize(targets);
+                if (    !read_array(m_targets) ||
+                        !read_array(m_thashes) ||
+                        !stream.read(labels) ||
+                        !fits(labels, sizeof(std::streamsize)))
+                {
+                        return false;
+                }
+
+                m_labels.resize(labels);
+                for (auto& label : m_labels)
+                {
+                        if (!stream.read(label))
+                        {
+                                return false;
+                        }
+                }
+
+                // NB: each sample stores at least the index of its chunk
+                if (    !stream.read(samples) ||
+                        !fits(samples, sizeof(uint32_t)))
+                {
+                        return false;
+                }
+
+                m_samples.resize(samples);
+                for (auto& sample : m_samples)
+                {
+                        if (    !sample.read(stream) ||
+                                sample.index() >= chunks || sample.target() >= targets || sample.label() >= labels)
+                        {
+                                return false;
+                        }
+                }
+
+                if (!stream.read(folds))
+                {
+                        return false;
+                }
+
+                for (size_t f = 0; f < folds; ++ f)
+                {
+                        fold_t fold{0, protocol::train};
+                        size_t count = 0;
+                        if (!stream.read(fold) || !stream.read(count) || !fits(count, sizeof(uint32_t)))
+                        {
+                                return false;
+                        }
+
+                        auto& ids = m_fsamples[fold];
+                        ids.resize(count);
+                        if (    !read_array(ids) ||
+                                std::any_of(ids.begin(), ids.end(), [&] (const uint32_t id) { return id >= samples; }))
+                        {
+                                return false;
+                        }
+                }
+
+                if (stream.remaining() != 0)
+                {
+                        return false;
+                }
+
+                // NB: the dimensions may be decided when populating the task (e.g. CSV files)
+                m_idims = idims;
+                m_odims = odims;
+                return true;
+        }
+
+        template <typename tchunk, typename tsample>
+        bool mem_task_t<tchunk, tsample>::save_snapshot(const string_t& path) const
+        {
+                // NB: write to a temporary file first, so that an interrupted run doesn't leave a partial snapshot,
+                //      and use a unique name, so that concurrent runs don't write to the same temporary file
+                const auto tpath = detail::snapshot_temp_path(path);
+
+                bool ok = false;
+                {
+                        obstream_t stream(tpath);
+                        ok = write_snapshot(stream);
+                }
+
+                if (!ok || std::rename(tpath.c_str(), path.c_str()) != 0)
+                {
+                        std::remove(tpath.c_str());
+                        return false;
+                }
+
+                return true;
+        }
+
+        template <typename tchunk, typename tsample>
+        bool mem_task_t<tchunk, tsample>::write_snapshot(obstream_t& stream) const
+        {
+                if (    !stream.write(detail::snapshot_magic) ||
+                        !stream.write(detail::snapshot_version) ||
+                        !stream.write(m_idims) ||
+                        !stream.write(m_odims) ||
+                        !stream.write(m_fsize) ||
+                        !stream.write(m_chunks.size()))
+                {
+                        return false;
+                }
+
+                for (const auto& chunk : m_chunks)
+                {
+                        if (!write_chunk(stream, chunk))
+                        {
+                                return false;
+                        }
+                }
+
+                const auto write_array = [&] (const auto& array)
+                {
+                        const auto size = static_cast<std::streamsize>(array.size() * sizeof(array[0]));
+                        return stream.write(reinterpret_cast<const char*>(array.data()), size);
+                };
+
+                if (    !write_array(m_hashes) ||
+                        !stream.write(m_thashes.size()) ||
+                        !write_array(m_targets) ||
+                        !write_array(m_thashes) ||
+                        !stream.write(m_labels.size()))
+                {
+                        return false;
+                }
+
+                for (const auto& label : m_labels)
+                {
+                        if (!stream.write(label))
+                        {
+                                return false;
+                        }
+                }
+
+                if (!stream.write(m_samples.size()))
+                {
+                        return false;
+                }
+
+                for (const auto& sample : m_samples)
+                {
+                        if (!sample.write(stream))
+                        {
+                                return false;
+                        }
+                }
+
+                if (!stream.write(m_fsamples.size()))
+                {
+                        return false;
+                }
+
+                for (const auto& ids : m_fsamples)
+                {
+                        if (    !stream.write(ids.first) ||
+                                !stream.write(ids.second.size()) ||
+                                !write_array(ids.second))
+                        {
+                                return false;
+                        }
+                }
+
+                return true;
+        }
+
         template <typename tchunk, typename tsample>
         size_t mem_task_t<tchunk, tsample>::size() const
         {
-                return  std::accumulate(m_samples.begin(), m_samples.end(), size_t(0),
-                        [&] (const size_t count, const auto& samples) { return count + samples.second.size(); });
+                return  std::accumulate(m_fsamples.begin(), m_fsamples.end(), size_t(0),
+                        [&] (const size_t count, const auto& ids) { return count + ids.second.size(); });
         }
 
         template <typename tchunk, typename tsample>
         size_t mem_task_t<tchunk, tsample>::size(const fold_t& fold) const
         {
-                const auto it = m_samples.find(fold);
-                assert(it != m_samples.end());
+                const auto it = m_fsamples.find(fold);
+                assert(it != m_fsamples.end());
                 return it->second.size();
         }
 
         template <typename tchunk, typename tsample>
         void mem_task_t<tchunk, tsample>::shuffle(const fold_t& fold) const
         {
-                const auto it = m_samples.find(fold);
-                assert(it != m_samples.end());
+                const auto it = m_fsamples.find(fold);
+                assert(it != m_fsamples.end());
                 std::shuffle(it->second.begin(), it->second.end(), make_rng());
         }
 
@@ -209,8 +781,9 @@ namespace nano
                 {
                         const auto& sample = get_sample(fold, index);
                         const auto& chunk = get_chunk(sample);
-                        minibatch.copy(static_cast<tensor_size_t>(index - begin),
-                                sample.input(chunk), sample.output(), sample.label());
+                        const auto mindex = static_cast<tensor_size_t>(index - begin);
+                        input(fold, sample, chunk, minibatch.idata(mindex));
+                        minibatch.copy(mindex, get_target(sample), get_label(sample));
                 }
                 return minibatch;
         }
@@ -226,13 +799,13 @@ namespace nano
         size_t mem_task_t<tchunk, tsample>::ohash(const fold_t& fold, const size_t index) const
         {
                 const auto& sample = get_sample(fold, index);
-                return sample.ohash();
+                return m_thashes[sample.target()];
         }
 
         template <typename tchunk, typename tsample>
         string_t mem_task_t<tchunk, tsample>::label(const fold_t& fold, const size_t index) const
         {
                 const auto& sample = get_sample(fold, index);
-                return sample.label();
+                return get_label(sample);
         }
 }
@@ -1,64 +1,171 @@
-#include "core/table.h"
+#include <cstring>
+#include <cstdlib>
+#include <unordered_map>
+#include "core/tpool.h"
 #include "core/logger.h"
+#include "core/algorithm.h"
 #include "task_mem_csv.h"
+#include "core/mmap_ibstream.h"
 
 using namespace nano;
 
-static void scale(const string_t& name, tensor3ds_t& samples)
+namespace
 {
-        const auto dims = samples.begin()->size();
+        ///
+        /// \brief samples parsed from a range of lines of the CSV file.
+        ///
+        struct csv_range_t
+        {
+                const char*             m_begin{nullptr};
+                const char*             m_end{nullptr};
+                tensor3ds_t             m_samples;      ///< inputs
+                std::vector<uint32_t>   m_label_ids;    ///< label (index in m_labels) / sample
+                strings_t               m_labels;       ///< distinct labels (in the order of appearance)
+                vector_t                m_maximums;     ///< maximum absolute value / attribute
+                string_t                m_error;        ///< parsing error (if any)
+        };
 
-        vector_t maximums = vector_t::Constant(dims, 1);
-        for (const auto& sample : samples)
+        const char* trim_left(const char* begin, const char* end)
         {
-                assert(maximums.size() == sample.array().size());
-                maximums.array() = maximums.array().max(sample.array().abs());
+                while (begin < end && (*begin == ' ' || *begin == '\t')) { ++ begin; }
+                return begin;
         }
 
-        const vector_t scale = 1 / maximums.array();
-        for (auto& sample : samples)
+        const char* trim_right(const char* begin, const char* end)
         {
-                sample.array() *= scale.array();
+                while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) { -- end; }
+                return end;
         }
 
-        log_info() << name << ": scaled using [" << maximums.transpose() << "].";
-}
-
-static bool load_csv(const string_t& path, const string_t& name, table_t& table)
-{
-        const auto csv_delim = ",";
-        const auto csv_header = false;
-
-        log_info() << name << ": loading file <" << path << "> ...";
-        if (!table.load(path, csv_delim, csv_header))
+        const char* find(const char* begin, const char* end, const char c)
         {
-                log_error() << name << ": failed to load file <" << path << ">!";
-                return false;
+                // NB: memchr is vectorized by the C library
+                const auto* it = static_cast<const char*>(std::memchr(begin, c, static_cast<size_t>(end - begin)));
+                return it ? it : end;
         }
 
-        return true;
-}
-
-static bool load_labels(const string_t& name, const table_t& table, const size_t label_column, strings_t& labels)
-{
-        for (size_t i = 0; i < table.rows(); ++ i)
+        bool parse_scalar(const char* begin, const char* end, scalar_t& value)
         {
-                const auto& row = table.row(i);
-                if (label_column >= row.cols())
+                begin = trim_left(begin, end);
+                end = trim_right(begin, end);
+
+                // NB: the mapped file is not null-terminated, so copy the (short) field
+                char buffer[64];
+                const auto size = static_cast<size_t>(end - begin);
+                if (size == 0 || size >= sizeof(buffer))
                 {
-                        log_error() << name << ": invalid label column " << label_column << "/" << row.cols() << "!";
                         return false;
                 }
+                std::memcpy(buffer, begin, size);
+                buffer[size] = '\0';
 
-                labels.push_back(row.cell(label_column).m_data);
+                char* last = nullptr;
+                value = static_cast<scalar_t>(std::strtod(buffer, &last));
+                return last == buffer + size;
         }
 
-        std::sort(labels.begin(), labels.end());
-        labels.erase(
-                std::unique(labels.begin(), labels.end()),
-                labels.end());
+        ///
+        /// \brief count the columns of the first non-empty line
+        ///
+        size_t count_cols(const char* begin, const char* end)
+        {
+                for (auto line = begin; line < end; )
+                {
+                        const auto eol = find(line, end, '\n');
+                        const auto last = trim_right(line, eol);
+                        if (trim_left(line, last) < last)
+                        {
+                                return static_cast<size_t>(std::count(line, last, ',')) + 1;
+                        }
+                        line = eol + 1;
+                }
+                return 0;
+        }
 
-        return true;
+        ///
+        /// \brief split the given buffer in ranges of full lines of approximately the given size
+        ///
+        std::vector<csv_range_t> split_ranges(const char* begin, const char* end, const size_t range_size)
+        {
+                std::vector<csv_range_t> ranges;
+                for (auto it = begin; it < end; )
+                {
+                        const auto eol = (static_cast<size_t>(end - it) > range_size) ?
+                                find(it + range_size, end, '\n') : end;
+                        const auto next = (eol == end) ? end : eol + 1;
+
+                        ranges.emplace_back();
+                        ranges.rbegin()->m_begin = it;
+                        ranges.rbegin()->m_end = next;
+                        it = next;
+                }
+                return ranges;
+        }
+
+        void parse_range(csv_range_t& range, const size_t cols, const size_t label_column)
+        {
+                const auto n_attributes = static_cast<tensor_size_t>(cols) - 1;
+                range.m_maximums = vector_t::Constant(n_attributes, 1);
+
+                std::unordered_map<string_t, uint32_t> label_ids;
+                for (auto line = range.m_begin; line < range.m_end; )
+                {
+                        const auto eol = find(line, range.m_end, '\n');
+                        const auto last = trim_right(line, eol);
+                        if (trim_left(line, last) == last)
+                        {
+                                line = eol + 1;
+                                continue;
+                        }
+
+                        tensor3d_t sample(n_attributes, 1, 1);
+                        uint32_t label_id = 0;
+
+                        size_t col = 0;
+                        tensor_size_t attribute = 0;
+                        for (auto field = line; ; ++ col)
+                        {
+                                const auto delim = find(field, last, ',');
+                                if (col >= cols)
+                                {
+                                        break;
+                                }
+                                else if (col == label_column)
+                                {
+                                        const auto label = string_t(trim_left(field, delim), trim_right(field, delim));
+                                        const auto it = label_ids.emplace(label, static_cast<uint32_t>(range.m_labels.size()));
+                                        if (it.second)
+                                        {
+                                                range.m_labels.push_back(label);
+                                        }
+                                        label_id = it.first->second;
+                                }
+                                else if (!parse_scalar(field, delim, sample(attribute ++)))
+                                {
+                                        range.m_error = "invalid value <" + string_t(field, delim) + ">";
+                                        return;
+                                }
+
+                                if (delim == last)
+                                {
+                                        break;
+                                }
+                                field = delim + 1;
+                        }
+
+                        if (col + 1 != cols)
+                        {
+                                range.m_error = "invalid number of columns in line <" + string_t(line, last) + ">";
+                                return;
+                        }
+
+                        range.m_maximums.array() = range.m_maximums.array().max(sample.array().abs());
+                        range.m_samples.push_back(std::move(sample));
+                        range.m_label_ids.push_back(label_id);
+
+                        line = eol + 1;
+                }
+        }
 }
 
 mem_csv_task_t::mem_csv_task_t(string_t name, string_t path, const size_t label_column) :
@@ -80,78 +187,128 @@ void mem_csv_task_t::to_json(json_t& json) const
         nano::to_json(json, "path", m_path, "folds", m_folds);
 }
 
+strings_t mem_csv_task_t::sources() const
+{
+        return {m_path};
+}
+
 bool mem_csv_task_t::populate()
 {
-        // load CSV
-        table_t table;
-        if (!load_csv(m_path, m_name, table))
+        log_info() << m_name << ": loading file <" << m_path << "> ...";
+
+        const mmap_t file(m_path);
+        if (!file)
         {
+                log_error() << m_name << ": failed to load file <" << m_path << ">!";
                 return false;
         }
 
-        strings_t labels;
-        if (!load_labels(m_name, table, m_label_column, labels))
+        const auto cols = count_cols(file.data(), file.data() + file.size());
+        if (m_label_column >= cols)
         {
+                log_error() << m_name << ": invalid label column " << m_label_column << "/" << cols << "!";
                 return false;
         }
 
-        const auto n_samples = static_cast<tensor_size_t>(table.rows());
+        // parse ranges of lines in parallel
+        const auto range_size = size_t(1) << 20;
+        auto ranges = split_ranges(file.data(), file.data() + file.size(), range_size);
+
+        loopi(ranges.size(), size_t(1), [&] (const size_t begin, const size_t end)
+        {
+                for (size_t r = begin; r < end; ++ r)
+                {
+                        parse_range(ranges[r], cols, m_label_column);
+                }
+        });
+
+        for (const auto& range : ranges)
+        {
+                if (!range.m_error.empty())
+                {
+                        log_error() << m_name << ": failed to load file <" << m_path << ">: " << range.m_error << "!";
+                        return false;
+                }
+        }
+
+        // merge the labels and the scaling factors of all ranges
+        const auto n_attributes = static_cast<tensor_size_t>(cols) - 1;
+
+        strings_t labels;
+        size_t n_samples = 0;
+        vector_t maximums = vector_t::Constant(n_attributes, 1);
+        for (const auto& range : ranges)
+        {
+                labels.insert(labels.end(), range.m_labels.begin(), range.m_labels.end());
+                n_samples += range.m_samples.size();
+                maximums.array() = maximums.array().max(range.m_maximums.array());
+        }
+
+        std::sort(labels.begin(), labels.end());
+        labels.erase(
+                std::unique(labels.begin(), labels.end()),
+                labels.end());
+
         const auto n_labels = static_cast<tensor_size_t>(labels.size());
-        const auto n_attributes = static_cast<tensor_size_t>(table.cols()) - 1;
 
         reconfig(
                 make_dims(n_attributes, 1, 1),
                 make_dims(n_labels, 1, 1),
                 m_folds);
 
-        // load samples
-        tensor3ds_t samples(table.rows(), tensor3d_t{idims()});
-        std::vector<tensor_size_t> class_indices(table.rows());
-        for (size_t i = 0; i < table.rows(); ++ i)
+        // scale inputs to improve numerical robustness and move them to the task
+        const vector_t scale = 1 / maximums.array();
+        log_info() << m_name << ": scaled using [" << maximums.transpose() << "].";
+
+        std::vector<size_t> offsets(ranges.size() + 1, 0);
+        for (size_t r = 0; r < ranges.size(); ++ r)
         {
-                auto& sample = samples[i];
-                auto& class_index = class_indices[i];
+                offsets[r + 1] = offsets[r] + ranges[r].m_samples.size();
+        }
 
-                const auto& row = table.row(i);
-                for (size_t c = 0; c < table.cols(); ++ c)
+        std::vector<tensor_size_t> class_indices(n_samples);
+        const auto chunk_begin = alloc_chunks(n_samples);
+
+        loopi(ranges.size(), size_t(1), [&] (const size_t begin, const size_t end)
+        {
+                for (size_t r = begin; r < end; ++ r)
                 {
-                        const auto& data = row.cell(c).m_data;
-                        if (c == m_label_column)
+                        auto& range = ranges[r];
+
+                        std::vector<tensor_size_t> range_classes(range.m_labels.size());
+                        for (size_t l = 0; l < range.m_labels.size(); ++ l)
                         {
-                                const auto itl = std::find(labels.begin(), labels.end(), data);
-                                assert(itl != labels.end());
-                                class_index = itl - labels.begin();
+                                const auto itl = std::lower_bound(labels.begin(), labels.end(), range.m_labels[l]);
+                                assert(itl != labels.end() && *itl == range.m_labels[l]);
+                                range_classes[l] = itl - labels.begin();
                         }
-                        else
+
+                        for (size_t i = 0; i < range.m_samples.size(); ++ i)
                         {
-                                sample(static_cast<tensor_size_t>(c ? c - 1 : c), 0, 0) = from_string<scalar_t>(data);
+                                const auto index = offsets[r] + i;
+                                const auto hash = index;
+
+                                auto& sample = range.m_samples[i];
+                                sample.array() *= scale.array();
+                                set_chunk(chunk_begin + index, std::move(sample), hash);
+                                class_indices[index] = range_classes[range.m_label_ids[i]];
                         }
-                }
-        }
 
-        // scale inputs to improve numerical robustness
-        if (!samples.empty() && samples.begin()->size() > 0)
-        {
-                scale(m_name, samples);
-        }
+                        range = csv_range_t();
+                }
+        });
 
         // setup task
-        for (size_t i = 0; i < samples.size(); ++ i)
-        {
-                const auto hash = i;
-                add_chunk(samples[i], hash);
-        }
-
         for (size_t f = 0; f < m_folds; ++ f)
         {
-                const auto protocols = split3(samples.size(),
+                const auto protocols = split3(n_samples,
                         protocol::train, m_train_percentage, protocol::valid, m_valid_percentage, protocol::test);
 
-                for (size_t i = 0; i < samples.size(); ++ i)
+                for (size_t i = 0; i < n_samples; ++ i)
                 {
                         const auto fold = fold_t{f, protocols[i]};
                         const auto target = class_target(class_indices[i], nano::size(odims()));
-                        add_sample(fold, i, target, labels[static_cast<size_t>(class_indices[i])]);
+                        add_sample(fold, chunk_begin + i, target, labels[static_cast<size_t>(class_indices[i])]);
                 }
         }
 
@@ -9,6 +9,9 @@ namespace nano
         ///     - assumes the target is one dimensional (either a class or a scalar to predict)
         ///     - assumes no missing data
         ///
+        /// NB: the file is memory mapped and split into ranges of lines parsed in parallel,
+        ///     directly into the input tensors (the maximum absolute values used for scaling are collected at the same time).
+        ///
         class mem_csv_task_t : public mem_tensor_task_t
         {
         public:
@@ -16,6 +19,7 @@ namespace nano
                 mem_csv_task_t(string_t name, string_t path, const size_t label_column);
 
                 bool populate() final;
+                strings_t sources() const final;
                 void to_json(json_t&) const final;
                 void from_json(const json_t&) final;
 
@@ -2,6 +2,8 @@
 
 #include "task_mem.h"
 #include "core/hash.h"
+#include "core/obstream.h"
+#include "core/mmap_ibstream.h"
 
 namespace nano
 {
@@ -9,39 +11,59 @@ namespace nano
         {
                 mem_tensor_sample_t() = default;
 
-                explicit mem_tensor_sample_t(
-                        const size_t index = 0,
-                        tensor3d_t target = tensor3d_t(),
-                        string_t label = string_t()) :
-                        m_index(index),
-                        m_target(std::move(target)),
-                        m_label(std::move(label))
+                mem_tensor_sample_t(const size_t index, const uint32_t target, const uint32_t label) :
+                        m_index(static_cast<uint32_t>(index)),
+                        m_target(target),
+                        m_label(label)
                 {
                 }
 
-                mem_tensor_sample_t(
-                        const size_t index,
-                        const vector_t& target,
-                        string_t label = string_t()) :
-                        m_index(index),
-                        m_target(nano::map_tensor(target.data(), target.size(), 1, 1)),
-                        m_label(std::move(label))
+                auto index() const { return m_index; }
+                auto target() const { return m_target; }
+                auto label() const { return m_label; }
+                void input(const tensor3d_t& tensor, tensor3d_map_t idata) const { idata.vector() = tensor.vector(); }
+                auto ihash(const size_t seed) const { return seed; }
+
+                bool operator==(const mem_tensor_sample_t& other) const
                 {
+                        return  m_index == other.m_index &&
+                                m_target == other.m_target &&
+                                m_label == other.m_label;
                 }
 
-                auto index() const { return m_index; }
-                auto input(const tensor3d_t& tensor) const { return tensor; }
-                auto ihash(const size_t seed) const { return seed; }
-                auto ohash() const { return nano::hash_range(m_target.data(), m_target.data() + m_target.size()); }
-                auto output() const { return m_target; }
-                auto label() const { return m_label; }
+                bool write(obstream_t& stream) const
+                {
+                        return  stream.write(m_index) &&
+                                stream.write(m_target) &&
+                                stream.write(m_label);
+                }
+
+                bool read(mmap_ibstream_t& stream)
+                {
+                        return  stream.read(m_index) &&
+                                stream.read(m_target) &&
+                                stream.read(m_label);
+                }
 
                 // attributes
-                size_t          m_index{0};     ///< input tensor index
-                tensor3d_t      m_target;       ///<
-                string_t        m_label;        ///<
+                uint32_t        m_index{0};     ///< input tensor index
+                uint32_t        m_target{0};    ///< target id
+                uint32_t        m_label{0};     ///< label id
         };
 
+        ///
+        /// \brief serialize tensors (e.g. for caching tasks).
+        ///
+        inline bool write_chunk(obstream_t& stream, const tensor3d_t& tensor)
+        {
+                return stream.write_tensor(tensor);
+        }
+
+        inline bool read_chunk(mmap_ibstream_t& stream, tensor3d_t& tensor)
+        {
+                return stream.read_tensor(tensor);
+        }
+
         ///
         /// \brief in-memory generic task consisting of generic 3D input tensors.
         ///
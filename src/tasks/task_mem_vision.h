@@ -1,8 +1,11 @@
 #pragma once
 
 #include "task_mem.h"
+#include "task_augment.h"
 #include "core/hash.h"
 #include "core/image.h"
+#include "core/obstream.h"
+#include "core/mmap_ibstream.h"
 
 namespace nano
 {
@@ -12,34 +15,52 @@ namespace nano
 
                 mem_vision_sample_t(
                         const size_t index,
-                        const vector_t& target,
-                        string_t label = string_t(),
+                        const uint32_t target,
+                        const uint32_t label,
                         const rect_t& region = rect_t()) :
-                        m_index(index),
-                        m_region(region),
-                        m_target(nano::map_tensor(target.data(), target.size(), 1, 1)),
-                        m_label(std::move(label))
+                        m_index(static_cast<uint32_t>(index)),
+                        m_target(target),
+                        m_label(label),
+                        m_region(region)
                 {
                 }
 
                 auto index() const { return m_index; }
-                tensor3d_t input(const image_t& image) const;
-                auto output() const { return m_target; }
+                auto target() const { return m_target; }
                 auto label() const { return m_label; }
+                const auto& region() const { return m_region; }
+                void input(const image_t& image, tensor3d_map_t idata) const;
 
-                size_t ohash() const;
                 size_t ihash(size_t seed) const;
 
+                bool operator==(const mem_vision_sample_t& other) const
+                {
+                        return  m_index == other.m_index &&
+                                m_target == other.m_target &&
+                                m_label == other.m_label &&
+                                m_region == other.m_region;
+                }
+
+                bool write(obstream_t&) const;
+                bool read(mmap_ibstream_t&);
+
                 // attributes
-                size_t          m_index{0};     ///< image index
+                uint32_t        m_index{0};     ///< image index
+                uint32_t        m_target{0};    ///< target id
+                uint32_t        m_label{0};     ///< label id
                 rect_t          m_region;       ///< patch region in image
-                tensor3d_t      m_target;       ///<
-                string_t        m_label;        ///<
         };
 
-        inline tensor3d_t mem_vision_sample_t::input(const image_t& image) const
+        inline void mem_vision_sample_t::input(const image_t& image, tensor3d_map_t idata) const
         {
-                return m_region.empty() ? image.to_tensor() : image.to_tensor(m_region);
+                if (m_region.empty())
+                {
+                        image.to_tensor(idata);
+                }
+                else
+                {
+                        image.to_tensor(m_region, idata);
+                }
         }
 
         inline size_t mem_vision_sample_t::ihash(size_t seed) const
@@ -52,15 +73,49 @@ namespace nano
                 return seed;
         }
 
-        inline size_t mem_vision_sample_t::ohash() const
+        inline bool mem_vision_sample_t::write(obstream_t& stream) const
+        {
+                return  stream.write(m_index) &&
+                        stream.write(m_region.left()) && stream.write(m_region.top()) &&
+                        stream.write(m_region.width()) && stream.write(m_region.height()) &&
+                        stream.write(m_target) &&
+                        stream.write(m_label);
+        }
+
+        inline bool mem_vision_sample_t::read(mmap_ibstream_t& stream)
+        {
+                coord_t left = 0, top = 0, width = 0, height = 0;
+                const auto ok =
+                        stream.read(m_index) &&
+                        stream.read(left) && stream.read(top) &&
+                        stream.read(width) && stream.read(height) &&
+                        stream.read(m_target) &&
+                        stream.read(m_label);
+                m_region = rect_t(left, top, width, height);
+                return ok;
+        }
+
+        ///
+        /// \brief serialize images (e.g. for caching tasks).
+        ///
+        inline bool write_chunk(obstream_t& stream, const image_t& image)
+        {
+                return stream.write_tensor(image.data());
+        }
+
+        inline bool read_chunk(mmap_ibstream_t& stream, image_t& image)
         {
-                return nano::hash_range(m_target.data(), m_target.data() + m_target.size());
+                image_tensor_t data;
+                return  stream.read_tensor(data) &&
+                        image.load(data);
         }
 
         ///
         /// \brief in-memory generic computer vision task consisting of images and
         ///     fixed-size rectangular samples from these images.
         ///
+        /// NB: the samples of the training folds are augmented on the fly if configured (see augment_t).
+        ///
         struct mem_vision_task_t : public mem_task_t<image_t, mem_vision_sample_t>
         {
                 ///
@@ -111,6 +166,17 @@ namespace nano
                         }
                 }
 
+                ///
+                /// \brief access the on-the-fly augmentation (e.g. to configure it from JSON)
+                ///
+                const augment_t& augment() const { return m_augment; }
+                augment_t& augment() { return m_augment; }
+
+                bool augmented(const fold_t& fold) const override
+                {
+                        return fold.m_protocol == protocol::train && m_augment.enabled();
+                }
+
                 ///
                 /// \brief reconfigure
                 ///
@@ -124,5 +190,33 @@ namespace nano
                                 make_dims(color == color_mode::rgba ? 4 : (color == color_mode::rgb ? 3 : 1), irows, icols),
                                 odims, fsize);
                 }
+
+        protected:
+
+                json_t snapshot_config() const override
+                {
+                        // NB: the augmentation doesn't change the stored images
+                        auto json = mem_task_t<image_t, mem_vision_sample_t>::snapshot_config();
+                        augment_t::erase(json);
+                        return json;
+                }
+
+                void input(const fold_t& fold, const mem_vision_sample_t& sample, const image_t& image,
+                        tensor3d_map_t idata) const override
+                {
+                        if (augmented(fold))
+                        {
+                                m_augment(image, sample.region(), idata);
+                        }
+                        else
+                        {
+                                sample.input(image, idata);
+                        }
+                }
+
+        private:
+
+                // attributes
+                augment_t       m_augment;      ///< on-the-fly augmentation of the training samples
         };
 }
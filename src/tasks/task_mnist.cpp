@@ -1,3 +1,4 @@
+#include <future>
 #include "task_mnist.h"
 #include "core/logger.h"
 #include "core/archive.h"
@@ -59,6 +60,7 @@ template <mnist_type ttype>
 void base_mnist_task_t<ttype>::from_json(const json_t& json)
 {
         nano::from_json(json, "dir", m_dir, "folds", m_folds);
+        augment().from_json(json);
         reconfig(make_dims(1, 28, 28), make_dims(10, 1, 1), m_folds);
 }
 
@@ -66,6 +68,19 @@ template <mnist_type ttype>
 void base_mnist_task_t<ttype>::to_json(json_t& json) const
 {
         nano::to_json(json, "dir", m_dir, "folds", m_folds);
+        augment().to_json(json);
+}
+
+template <mnist_type ttype>
+strings_t base_mnist_task_t<ttype>::sources() const
+{
+        return
+        {
+                m_dir + "/train-images-idx3-ubyte.gz",
+                m_dir + "/train-labels-idx1-ubyte.gz",
+                m_dir + "/t10k-images-idx3-ubyte.gz",
+                m_dir + "/t10k-labels-idx1-ubyte.gz"
+        };
 }
 
 template <mnist_type ttype>
@@ -77,44 +92,61 @@ bool base_mnist_task_t<ttype>::populate()
         const auto train_ifile = m_dir + "/train-images-idx3-ubyte.gz";
         const auto train_gfile = m_dir + "/train-labels-idx1-ubyte.gz";
 
-        return  load_binary(train_ifile, train_gfile, protocol::train, 60000) &&
-                load_binary(test_ifile, test_gfile, protocol::test, 10000);
+        const auto train_count = size_t(60000);
+        const auto test_count = size_t(10000);
+
+        // decode the training and the test files concurrently into their pre-allocated chunks
+        const auto train_begin = alloc_chunks(train_count);
+        const auto test_begin = alloc_chunks(test_count);
+
+        std::vector<tensor_size_t> train_ilabels, test_ilabels;
+        auto train_status = std::async(std::launch::async, [&] ()
+        {
+                return load_binary(train_ifile, train_gfile, train_begin, train_count, train_ilabels);
+        });
+        const auto test_status = load_binary(test_ifile, test_gfile, test_begin, test_count, test_ilabels);
+        if (!train_status.get() || !test_status)
+        {
+                return false;
+        }
+
+        // generate folds (in the same order as the files, so that the folds do not depend on the decoding order)
+        add_samples(protocol::train, train_begin, train_ilabels, ::labels<ttype>());
+        add_samples(protocol::test, test_begin, test_ilabels, ::labels<ttype>());
+
+        return  n_chunks() == train_count + test_count &&
+                size() == (train_count + test_count) * m_folds;
 }
 
 template <mnist_type ttype>
-bool base_mnist_task_t<ttype>::load_binary(const string_t& ifile, const string_t& gfile, const protocol p, const size_t count)
+bool base_mnist_task_t<ttype>::load_binary(const string_t& ifile, const string_t& gfile,
+        const size_t chunk_begin, const size_t count, std::vector<tensor_size_t>& ilabels)
 {
-        const auto chunk_begin = n_chunks();
-        const auto sample_begin = size();
-
         const auto irows = std::get<1>(idims());
         const auto icols = std::get<2>(idims());
-        const auto buffer_size = irows * icols;
+        const auto record_size = irows * icols;
 
-        std::vector<char> buffer(static_cast<size_t>(buffer_size));
-        char label[2];
+        char header[16];
 
         const auto error_op = [&] (const string_t& message)
         {
                 log_error() << name<ttype>() << ": " << message;
         };
 
-        // load images
+        // load images (decode them in parallel)
         const auto iop = [&] (const string_t&, istream_t& stream)
         {
-                if (stream.read(buffer.data(), 16) != 16)
-                {
-                        return false;
-                }
-
-                while (stream.read(buffer.data(), buffer_size) == buffer_size)
+                const auto op = [&] (const char* record, const size_t i)
                 {
                         image_t image;
-                        image.load_luma(buffer.data(), irows, icols);
-                        add_chunk(image, image.hash());
-                }
-
-                return true;
+                        image.load_luma(record, irows, icols);
+                        const auto hash = image.hash();
+                        set_chunk(chunk_begin + i, std::move(image), hash);
+                        return true;
+                };
+
+                return  stream.read(header, 16) == 16 &&
+                        load_chunks(stream, count, record_size, op);
         };
 
         log_info() << name<ttype>() << ": loading file <" << ifile << "> ...";
@@ -127,12 +159,12 @@ bool base_mnist_task_t<ttype>::load_binary(const string_t& ifile, const string_t
         // load ground truth
         const auto gop = [&] (const string_t&, istream_t& stream)
         {
-                if (stream.read(buffer.data(), 8) != 8)
+                if (stream.read(header, 8) != 8)
                 {
                         return false;
                 }
 
-                std::vector<tensor_size_t> ilabels;
+                char label[1];
                 while (stream.read(label, 1) == 1)
                 {
                         const auto ilabel = static_cast<tensor_size_t>(label[0]);
@@ -149,8 +181,6 @@ bool base_mnist_task_t<ttype>::load_binary(const string_t& ifile, const string_t
                         return false;
                 }
 
-                // generate folds
-                add_samples(p, ilabels, ::labels<ttype>());
                 return true;
         };
 
@@ -162,9 +192,8 @@ bool base_mnist_task_t<ttype>::load_binary(const string_t& ifile, const string_t
         }
 
         // OK
-        log_info() << name<ttype>() << ": loaded " << (n_chunks() - chunk_begin) << " samples.";
-        return  n_chunks() == chunk_begin + count &&
-                size() == sample_begin + count * m_folds;
+        log_info() << name<ttype>() << ": loaded " << count << " samples.";
+        return true;
 }
 
 template class nano::base_mnist_task_t<mnist_type::digits>;
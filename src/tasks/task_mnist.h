@@ -37,12 +37,14 @@ namespace nano
 
                 base_mnist_task_t();
                 bool populate() override;
+                strings_t sources() const override;
                 void to_json(json_t&) const final;
                 void from_json(const json_t&) final;
 
         private:
 
-                bool load_binary(const string_t& ifile, const string_t& gfile, const protocol, const size_t count);
+                bool load_binary(const string_t& ifile, const string_t& gfile,
+                        const size_t chunk_begin, const size_t count, std::vector<tensor_size_t>& ilabels);
 
                 // attributes
                 string_t        m_dir;          ///< directory where to load the task from
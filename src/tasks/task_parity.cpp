@@ -3,64 +3,35 @@
 using namespace nano;
 
 parity_task_t::parity_task_t() :
-        mem_tensor_task_t(make_dims(32, 1, 1), make_dims(1, 1, 1), 10)
+        synth_task_t(make_dims(32, 1, 1), make_dims(1, 1, 1), 1024, 10)
 {
 }
 
 void parity_task_t::from_json(const json_t& json)
 {
-        nano::from_json(json, "n", m_dims, "count", m_count, "folds", m_folds);
-        reconfig(make_dims(m_dims, 1, 1), make_dims(1, 1, 1), m_folds);
+        auto seed = make_seed();
+        nano::from_json(json, "n", m_dims, "count", m_count, "folds", m_folds, "seed", seed);
+        reconfig(make_dims(m_dims, 1, 1), make_dims(1, 1, 1), m_count, m_folds, seed);
 }
 
 void parity_task_t::to_json(json_t& json) const
 {
-        nano::to_json(json, "n", m_dims, "count", m_count, "folds", m_folds);
+        nano::to_json(json, "n", m_dims, "count", m_count, "folds", m_folds, "seed", seed());
 }
 
-bool parity_task_t::populate()
+string_t parity_task_t::generate(counter_rng_t& irng, counter_rng_t&, tensor3d_map_t input, tensor3d_map_t target) const
 {
-        auto rng = make_rng();
-        auto udist_bit = make_udist<tensor_size_t>(1, 1024);
-
-        tensor3d_t bitset(m_dims, 1, 1);
-
-        // generate samples
-        reserve_chunks(m_count);
-        for (size_t i = 0; i < m_count; ++ i)
+        size_t ones = 0;
+        for (tensor_size_t x = 0; x < m_dims; x += 64)
         {
-                for (tensor_size_t x = 0; x < m_dims; ++ x)
+                auto bits = irng();
+                for (tensor_size_t b = x; b < std::min(x + 64, m_dims); ++ b, bits >>= 1)
                 {
-                        if ((udist_bit(rng) & 0x01))
-                        {
-                                bitset(x) = 1;
-                        }
-                        else
-                        {
-                                bitset(x) = 0;
-                        }
-                }
-
-                const auto hash = i;
-                add_chunk(bitset, hash);
-        }
-
-        // generate folds
-        for (size_t f = 0; f < m_folds; ++ f)
-        {
-                const auto protocols = split3(m_count, protocol::train, 40, protocol::valid, 30, protocol::test);
-
-                for (size_t i = 0; i < m_count; ++ i)
-                {
-                        const size_t ones = (chunk(i).array() > scalar_t(0.5)).count();
-
-                        const auto label = (ones % 2) ? "odd" : "even";
-                        const auto target = class_target(1 - (ones % 2), 1);
-                        const auto fold = fold_t{f, protocols[i]};
-
-                        add_sample(fold, i, target, label);
+                        input(b) = (bits & 0x01) ? 1 : 0;
+                        ones += bits & 0x01;
                 }
         }
 
-        return true;
+        target.vector() = class_target(1 - static_cast<tensor_size_t>(ones % 2), 1);
+        return (ones % 2) ? "odd" : "even";
 }
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "task_mem_tensor.h"
+#include "task_synth.h"
 
 namespace nano
 {
@@ -13,18 +13,20 @@ namespace nano
         /// parameters:
         ///     n       - dimension of the input vectors
         ///     count   - number of samples (training + validation + test)
+        ///     seed    - seed of the random number generators (random if not given, the same seed generates the same samples)
         ///
-        class parity_task_t final : public mem_tensor_task_t
+        class parity_task_t final : public synth_task_t
         {
         public:
 
                 parity_task_t();
-                bool populate() override;
                 void to_json(json_t&) const final;
                 void from_json(const json_t&) final;
 
         private:
 
+                string_t generate(counter_rng_t&, counter_rng_t&, tensor3d_map_t, tensor3d_map_t) const final;
+
                 // attributes
                 tensor_size_t   m_dims{32};
                 size_t          m_folds{10};
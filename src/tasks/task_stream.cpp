@@ -0,0 +1,656 @@
+#include <tuple>
+#include <limits>
+#include <fcntl.h>
+#include <cstring>
+#include <numeric>
+#include <unistd.h>
+#include <stdexcept>
+#include <algorithm>
+#include <sys/mman.h>
+#if defined(__linux__)
+#include <sys/statvfs.h>
+#endif
+#include "task_stream.h"
+#include "core/random.h"
+#include "core/logger.h"
+#include "core/obstream.h"
+#include "core/mmap_ibstream.h"
+
+using namespace nano;
+
+static const uint64_t stream_magic = 0x6e616e6f7374726dULL;     ///< "nanostrm"
+static const uint32_t stream_version = 1;
+
+stream_task_t::stream_task_t() = default;
+
+stream_task_t::~stream_task_t()
+{
+        close();
+}
+
+void stream_task_t::to_json(json_t& json) const
+{
+        nano::to_json(json, "path", m_path, "shm", m_shm, "window", m_window, "readahead", m_readahead);
+}
+
+void stream_task_t::from_json(const json_t& json)
+{
+        nano::from_json(json, "path", m_path, "shm", m_shm, "window", m_window, "readahead", m_readahead);
+
+        m_window = std::max(m_window, size_t(1));
+        m_readahead = std::min(m_readahead, m_window - 1);
+}
+
+bool stream_task_t::write(const task_t& task, obstream_t& stream, const size_t bsize, const size_t max_bytes)
+{
+        const auto block_size = std::max(bsize, size_t(1));
+
+        // index the distinct samples in the order of their first occurrence
+        std::map<std::tuple<size_t, size_t, string_t>, uint32_t> ids;
+        std::map<string_t, uint32_t> label_ids;
+
+        strings_t labels;
+        tids sample_labels;
+        std::vector<size_t> ihashes, ohashes;
+        std::map<fold_t, tids> folds;
+
+        for (size_t f = 0; f < task.fsize(); ++ f)
+        {
+                for (const auto p : {protocol::train, protocol::valid, protocol::test})
+                {
+                        const auto fold = fold_t{f, p};
+                        auto& fids = folds[fold];
+                        for (size_t i = 0, size = task.size(fold); i < size; ++ i)
+                        {
+                                const auto ihash = task.ihash(fold, i);
+                                const auto ohash = task.ohash(fold, i);
+                                const auto label = task.label(fold, i);
+
+                                const auto itl = label_ids.emplace(label, static_cast<uint32_t>(labels.size()));
+                                if (itl.second)
+                                {
+                                        labels.push_back(label);
+                                }
+
+                                const auto its = ids.emplace(std::make_tuple(ihash, ohash, label), static_cast<uint32_t>(ihashes.size()));
+                                if (its.second)
+                                {
+                                        sample_labels.push_back(itl.first->second);
+                                        ihashes.push_back(ihash);
+                                        ohashes.push_back(ohash);
+                                }
+                                fids.push_back(its.first->second);
+                        }
+                }
+        }
+
+        // NB: the inputs and the targets are written as scalar_t (e.g. 4 or 8 bytes for each 8-bit pixel)
+        const auto isize = static_cast<std::streamsize>(nano::size(task.idims()) * sizeof(scalar_t));
+        const auto osize = static_cast<std::streamsize>(nano::size(task.odims()) * sizeof(scalar_t));
+
+        size_t bytes =
+                sizeof(stream_magic) + sizeof(stream_version) + sizeof(uint32_t) +
+                2 * sizeof(tensor3d_dim_t) + 5 * sizeof(size_t) +
+                ihashes.size() * (sizeof(uint32_t) + 2 * sizeof(size_t) + static_cast<size_t>(isize + osize));
+        for (const auto& label : labels)
+        {
+                bytes += sizeof(std::streamsize) + label.size();
+        }
+        for (const auto& fids : folds)
+        {
+                bytes += sizeof(fold_t) + sizeof(size_t) + fids.second.size() * sizeof(uint32_t);
+        }
+
+        if (bytes > max_bytes)
+        {
+                log_error() << "stream: the task needs " << bytes << " bytes, but only " << max_bytes << " are available!";
+                return false;
+        }
+
+        const auto write_array = [&] (const auto& array)
+        {
+                const auto size = static_cast<std::streamsize>(array.size() * sizeof(array[0]));
+                return stream.write(reinterpret_cast<const char*>(array.data()), size);
+        };
+
+        if (    !stream.write(stream_magic) ||
+                !stream.write(stream_version) ||
+                !stream.write(static_cast<uint32_t>(sizeof(scalar_t))) ||
+                !stream.write(task.idims()) ||
+                !stream.write(task.odims()) ||
+                !stream.write(task.fsize()) ||
+                !stream.write(ihashes.size()) ||
+                !stream.write(block_size) ||
+                !stream.write(labels.size()))
+        {
+                return false;
+        }
+
+        for (const auto& label : labels)
+        {
+                if (!stream.write(label))
+                {
+                        return false;
+                }
+        }
+
+        if (    !write_array(sample_labels) ||
+                !write_array(ihashes) ||
+                !write_array(ohashes) ||
+                !stream.write(folds.size()))
+        {
+                return false;
+        }
+
+        for (const auto& fids : folds)
+        {
+                if (    !stream.write(fids.first) ||
+                        !stream.write(fids.second.size()) ||
+                        !write_array(fids.second))
+                {
+                        return false;
+                }
+        }
+
+        // write the distinct samples (inputs and targets) in the same order
+        uint32_t next = 0;
+        for (const auto& fids : folds)
+        {
+                const auto& fold = fids.first;
+                for (size_t begin = 0, size = fids.second.size(); begin < size; begin += block_size)
+                {
+                        const auto end = std::min(begin + block_size, size);
+                        const auto minibatch = task.get(fold, begin, end);
+                        for (auto i = begin; i < end; ++ i)
+                        {
+                                if (fids.second[i] != next)
+                                {
+                                        assert(fids.second[i] < next);
+                                        continue;
+                                }
+
+                                const auto index = static_cast<tensor_size_t>(i - begin);
+                                if (    !stream.write(reinterpret_cast<const char*>(minibatch.idata(index).data()), isize) ||
+                                        !stream.write(reinterpret_cast<const char*>(minibatch.odata(index).data()), osize))
+                                {
+                                        return false;
+                                }
+                                ++ next;
+                        }
+                }
+        }
+
+        return next == ihashes.size();
+}
+
+bool stream_task_t::save(const task_t& task, const string_t& path, const size_t block_size)
+{
+        obstream_t stream(path);
+        return write(task, stream, block_size, std::numeric_limits<size_t>::max());
+}
+
+bool stream_task_t::publish(const task_t& task, const string_t& name, const size_t block_size)
+{
+#if defined(__linux__)
+        const auto fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0)
+        {
+                log_error() << "stream: failed to create the shared memory segment <" << name << ">!";
+                return false;
+        }
+
+        // NB: the segment is backed by memory (e.g. /dev/shm), so refuse tasks that don't fit in it
+        struct statvfs info;
+        const auto max_bytes = (::fstatvfs(fd, &info) == 0) ?
+                static_cast<size_t>(info.f_bavail) * static_cast<size_t>(info.f_frsize) :
+                std::numeric_limits<size_t>::max();
+
+        obstream_t stream(fd);
+        const auto ok = write(task, stream, block_size, max_bytes);
+        ::close(fd);
+
+        if (!ok)
+        {
+                log_error() << "stream: failed to write the shared memory segment <" << name << ">!";
+                unpublish(name);
+        }
+        return ok;
+#else
+        NANO_UNUSED1(task);
+        NANO_UNUSED1(block_size);
+        log_error() << "stream: cannot publish the shared memory segment <" << name << "> (supported only on Linux)!";
+        return false;
+#endif
+}
+
+bool stream_task_t::unpublish(const string_t& name)
+{
+        return ::shm_unlink(name.c_str()) == 0;
+}
+
+bool stream_task_t::load()
+{
+        close();
+
+        m_labels.clear();
+        m_label_ids.clear();
+        m_ihashes.clear();
+        m_ohashes.clear();
+        m_folds.clear();
+
+        // NB: the file is mapped only to read the header, while the shared memory segment is kept mapped
+        const auto& source = m_shm.empty() ? m_path : m_shm;
+        m_shared = std::make_unique<mmap_ibstream_t>(source, m_shm.empty() ? mmap_source::file : mmap_source::shm);
+
+        auto& stream = *m_shared;
+        if (!stream)
+        {
+                log_error() << "stream: failed to open <" << source << ">!";
+                return false;
+        }
+
+        const auto read_array = [&] (auto& array)
+        {
+                const auto size = static_cast<std::streamsize>(array.size() * sizeof(array[0]));
+                return stream.read(reinterpret_cast<char*>(array.data()), size) == size;
+        };
+
+        uint64_t magic = 0;
+        uint32_t version = 0, scalar_size = 0;
+        size_t labels = 0, folds = 0;
+        if (    !stream.read(magic) || magic != stream_magic ||
+                !stream.read(version) || version != stream_version ||
+                !stream.read(scalar_size) || scalar_size != sizeof(scalar_t) ||
+                !stream.read(m_idims) ||
+                !stream.read(m_odims) ||
+                !stream.read(m_fsize) ||
+                !stream.read(m_samples) ||
+                !stream.read(m_block_size) || m_block_size == 0 ||
+                !stream.read(labels))
+        {
+                log_error() << "stream: invalid header of <" << source << ">!";
+                return false;
+        }
+
+        m_labels.resize(labels);
+        for (auto& label : m_labels)
+        {
+                if (!stream.read(label))
+                {
+                        return false;
+                }
+        }
+
+        m_label_ids.resize(m_samples);
+        m_ihashes.resize(m_samples);
+        m_ohashes.resize(m_samples);
+        if (    !read_array(m_label_ids) ||
+                !read_array(m_ihashes) ||
+                !read_array(m_ohashes) ||
+                !stream.read(folds) ||
+                std::any_of(m_label_ids.begin(), m_label_ids.end(), [&] (const uint32_t id) { return id >= labels; }))
+        {
+                log_error() << "stream: invalid samples in <" << source << ">!";
+                return false;
+        }
+
+        for (size_t f = 0; f < folds; ++ f)
+        {
+                fold_t fold{0, protocol::train};
+                size_t count = 0;
+                if (!stream.read(fold) || !stream.read(count))
+                {
+                        return false;
+                }
+
+                auto& ids = m_folds[fold];
+                ids.resize(count);
+                if (    !read_array(ids) ||
+                        std::any_of(ids.begin(), ids.end(), [&] (const uint32_t id) { return id >= m_samples; }))
+                {
+                        log_error() << "stream: invalid folds in <" << source << ">!";
+                        return false;
+                }
+        }
+
+        // the samples are read by blocks from the rest of the file
+        const auto rsize = static_cast<size_t>(nano::size(m_idims) + nano::size(m_odims)) * sizeof(scalar_t);
+        m_offset = stream.tellg();
+        if (stream.remaining() != m_samples * rsize)
+        {
+                log_error() << "stream: invalid number of samples in <" << source << ">!";
+                return false;
+        }
+
+        if (!m_shm.empty())
+        {
+                log_info() << "stream: attached " << m_samples << " samples from the shared memory segment <" << m_shm << ">.";
+                return true;
+        }
+
+        m_shared.reset();
+
+        m_fd = ::open(m_path.c_str(), O_RDONLY);
+        if (m_fd < 0)
+        {
+                log_error() << "stream: failed to open file <" << m_path << ">!";
+                return false;
+        }
+
+        m_thread = std::thread([&] () { reader(); });
+
+        log_info() << "stream: mapped " << m_samples << " samples in blocks of " << m_block_size << " from <" << m_path << ">.";
+        return true;
+}
+
+void stream_task_t::close()
+{
+        {
+                const std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+        }
+        m_condition.notify_all();
+
+        if (m_thread.joinable())
+        {
+                m_thread.join();
+        }
+
+        if (m_fd >= 0)
+        {
+                ::close(m_fd);
+                m_fd = -1;
+        }
+
+        m_shared.reset();
+
+        m_blocks.clear();
+        m_lru.clear();
+        m_requests.clear();
+        m_pending.clear();
+        m_stop = false;
+}
+
+size_t stream_task_t::size() const
+{
+        return  std::accumulate(m_folds.begin(), m_folds.end(), size_t(0),
+                [&] (const size_t count, const auto& ids) { return count + ids.second.size(); });
+}
+
+size_t stream_task_t::size(const fold_t& fold) const
+{
+        const auto it = m_folds.find(fold);
+        assert(it != m_folds.end());
+        return it->second.size();
+}
+
+uint32_t stream_task_t::sample(const fold_t& fold, const size_t index) const
+{
+        const auto it = m_folds.find(fold);
+        assert(it != m_folds.end());
+        assert(index < it->second.size());
+        return it->second[index];
+}
+
+size_t stream_task_t::ihash(const fold_t& fold, const size_t index) const
+{
+        return m_ihashes[sample(fold, index)];
+}
+
+size_t stream_task_t::ohash(const fold_t& fold, const size_t index) const
+{
+        return m_ohashes[sample(fold, index)];
+}
+
+string_t stream_task_t::label(const fold_t& fold, const size_t index) const
+{
+        return m_labels[m_label_ids[sample(fold, index)]];
+}
+
+void stream_task_t::shuffle(const fold_t& fold) const
+{
+        const auto it = m_folds.find(fold);
+        assert(it != m_folds.end());
+        auto& ids = it->second;
+
+        auto rng = make_rng();
+        if (m_shared)
+        {
+                // the samples are accessed in place, so the order doesn't matter
+                std::shuffle(ids.begin(), ids.end(), rng);
+                return;
+        }
+
+        // shuffle the order of the blocks...
+        std::map<size_t, tids> blocks;
+        for (const auto id : ids)
+        {
+                blocks[id / m_block_size].push_back(id);
+        }
+
+        std::vector<const tids*> order;
+        for (const auto& block : blocks)
+        {
+                order.push_back(&block.second);
+        }
+        std::shuffle(order.begin(), order.end(), rng);
+
+        ids.clear();
+        for (const auto* block : order)
+        {
+                ids.insert(ids.end(), block->begin(), block->end());
+        }
+
+        // ... and then the samples within the window of blocks read ahead
+        const auto wsize = std::max(m_readahead, size_t(1)) * m_block_size;
+        for (size_t begin = 0; begin < ids.size(); begin += wsize)
+        {
+                const auto end = std::min(begin + wsize, ids.size());
+                std::shuffle(ids.begin() + static_cast<std::ptrdiff_t>(begin), ids.begin() + static_cast<std::ptrdiff_t>(end), rng);
+        }
+}
+
+minibatch_t stream_task_t::get(const fold_t& fold, const size_t begin, const size_t end) const
+{
+        assert(begin < end && end <= size(fold));
+
+        if (m_shared)
+        {
+                return get_shared(fold, begin, end);
+        }
+
+        const auto isize = nano::size(m_idims);
+        const auto osize = nano::size(m_odims);
+
+        // NB: the blocks are retrieved once per call to avoid locking for each sample
+        std::map<size_t, tblock> blocks;
+
+        minibatch_t minibatch(static_cast<tensor_size_t>(end - begin), m_idims, m_odims);
+        for (size_t index = begin; index < end; ++ index)
+        {
+                const auto id = sample(fold, index);
+                const auto bindex = id / m_block_size;
+
+                auto it = blocks.find(bindex);
+                if (it == blocks.end())
+                {
+                        it = blocks.emplace(bindex, block(bindex)).first;
+                }
+
+                const auto record = it->second->data() + (id - bindex * m_block_size) * static_cast<size_t>(isize + osize);
+                minibatch.copy(static_cast<tensor_size_t>(index - begin),
+                        map_tensor(record, m_idims), map_tensor(record + isize, m_odims), m_labels[m_label_ids[id]]);
+        }
+
+        readahead(fold, end);
+        return minibatch;
+}
+
+minibatch_t stream_task_t::get_shared(const fold_t& fold, const size_t begin, const size_t end) const
+{
+        const auto ibytes = static_cast<size_t>(nano::size(m_idims)) * sizeof(scalar_t);
+        const auto obytes = static_cast<size_t>(nano::size(m_odims)) * sizeof(scalar_t);
+
+        // NB: the records are copied as bytes, as they are not necessarily aligned in the segment
+        tensor3d_t target(m_odims);
+
+        minibatch_t minibatch(static_cast<tensor_size_t>(end - begin), m_idims, m_odims);
+        for (size_t index = begin; index < end; ++ index)
+        {
+                const auto id = sample(fold, index);
+                const auto record = m_shared->data() + m_offset + id * (ibytes + obytes);
+                const auto mindex = static_cast<tensor_size_t>(index - begin);
+
+                std::memcpy(minibatch.idata(mindex).data(), record, ibytes);
+                std::memcpy(target.data(), record + ibytes, obytes);
+                minibatch.copy(mindex, target, m_labels[m_label_ids[id]]);
+        }
+
+        return minibatch;
+}
+
+stream_task_t::tblock stream_task_t::block(const size_t index) const
+{
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+                const auto it = m_blocks.find(index);
+                if (it != m_blocks.end())
+                {
+                        m_lru.erase(std::find(m_lru.begin(), m_lru.end(), index));
+                        m_lru.push_back(index);
+                        return it->second;
+                }
+
+                if (std::find(m_pending.begin(), m_pending.end(), index) == m_pending.end())
+                {
+                        break;
+                }
+
+                // wait for the block being read (e.g. by the background thread)
+                m_condition.wait(lock);
+        }
+
+        m_pending.push_back(index);
+        lock.unlock();
+
+        const auto data = read(index);
+
+        lock.lock();
+        store(index, data);
+
+        if (!data)
+        {
+                throw std::runtime_error(strcat("stream: failed to read block ", index, " from <", m_path, ">"));
+        }
+        return data;
+}
+
+void stream_task_t::store(const size_t index, const tblock& data) const
+{
+        m_pending.erase(std::find(m_pending.begin(), m_pending.end(), index));
+        if (!data)
+        {
+                // NB: the failed blocks are not cached, so that they are read again the next time
+                m_condition.notify_all();
+                return;
+        }
+
+        m_blocks[index] = data;
+        m_lru.push_back(index);
+
+        // evict the least recently used blocks
+        while (m_blocks.size() > m_window)
+        {
+                m_blocks.erase(m_lru.front());
+                m_lru.pop_front();
+        }
+
+        m_condition.notify_all();
+}
+
+stream_task_t::tblock stream_task_t::read(const size_t index) const
+{
+        const auto rsize = static_cast<size_t>(nano::size(m_idims) + nano::size(m_odims));
+        const auto begin = index * m_block_size;
+        const auto count = std::min(m_block_size, m_samples - begin);
+
+        auto data = std::make_shared<std::vector<scalar_t>>(count * rsize);
+
+        auto bytes = data->size() * sizeof(scalar_t);
+        auto offset = static_cast<off_t>(m_offset + begin * rsize * sizeof(scalar_t));
+        auto buffer = reinterpret_cast<char*>(data->data());
+        while (bytes > 0)
+        {
+                const auto ret = ::pread(m_fd, buffer, bytes, offset);
+                if (ret <= 0)
+                {
+                        log_error() << "stream: failed to read block " << index << " from <" << m_path << ">!";
+                        return tblock();
+                }
+
+                bytes -= static_cast<size_t>(ret);
+                buffer += ret;
+                offset += ret;
+        }
+
+        return data;
+}
+
+void stream_task_t::readahead(const fold_t& fold, const size_t begin) const
+{
+        const auto it = m_folds.find(fold);
+        assert(it != m_folds.end());
+        const auto& ids = it->second;
+
+        const std::lock_guard<std::mutex> lock(m_mutex);
+
+        size_t requests = 0;
+        const auto end = std::min(begin + m_readahead * m_block_size, ids.size());
+        for (auto index = begin; index < end && requests < m_readahead; ++ index)
+        {
+                const auto bindex = ids[index] / m_block_size;
+                if (    m_blocks.find(bindex) == m_blocks.end() &&
+                        std::find(m_pending.begin(), m_pending.end(), bindex) == m_pending.end() &&
+                        std::find(m_requests.begin(), m_requests.end(), bindex) == m_requests.end())
+                {
+                        m_requests.push_back(bindex);
+                        ++ requests;
+                }
+        }
+
+        if (requests > 0)
+        {
+                m_condition.notify_all();
+        }
+}
+
+void stream_task_t::reader() const
+{
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+                m_condition.wait(lock, [&] () { return m_stop || !m_requests.empty(); });
+                if (m_stop)
+                {
+                        break;
+                }
+
+                const auto index = m_requests.front();
+                m_requests.pop_front();
+
+                if (    m_blocks.find(index) != m_blocks.end() ||
+                        std::find(m_pending.begin(), m_pending.end(), index) != m_pending.end())
+                {
+                        continue;
+                }
+
+                m_pending.push_back(index);
+                lock.unlock();
+
+                const auto data = read(index);
+
+                lock.lock();
+                store(index, data);
+        }
+}
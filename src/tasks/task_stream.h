@@ -0,0 +1,126 @@
+#pragma once
+
+#include <map>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <condition_variable>
+#include "task.h"
+
+namespace nano
+{
+        class obstream_t;
+        class mmap_ibstream_t;
+
+        ///
+        /// \brief out-of-core task streaming the samples from a binary file (see ::save to convert any task),
+        ///     so that datasets larger than the available memory can be used.
+        ///
+        /// parameters:
+        ///     path            - path to the binary file
+        ///     shm             - name of a shared memory segment with the same binary format (see ::publish) to use instead
+        ///     window          - maximum number of blocks of samples kept in memory
+        ///     readahead       - number of blocks read ahead by the background thread
+        ///
+        /// NB: only the labels, the hashes and the folds (as arrays of sample ids) are kept in memory.
+        /// NB: the samples are stored by blocks and the blocks following the requested ones are read ahead,
+        ///     so that the sequential sweeps over a fold (e.g. by the accumulator's threads) rarely wait for I/O.
+        /// NB: the samples are shuffled by block and then within a window of blocks to keep reading mostly sequentially.
+        /// NB: the minibatches requesting blocks that cannot be read from the file throw std::runtime_error.
+        /// NB: the samples of a shared memory segment are mapped read-only (and without any background thread),
+        ///     so that the concurrent processes training on the same host use a single copy of the dataset.
+        ///
+        class NANO_PUBLIC stream_task_t final : public task_t
+        {
+        public:
+
+                stream_task_t();
+                ~stream_task_t();
+
+                stream_task_t(const stream_task_t&) = delete;
+                stream_task_t& operator=(const stream_task_t&) = delete;
+
+                void to_json(json_t&) const final;
+                void from_json(const json_t&) final;
+
+                bool load() final;
+
+                tensor3d_dim_t idims() const final { return m_idims; }
+                tensor3d_dim_t odims() const final { return m_odims; }
+
+                size_t size() const final;
+                size_t size(const fold_t&) const final;
+                size_t fsize() const final { return m_fsize; }
+
+                size_t ihash(const fold_t&, const size_t index) const final;
+                size_t ohash(const fold_t&, const size_t index) const final;
+                string_t label(const fold_t&, const size_t index) const final;
+
+                void shuffle(const fold_t&) const final;
+                minibatch_t get(const fold_t&, const size_t begin, const size_t end) const final;
+
+                ///
+                /// \brief write the given (loaded) task to the binary format using blocks of the given number of samples
+                /// NB: the samples shared by several folds are written only once.
+                ///
+                static bool save(const task_t&, const string_t& path, const size_t block_size = 1024);
+
+                ///
+                /// \brief write the given (loaded) task to a new POSIX shared memory segment (e.g. "/name")
+                /// NB: the segment persists after the process exits until ::unpublish is called.
+                /// NB: publishing fails if the segment already exists.
+                /// NB: the segment has the binary format of ::save, so the inputs are stored as scalar_t values
+                ///     (e.g. 4 or 8 times the size of the 8-bit images) and the tasks not fitting in the available
+                ///     shared memory (e.g. /dev/shm) are refused.
+                /// NB: publishing is supported only on Linux (e.g. macOS cannot extend a segment by writing to it).
+                ///
+                static bool publish(const task_t&, const string_t& name, const size_t block_size = 1024);
+                static bool unpublish(const string_t& name);
+
+        private:
+
+                using tids = std::vector<uint32_t>;
+                using tblock = std::shared_ptr<const std::vector<scalar_t>>;
+
+                static bool write(const task_t&, obstream_t&, const size_t block_size, const size_t max_bytes);
+
+                void close();
+                minibatch_t get_shared(const fold_t&, const size_t begin, const size_t end) const;
+                uint32_t sample(const fold_t&, const size_t index) const;
+                tblock block(const size_t index) const;
+                tblock read(const size_t index) const;
+                void store(const size_t index, const tblock&) const;
+                void readahead(const fold_t&, const size_t begin) const;
+                void reader() const;
+
+                // attributes
+                string_t                        m_path;                 ///< path to the binary file
+                string_t                        m_shm;                  ///< name of the shared memory segment
+                size_t                          m_window{64};           ///< maximum number of blocks in memory
+                size_t                          m_readahead{8};         ///< number of blocks to read ahead
+
+                tensor3d_dim_t                  m_idims{{0, 0, 0}};     ///< input size
+                tensor3d_dim_t                  m_odims{{0, 0, 0}};     ///< output size
+                size_t                          m_fsize{0};             ///< number of folds
+                size_t                          m_samples{0};           ///< number of distinct samples
+                size_t                          m_block_size{0};        ///< number of samples / block
+                size_t                          m_offset{0};            ///< offset of the samples in the file
+                strings_t                       m_labels;               ///< distinct labels
+                tids                            m_label_ids;            ///< label id / sample
+                std::vector<size_t>             m_ihashes;              ///< input hash / sample
+                std::vector<size_t>             m_ohashes;              ///< output hash / sample
+                mutable std::map<fold_t, tids>  m_folds;                ///< sample ids / fold
+
+                std::unique_ptr<mmap_ibstream_t> m_shared;              ///< shared memory segment (if used)
+                int                             m_fd{-1};               ///< file descriptor (to read blocks concurrently)
+                mutable std::map<size_t, tblock> m_blocks;              ///< blocks in memory
+                mutable std::deque<size_t>      m_lru;                  ///< block indices in the order of use
+                mutable std::deque<size_t>      m_requests;             ///< block indices to read ahead
+                mutable std::vector<size_t>     m_pending;              ///< block indices being read
+                mutable std::mutex              m_mutex;                ///< synchronization
+                mutable std::condition_variable m_condition;            ///< signaling (new blocks or requests)
+                mutable bool                    m_stop{false};          ///< stop the background thread
+                std::thread                     m_thread;               ///< background thread reading ahead
+        };
+}
@@ -1,3 +1,4 @@
+#include <future>
 #include "core/mat5.h"
 #include "task_svhn.h"
 #include "core/color.h"
@@ -29,12 +30,19 @@ svhn_task_t::svhn_task_t() :
 void svhn_task_t::from_json(const json_t& json)
 {
         nano::from_json(json, "dir", m_dir, "folds", m_folds);
+        augment().from_json(json);
         reconfig(make_dims(3, 32, 32), make_dims(10, 1, 1), m_folds);
 }
 
 void svhn_task_t::to_json(json_t& json) const
 {
         nano::to_json(json, "dir", m_dir, "folds", m_folds);
+        augment().to_json(json);
+}
+
+strings_t svhn_task_t::sources() const
+{
+        return {m_dir + "/train_32x32.mat", m_dir + "/extra_32x32.mat", m_dir + "/test_32x32.mat"};
 }
 
 bool svhn_task_t::populate()
@@ -47,14 +55,34 @@ bool svhn_task_t::populate()
         const auto extra_count = size_t(531131);
         const auto test_count = size_t(26032);
 
-        reserve_chunks(train_count + extra_count + test_count);
+        // decode the files concurrently into their pre-allocated chunks
+        const auto train_begin = alloc_chunks(train_count);
+        const auto extra_begin = alloc_chunks(extra_count);
+        const auto test_begin = alloc_chunks(test_count);
+
+        ilabels_t train_ilabels, extra_ilabels, test_ilabels;
+        auto train_status = std::async(std::launch::async, [&] ()
+        {
+                return load_binary(train_file, train_begin, train_count, train_ilabels);
+        });
+        auto extra_status = std::async(std::launch::async, [&] ()
+        {
+                return load_binary(extra_file, extra_begin, extra_count, extra_ilabels);
+        });
+        const auto test_status = load_binary(test_file, test_begin, test_count, test_ilabels);
+        if (!train_status.get() || !extra_status.get() || !test_status)
+        {
+                return false;
+        }
 
-        return  load_binary(train_file, protocol::train, train_count) &&
-                load_binary(extra_file, protocol::train, extra_count) &&
-                load_binary(test_file, protocol::test, test_count);
+        // generate folds (in the same order as the files, so that the folds do not depend on the decoding order)
+        add_samples(protocol::train, train_begin, train_ilabels, tlabels);
+        add_samples(protocol::train, extra_begin, extra_ilabels, tlabels);
+        add_samples(protocol::test, test_begin, test_ilabels, tlabels);
+        return true;
 }
 
-bool svhn_task_t::load_binary(const string_t& path, const protocol p, const size_t count)
+bool svhn_task_t::load_binary(const string_t& path, const size_t chunk_begin, const size_t count, ilabels_t& ilabels)
 {
         log_info() << "SVHN: processing file <" << path << "> ...";
 
@@ -84,13 +112,13 @@ bool svhn_task_t::load_binary(const string_t& path, const protocol p, const size
                 case 0:         return section.matrix_meta(stream);
                 case 1:         return section.matrix_dims(stream, dims);
                 case 2:         return section.matrix_name(stream, name);
-                case 3:         return section.matrix_data(stream) && load_pixels(section, name, dims, count, stream);
+                case 3:         return section.matrix_data(stream) && load_pixels(section, name, dims, chunk_begin, count, stream);
 
                 // labels matrix section: {meta, dimensions, name, data} sub-elements
                 case 4:         return section.matrix_meta(stream);
                 case 5:         return section.matrix_dims(stream, dims);
                 case 6:         return section.matrix_name(stream, name);
-                case 7:         return section.matrix_data(stream) && load_labels(section, name, dims, p, count, stream);
+                case 7:         return section.matrix_data(stream) && load_labels(section, name, dims, count, ilabels, stream);
 
                 default:        log_error() << "SVHN: unexpected section!"; return false;
                 }
@@ -99,8 +127,8 @@ bool svhn_task_t::load_binary(const string_t& path, const protocol p, const size
         return load_mat5(path, hcallback, scallback, ecallback);
 }
 
-bool svhn_task_t::load_pixels(const mat5_section_t& section, const string_t& name, const dims_t& dims, const size_t count,
-        istream_t& stream)
+bool svhn_task_t::load_pixels(const mat5_section_t& section, const string_t& name, const dims_t& dims,
+        const size_t chunk_begin, const size_t count, istream_t& stream)
 {
         log_info() << "SVHN: loading images: name = " << name << ", size = " << join(dims, "x", "", "") << "...";
 
@@ -133,28 +161,29 @@ bool svhn_task_t::load_pixels(const mat5_section_t& section, const string_t& nam
                 return false;
         }
 
-        // load images
-        auto idata = make_buffer(ix);
-        for (tensor_size_t i = 0; i < n_samples; ++ i)
+        // load images (decode them in parallel)
+        const auto op = [&] (const char* idata, const size_t i)
         {
-                if (stream.read(idata.data(), ix) != ix)
-                {
-                        log_error() << "SVHN: failed to load image!";
-                        return false;
-                }
-
                 image_t image(irows, icols, color_mode::rgb);
-                image.plane(0) = nano::map_matrix(idata.data() + 0 * px, icols, irows).cast<luma_t>().transpose();
-                image.plane(1) = nano::map_matrix(idata.data() + 1 * px, icols, irows).cast<luma_t>().transpose();
-                image.plane(2) = nano::map_matrix(idata.data() + 2 * px, icols, irows).cast<luma_t>().transpose();
-                add_chunk(image, image.hash());
+                image.plane(0) = nano::map_matrix(idata + 0 * px, icols, irows).cast<luma_t>().transpose();
+                image.plane(1) = nano::map_matrix(idata + 1 * px, icols, irows).cast<luma_t>().transpose();
+                image.plane(2) = nano::map_matrix(idata + 2 * px, icols, irows).cast<luma_t>().transpose();
+                const auto hash = image.hash();
+                set_chunk(chunk_begin + i, std::move(image), hash);
+                return true;
+        };
+
+        if (!load_chunks(stream, count, ix, op))
+        {
+                log_error() << "SVHN: failed to load image!";
+                return false;
         }
 
         return stream.skip(section.m_dsize - n_samples * ix);
 }
 
 bool svhn_task_t::load_labels(const mat5_section_t& section,
-        const string_t& name, const dims_t& dims, const protocol p, const size_t count,
+        const string_t& name, const dims_t& dims, const size_t count, ilabels_t& ilabels,
         istream_t& stream)
 {
         log_info() << "SVHN: loading labels: name = " << name << ", size = " << join(dims, "x", "", "") << "...";
@@ -182,7 +211,6 @@ bool svhn_task_t::load_labels(const mat5_section_t& section,
         }
 
         // load labels
-        std::vector<tensor_size_t> ilabels;
         ilabels.reserve(count);
         for (size_t i = 0; i < count; ++ i)
         {
@@ -207,7 +235,5 @@ bool svhn_task_t::load_labels(const mat5_section_t& section,
                 ilabels.push_back(ilabel);
         }
 
-        // generage folds
-        add_samples(p, ilabels, tlabels);
         return stream.skip(section.m_dsize - n_samples);
 }
@@ -21,6 +21,7 @@ namespace nano
 
                 svhn_task_t();
                 bool populate() override;
+                strings_t sources() const override;
                 void to_json(json_t&) const final;
                 void from_json(const json_t&) final;
 
@@ -29,9 +30,13 @@ namespace nano
                 using dims_t = std::vector<int32_t>;
                 using protocols_t = std::vector<protocol>;
 
-                bool load_binary(const string_t& path, const protocol, const size_t count);
-                bool load_pixels(const mat5_section_t&, const string_t&, const dims_t&, const size_t count, istream_t&);
-                bool load_labels(const mat5_section_t&, const string_t&, const dims_t&, const protocol, const size_t count, istream_t&);
+                using ilabels_t = std::vector<tensor_size_t>;
+
+                bool load_binary(const string_t& path, const size_t chunk_begin, const size_t count, ilabels_t&);
+                bool load_pixels(const mat5_section_t&, const string_t&, const dims_t&,
+                        const size_t chunk_begin, const size_t count, istream_t&);
+                bool load_labels(const mat5_section_t&, const string_t&, const dims_t&,
+                        const size_t count, ilabels_t&, istream_t&);
 
                 // attributes
                 string_t                m_dir;          ///< directory where to load the task from
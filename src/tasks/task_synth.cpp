@@ -0,0 +1,157 @@
+#include "task_synth.h"
+#include "core/hash.h"
+
+using namespace nano;
+
+static const size_t train_percentage = 40;
+static const size_t valid_percentage = 30;
+
+///
+/// \brief keyed pseudo-random permutation of [0, size) (balanced Feistel network with cycle walking)
+///
+static uint64_t permute(const uint64_t key, const uint64_t size, uint64_t x)
+{
+        assert(x < size);
+
+        int bits = 2;
+        while (bits < 64 && (uint64_t(1) << bits) < size)
+        {
+                bits += 2;
+        }
+
+        const auto half = bits / 2;
+        const auto mask = (uint64_t(1) << half) - 1;
+        do
+        {
+                auto l = x >> half, r = x & mask;
+                for (uint64_t round = 0; round < 4; ++ round)
+                {
+                        const auto t = l ^ (counter_rng_t::key(key + round, r) & mask);
+                        l = r;
+                        r = t;
+                }
+                x = (l << half) | r;
+        }
+        while (x >= size);
+
+        return x;
+}
+
+synth_task_t::synth_task_t(const tensor3d_dim_t& idims, const tensor3d_dim_t& odims, const size_t count, const size_t fsize) :
+        m_idims(idims), m_odims(odims), m_count(count), m_fsize(fsize)
+{
+}
+
+uint64_t synth_task_t::make_seed()
+{
+        std::random_device rdev;
+        return (static_cast<uint64_t>(rdev()) << 32) ^ static_cast<uint64_t>(rdev());
+}
+
+void synth_task_t::reconfig(const tensor3d_dim_t& idims, const tensor3d_dim_t& odims,
+        const size_t count, const size_t fsize, const uint64_t seed)
+{
+        m_idims = idims;
+        m_odims = odims;
+        m_count = count;
+        m_fsize = fsize;
+        m_seed = seed;
+        m_shuffles.clear();
+}
+
+bool synth_task_t::load()
+{
+        counter_rng_t rng(counter_rng_t::key(m_seed, ~uint64_t(0)));
+        setup(rng);
+
+        m_shuffles.clear();
+        return m_count > 0 && m_fsize > 0;
+}
+
+size_t synth_task_t::size(const fold_t& fold) const
+{
+        assert(fold.m_index < m_fsize);
+
+        const auto train = m_count * train_percentage / 100;
+        const auto valid = m_count * valid_percentage / 100;
+        switch (fold.m_protocol)
+        {
+        case protocol::train:   return train;
+        case protocol::valid:   return valid;
+        case protocol::test:
+        default:                return m_count - train - valid;
+        }
+}
+
+size_t synth_task_t::sample_id(const fold_t& fold, const size_t index) const
+{
+        assert(index < size(fold));
+
+        // shuffle within the fold
+        auto position = index;
+        const auto it = m_shuffles.find(fold);
+        if (it != m_shuffles.end() && it->second != 0)
+        {
+                position = permute(it->second, size(fold), position);
+        }
+
+        if (fold.m_protocol != protocol::train)
+        {
+                position += size({fold.m_index, protocol::train});
+        }
+        if (fold.m_protocol == protocol::test)
+        {
+                position += size({fold.m_index, protocol::valid});
+        }
+
+        // split the samples per fold
+        return permute(counter_rng_t::key(m_seed, fold.m_index), m_count, position);
+}
+
+string_t synth_task_t::sample(const fold_t& fold, const size_t index, tensor3d_map_t input, tensor3d_map_t target) const
+{
+        const auto key = counter_rng_t::key(m_seed, sample_id(fold, index));
+
+        counter_rng_t irng(key);
+        counter_rng_t trng(counter_rng_t::key(key, fold.m_index));
+        return generate(irng, trng, input, target);
+}
+
+size_t synth_task_t::ihash(const fold_t& fold, const size_t index) const
+{
+        return counter_rng_t::key(m_seed, sample_id(fold, index));
+}
+
+size_t synth_task_t::ohash(const fold_t& fold, const size_t index) const
+{
+        tensor3d_t input(m_idims), target(m_odims);
+        sample(fold, index, input.tensor(), target.tensor());
+        return nano::hash_range(target.data(), target.data() + target.size());
+}
+
+string_t synth_task_t::label(const fold_t& fold, const size_t index) const
+{
+        tensor3d_t input(m_idims), target(m_odims);
+        return sample(fold, index, input.tensor(), target.tensor());
+}
+
+void synth_task_t::shuffle(const fold_t& fold) const
+{
+        auto rng = make_rng();
+        m_shuffles[fold] = counter_rng_t::key(rng(), rng()) | 1;
+}
+
+minibatch_t synth_task_t::get(const fold_t& fold, const size_t begin, const size_t end) const
+{
+        assert(begin < end && end <= size(fold));
+
+        tensor3d_t target(m_odims);
+        minibatch_t minibatch(static_cast<tensor_size_t>(end - begin), m_idims, m_odims);
+        for (size_t index = begin; index < end; ++ index)
+        {
+                const auto mindex = static_cast<tensor_size_t>(index - begin);
+                const auto label = sample(fold, index, minibatch.idata(mindex), target.tensor());
+                minibatch.copy(mindex, target, label);
+        }
+        return minibatch;
+}
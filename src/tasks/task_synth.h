@@ -0,0 +1,83 @@
+#pragma once
+
+#include <map>
+#include "task.h"
+#include "core/random.h"
+
+namespace nano
+{
+        ///
+        /// \brief synthetic task generating its samples on the fly (e.g. when building the minibatches):
+        ///     the input of the i-th sample is generated from a counter-based random number generator keyed by (seed, i)
+        ///     and its target (e.g. noise) from a generator keyed by (seed, i, fold),
+        ///     so that the memory usage doesn't depend on the number of samples and any size is reproducible.
+        ///
+        /// NB: the seed is drawn randomly for each task (as it was when sampling the data at loading),
+        ///     unless it is given explicitly in the configuration (e.g. to reproduce the samples of a previous run).
+        ///
+        /// NB: the samples are split per fold into training (40%), validation (30%) and test (30%) by a keyed permutation,
+        ///     while shuffling only changes the key of the permutation of the samples within the fold.
+        ///
+        class NANO_PUBLIC synth_task_t : public task_t
+        {
+        public:
+
+                synth_task_t(const tensor3d_dim_t& idims, const tensor3d_dim_t& odims, const size_t count, const size_t fsize);
+
+                bool load() final;
+
+                tensor3d_dim_t idims() const final { return m_idims; }
+                tensor3d_dim_t odims() const final { return m_odims; }
+
+                size_t size() const final { return m_count * m_fsize; }
+                size_t size(const fold_t&) const final;
+                size_t fsize() const final { return m_fsize; }
+
+                size_t ihash(const fold_t&, const size_t index) const final;
+                size_t ohash(const fold_t&, const size_t index) const final;
+                string_t label(const fold_t&, const size_t index) const final;
+
+                void shuffle(const fold_t&) const final;
+                minibatch_t get(const fold_t&, const size_t begin, const size_t end) const final;
+
+        protected:
+
+                ///
+                /// \brief draw a new random seed
+                ///
+                static uint64_t make_seed();
+
+                ///
+                /// \brief seed of all random number generators
+                ///
+                uint64_t seed() const { return m_seed; }
+
+                void reconfig(const tensor3d_dim_t& idims, const tensor3d_dim_t& odims,
+                        const size_t count, const size_t fsize, const uint64_t seed);
+
+                ///
+                /// \brief generate the parameters of the task (if any)
+                ///
+                virtual void setup(counter_rng_t&) {}
+
+                ///
+                /// \brief generate the input and the target of a sample using the given random number generators
+                /// \return the associated label (if any)
+                ///
+                virtual string_t generate(counter_rng_t& irng, counter_rng_t& trng,
+                        tensor3d_map_t input, tensor3d_map_t target) const = 0;
+
+        private:
+
+                size_t sample_id(const fold_t&, const size_t index) const;
+                string_t sample(const fold_t&, const size_t index, tensor3d_map_t input, tensor3d_map_t target) const;
+
+                // attributes
+                tensor3d_dim_t                  m_idims;                ///< input size
+                tensor3d_dim_t                  m_odims;                ///< output size
+                size_t                          m_count{0};             ///< number of samples / fold
+                size_t                          m_fsize{0};             ///< number of folds
+                uint64_t                        m_seed{make_seed()};    ///< seed of all random number generators
+                mutable std::map<fold_t, uint64_t> m_shuffles;          ///< key of the permutation / fold (0 - none)
+        };
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cassert>
+#include "tensor.h"
+
+namespace nano
+{
+        ///
+        /// \brief memory layout of the 4D tensors processed by the computation nodes.
+        ///
+        /// NB: the logical dimensions are always (count, maps, rows, cols),
+        ///     only the order in which the elements are stored in memory changes.
+        ///
+        enum class tensor_layout
+        {
+                nchw,                   ///< (count, maps, rows, cols): the feature planes are contiguous (default)
+                nhwc,                   ///< (count, rows, cols, maps): the features of a pixel are contiguous
+        };
+
+        ///
+        /// \brief map a sample of a 4D tensor stored as channels-last: (rows x cols, maps).
+        ///
+        template <typename ttensor>
+        auto nhwc_matrix(ttensor&& tensor, const tensor_size_t x)
+        {
+                const auto maps = tensor.template size<1>();
+                const auto rows = tensor.template size<2>();
+                const auto cols = tensor.template size<3>();
+                return map_matrix(tensor.data() + x * maps * rows * cols, rows * cols, maps);
+        }
+
+        ///
+        /// \brief map a sample of a 4D tensor stored as channels-first: (maps, rows x cols).
+        ///
+        template <typename ttensor>
+        auto nchw_matrix(ttensor&& tensor, const tensor_size_t x)
+        {
+                const auto maps = tensor.template size<1>();
+                const auto rows = tensor.template size<2>();
+                const auto cols = tensor.template size<3>();
+                return map_matrix(tensor.data() + x * maps * rows * cols, maps, rows * cols);
+        }
+
+        ///
+        /// \brief convert a 4D tensor from one memory layout to another.
+        ///
+        template <typename tisrc, typename todst>
+        void convert(const tisrc& src, const tensor_layout src_layout, todst&& dst, const tensor_layout dst_layout)
+        {
+                assert(src.dims() == dst.dims());
+
+                const auto count = src.template size<0>();
+                const auto rows = src.template size<2>();
+                const auto cols = src.template size<3>();
+
+                if (src_layout == dst_layout || rows * cols == 1)
+                {
+                        dst.vector() = src.vector();
+                }
+                else if (src_layout == tensor_layout::nchw)
+                {
+                        for (tensor_size_t x = 0; x < count; ++ x)
+                        {
+                                nhwc_matrix(dst, x).noalias() = nchw_matrix(src, x).transpose();
+                        }
+                }
+                else
+                {
+                        for (tensor_size_t x = 0; x < count; ++ x)
+                        {
+                                nchw_matrix(dst, x).noalias() = nhwc_matrix(src, x).transpose();
+                        }
+                }
+        }
+}
@@ -48,4 +48,64 @@ namespace nano
         {
                 return tresult(data, rows, cols);
         }
+
+        ///
+        /// \brief map non-constant data to matrices with a custom distance between consecutive rows
+        ///
+        template
+        <
+                typename tscalar_,
+                typename tsize,
+                typename tscalar = typename std::remove_const<tscalar_>::type,
+                typename tresult = Eigen::Map<tensor_matrix_t<tscalar>, Eigen::Unaligned, Eigen::OuterStride<>>
+        >
+        tresult map_matrix(tscalar_* data, const tsize rows, const tsize cols, const tsize stride)
+        {
+                return tresult(data, rows, cols, Eigen::OuterStride<>(stride));
+        }
+
+        ///
+        /// \brief map constant data to matrices with a custom distance between consecutive rows
+        ///
+        template
+        <
+                typename tscalar_,
+                typename tsize,
+                typename tscalar = typename std::remove_const<tscalar_>::type,
+                typename tresult = Eigen::Map<const tensor_matrix_t<tscalar>, Eigen::Unaligned, Eigen::OuterStride<>>
+        >
+        tresult map_matrix(const tscalar_* data, const tsize rows, const tsize cols, const tsize stride)
+        {
+                return tresult(data, rows, cols, Eigen::OuterStride<>(stride));
+        }
+
+        ///
+        /// \brief map non-constant data to matrices with custom distances between consecutive rows and columns
+        ///
+        template
+        <
+                typename tscalar_,
+                typename tsize,
+                typename tscalar = typename std::remove_const<tscalar_>::type,
+                typename tresult = Eigen::Map<tensor_matrix_t<tscalar>, Eigen::Unaligned, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>>
+        >
+        tresult map_matrix(tscalar_* data, const tsize rows, const tsize cols, const tsize rstride, const tsize cstride)
+        {
+                return tresult(data, rows, cols, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>(rstride, cstride));
+        }
+
+        ///
+        /// \brief map constant data to matrices with custom distances between consecutive rows and columns
+        ///
+        template
+        <
+                typename tscalar_,
+                typename tsize,
+                typename tscalar = typename std::remove_const<tscalar_>::type,
+                typename tresult = Eigen::Map<const tensor_matrix_t<tscalar>, Eigen::Unaligned, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>>
+        >
+        tresult map_matrix(const tscalar_* data, const tsize rows, const tsize cols, const tsize rstride, const tsize cstride)
+        {
+                return tresult(data, rows, cols, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>(rstride, cstride));
+        }
 }
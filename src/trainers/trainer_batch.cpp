@@ -55,20 +55,27 @@ static trainer_result_t train(const task_t& task, const size_t fold, accumulator
 
 void batch_trainer_t::from_json(const json_t& json)
 {
-        nano::from_json(json, "solver", m_solver, "epochs", m_epochs, "epsilon", m_epsilon, "patience", m_patience);
+        auto deterministic = m_deterministic ? 1 : 0;
+        nano::from_json(json, "solver", m_solver, "epochs", m_epochs, "epsilon", m_epsilon, "patience", m_patience,
+                "deterministic", deterministic, "pipeline", m_pipeline);
+        m_deterministic = deterministic != 0;
 }
 
 void batch_trainer_t::to_json(json_t& json) const
 {
         nano::to_json(json,
                 "solver", m_solver, "solvers", join(get_solvers().ids()),
-                "epochs", m_epochs, "epsilon", m_epsilon, "patience", m_patience);
+                "epochs", m_epochs, "epsilon", m_epsilon, "patience", m_patience,
+                "deterministic", m_deterministic ? 1 : 0, "pipeline", m_pipeline);
 }
 
 trainer_result_t batch_trainer_t::train(const task_t& task, const size_t fold, accumulator_t& acc) const
 {
         const timer_t timer;
 
+        acc.deterministic(m_deterministic);
+        acc.pipeline(m_pipeline);
+
         // todo: tune regulizer (L1, L2, ...)
         const auto solver = get_solvers().get(m_solver);
         const auto result = ::train(task, fold, acc, solver, m_epochs, m_epsilon, m_patience, timer);
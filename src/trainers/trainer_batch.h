@@ -25,5 +25,7 @@ namespace nano
                 size_t          m_epochs{1024};
                 size_t          m_patience{32};
                 scalar_t        m_epsilon{static_cast<scalar_t>(1e-6)};
+                bool            m_deterministic{false}; ///< reproducible results independent of the number of threads
+                size_t          m_pipeline{0};          ///< number of pipeline stages (data-parallel if less than two)
         };
 }
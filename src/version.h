@@ -0,0 +1,9 @@
+#pragma once
+
+namespace nano
+{
+        constexpr int minor_version = 4;
+        constexpr int major_version = 0;
+
+        constexpr const char* git_commit_hash = "39ecafebd88ff9c61a2b49e7011049d06ed4dc6f";
+}
@@ -2,9 +2,41 @@
 #include "builder.h"
 #include "accumulator.h"
 #include "core/numeric.h"
+#include "tasks/task_mem_vision.h"
 
 using namespace nano;
 
+///
+/// \brief small in-memory vision task with augmented training samples.
+///
+struct augmented_task_t final : public mem_vision_task_t
+{
+        augmented_task_t() :
+                mem_vision_task_t(color_mode::rgb, 8, 8, make_dims(2, 1, 1), 1)
+        {
+        }
+
+        void to_json(json_t& json) const final { augment().to_json(json); }
+        void from_json(const json_t& json) final { augment().from_json(json); }
+
+        bool populate() final
+        {
+                for (tensor_size_t i = 0; i < 16; ++ i)
+                {
+                        image_tensor_t data(3, 8, 8);
+                        data.vector().setRandom();
+
+                        image_t image;
+                        image.load(data);
+                        add_chunk(image, image.hash());
+
+                        const auto p = (i < 8) ? protocol::train : ((i < 12) ? protocol::valid : protocol::test);
+                        add_sample(fold_t{0, p}, static_cast<size_t>(i), class_target(i % 2, 2), (i % 2) ? "odd" : "even");
+                }
+                return true;
+        }
+};
+
 NANO_BEGIN_MODULE(test_accumulator)
 
 NANO_CASE(evaluate)
@@ -122,4 +154,243 @@ NANO_CASE(regularization)
         }
 }
 
+NANO_CASE(frozen)
+{
+        const auto task = get_tasks().get("synth-affine");
+        NANO_REQUIRE(task);
+        task->from_json(to_json("isize", 7, "osize", 3, "count", 64));
+        NANO_CHECK(task->load());
+
+        const auto omaps = std::get<0>(task->odims());
+        const auto orows = std::get<1>(task->odims());
+        const auto ocols = std::get<2>(task->odims());
+        const auto fold = fold_t{0, protocol::train};
+        const auto loss = get_losses().get("s-logistic");
+
+        model_t model;
+        NANO_CHECK(model.add(config_affine_node("1", 4, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("2", "act-snorm")));
+        NANO_CHECK(model.add(config_affine_node("3", omaps, orows, ocols)));
+        NANO_CHECK(model.connect("1", "2", "3"));
+        NANO_CHECK(model.done());
+
+        NANO_CHECK(model.resize(task->idims(), task->odims()));
+        model.random();
+
+        accumulator_t acc(model, *loss);
+        acc.mode(accumulator_t::type::vgrad);
+        acc.update(*task, fold);
+        const auto value = acc.value();
+        const vector_t vgrad = acc.vgrad();
+
+        // the outputs of the frozen prefix are cached and reused after shuffling the samples
+        NANO_REQUIRE(model.freeze({"1", "2"}));
+        NANO_REQUIRE(model.prefix_size() == 2);
+
+        const auto fsize = vgrad.size() - model.psize();
+        for (size_t bs = 1; bs <= 64; bs *= 4)
+        {
+                accumulator_t accx(model, *loss);
+                accx.mode(accumulator_t::type::vgrad);
+                accx.minibatch(bs);
+
+                for (auto epoch = 0; epoch < 2; ++ epoch)
+                {
+                        task->shuffle(fold);
+                        accx.clear();
+                        accx.update(*task, fold);
+
+                        NANO_CHECK_EQUAL(accx.vstats().count(), task->size(fold));
+                        NANO_CHECK_CLOSE(accx.value(), value, epsilon1<scalar_t>());
+                        NANO_CHECK_EIGEN_CLOSE(accx.vgrad(), vgrad.segment(fsize, model.psize()), epsilon1<scalar_t>());
+                }
+        }
+
+        // the cached outputs are not reused after reconfiguring the task (e.g. with other samples)
+        accumulator_t acc1(model, *loss), acc2(model, *loss);
+        acc1.mode(accumulator_t::type::value);
+        acc2.mode(accumulator_t::type::value);
+
+        task->from_json(to_json("isize", 7, "osize", 3, "count", 64, "seed", 1));
+        NANO_CHECK(task->load());
+        acc1.update(*task, fold);
+
+        task->from_json(to_json("isize", 7, "osize", 3, "count", 64, "seed", 2));
+        NANO_CHECK(task->load());
+        acc1.clear();
+        acc1.update(*task, fold);
+        acc2.update(*task, fold);
+        NANO_CHECK_CLOSE(acc1.value(), acc2.value(), epsilon1<scalar_t>());
+}
+
+NANO_CASE(frozen_augmented)
+{
+        augmented_task_t task;
+        task.from_json(to_json("crop", 2, "flip", 1, "jitter", 0.2));
+        NANO_CHECK(task.load());
+
+        const auto fold = fold_t{0, protocol::train};
+        const auto loss = get_losses().get("s-logistic");
+        NANO_CHECK(task.augmented(fold));
+        NANO_CHECK(!task.augmented(fold_t{0, protocol::valid}));
+
+        model_t model;
+        NANO_CHECK(model.add(config_affine_node("1", 4, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("2", "act-snorm")));
+        NANO_CHECK(model.add(config_affine_node("3", 2, 1, 1)));
+        NANO_CHECK(model.connect("1", "2", "3"));
+        NANO_CHECK(model.done());
+        NANO_CHECK(model.resize(task.idims(), task.odims()));
+        model.random();
+        NANO_REQUIRE(model.freeze({"1", "2"}));
+        NANO_REQUIRE(model.prefix_size() == 2);
+
+        accumulator_t acc(model, *loss);
+        acc.mode(accumulator_t::type::value);
+
+        // the same training sample is augmented differently each time (so its frozen outputs are not cached)
+        acc.update(task, fold, 0, 1);
+        const auto value1 = acc.value();
+        acc.clear();
+        acc.update(task, fold, 0, 1);
+        const auto value2 = acc.value();
+        NANO_CHECK_GREATER(std::fabs(value1 - value2), epsilon0<scalar_t>());
+
+        // ... but not without augmentation
+        task.from_json(to_json("crop", 0, "flip", 0, "jitter", 0));
+        NANO_CHECK(!task.augmented(fold));
+
+        acc.clear();
+        acc.update(task, fold, 0, 1);
+        const auto value3 = acc.value();
+        acc.clear();
+        acc.update(task, fold, 0, 1);
+        const auto value4 = acc.value();
+        NANO_CHECK_CLOSE(value3, value4, epsilon0<scalar_t>());
+}
+
+NANO_CASE(deterministic)
+{
+        const auto task = get_tasks().get("synth-affine");
+        NANO_REQUIRE(task);
+        task->from_json(to_json("isize", 7, "osize", 3, "count", 300));
+        NANO_CHECK(task->load());
+
+        const auto omaps = std::get<0>(task->odims());
+        const auto orows = std::get<1>(task->odims());
+        const auto ocols = std::get<2>(task->odims());
+        const auto fold = fold_t{0, protocol::train};
+        const auto loss = get_losses().get("s-logistic");
+
+        model_t model;
+        NANO_CHECK(model.add(config_affine_node("1", 8, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("2", "act-snorm")));
+        NANO_CHECK(model.add(config_affine_node("3", 8, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("4", "act-snorm")));
+        NANO_CHECK(model.add(config_affine_node("5", omaps, orows, ocols)));
+        NANO_CHECK(model.connect("1", "2", "3", "4", "5"));
+        NANO_CHECK(model.done());
+
+        NANO_CHECK(model.resize(task->idims(), task->odims()));
+        model.random();
+
+        accumulator_t acc(model, *loss);
+        acc.mode(accumulator_t::type::vgrad);
+        acc.update(*task, fold);
+        const auto value = acc.value();
+        const vector_t vgrad = acc.vgrad();
+
+        for (const size_t bs : {1, 3, 32})
+        {
+                accumulator_t acc0(model, *loss);
+                acc0.mode(accumulator_t::type::vgrad);
+                acc0.minibatch(bs);
+                acc0.deterministic();
+                acc0.update(*task, fold);
+
+                NANO_CHECK_EQUAL(acc0.vstats().count(), task->size(fold));
+                NANO_CHECK_CLOSE(acc0.value(), value, epsilon1<scalar_t>());
+                NANO_CHECK_EIGEN_CLOSE(acc0.vgrad(), vgrad, epsilon1<scalar_t>());
+
+                // the results should be bitwise reproducible, independent of the number of threads
+                for (const size_t threads : {1, 2, 3, 8})
+                {
+                        accumulator_t accx(model, *loss);
+                        accx.mode(accumulator_t::type::vgrad);
+                        accx.minibatch(bs);
+                        accx.threads(threads);
+                        accx.deterministic();
+                        accx.update(*task, fold);
+
+                        NANO_CHECK_EQUAL(accx.vstats().count(), task->size(fold));
+                        NANO_CHECK_EQUAL(accx.value(), acc0.value());
+                        NANO_CHECK(accx.vgrad() == acc0.vgrad());
+                }
+        }
+}
+
+NANO_CASE(pipeline)
+{
+        const auto task = get_tasks().get("synth-affine");
+        NANO_REQUIRE(task);
+        task->from_json(to_json("isize", 7, "osize", 3, "count", 64));
+        NANO_CHECK(task->load());
+
+        const auto omaps = std::get<0>(task->odims());
+        const auto orows = std::get<1>(task->odims());
+        const auto ocols = std::get<2>(task->odims());
+        const auto fold = fold_t{0, protocol::train};
+        const auto loss = get_losses().get("s-logistic");
+
+        model_t model;
+        NANO_CHECK(model.add(config_affine_node("1", 8, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("2", "act-snorm")));
+        NANO_CHECK(model.add(config_affine_node("3", 8, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("4", "act-snorm")));
+        NANO_CHECK(model.add(config_affine_node("5", 8, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("6", "act-snorm")));
+        NANO_CHECK(model.add(config_affine_node("7", omaps, orows, ocols)));
+        NANO_CHECK(model.connect("1", "2", "3", "4", "5", "6", "7"));
+        NANO_CHECK(model.done());
+
+        NANO_CHECK(model.resize(task->idims(), task->odims()));
+        model.random();
+
+        for (const auto& frozen : {strings_t{}, strings_t{"1", "2"}})
+        {
+                NANO_REQUIRE(model.freeze(frozen));
+
+                accumulator_t acc(model, *loss);
+                acc.mode(accumulator_t::type::vgrad);
+                acc.update(*task, fold);
+                const auto value = acc.value();
+                const vector_t vgrad = acc.vgrad();
+
+                // the micro-batches flowing through the stages should produce the same results
+                for (size_t stages = 2; stages <= 4; ++ stages)
+                {
+                        for (const size_t bs : {1, 7, 64})
+                        {
+                                accumulator_t accx(model, *loss);
+                                accx.mode(accumulator_t::type::vgrad);
+                                accx.minibatch(bs);
+                                accx.pipeline(stages);
+                                accx.update(*task, fold);
+
+                                NANO_CHECK_EQUAL(accx.vstats().count(), task->size(fold));
+                                NANO_CHECK_CLOSE(accx.value(), value, epsilon1<scalar_t>());
+                                NANO_CHECK_EIGEN_CLOSE(accx.vgrad(), vgrad, epsilon1<scalar_t>());
+
+                                // the pipeline can be disabled
+                                accx.pipeline(0);
+                                accx.update(*task, fold);
+
+                                NANO_CHECK_EQUAL(accx.vstats().count(), task->size(fold));
+                                NANO_CHECK_CLOSE(accx.value(), value, epsilon1<scalar_t>());
+                                NANO_CHECK_EIGEN_CLOSE(accx.vgrad(), vgrad, epsilon1<scalar_t>());
+                        }
+                }
+        }
+}
+
 NANO_END_MODULE()
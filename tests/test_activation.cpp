@@ -0,0 +1,117 @@
+#include "utest.h"
+#include "core/numeric.h"
+#include "layers/layer_activation.h"
+
+using namespace nano;
+
+static auto make_inputs()
+{
+        const auto size = tensor_size_t(100001);
+        const auto xmin = scalar_t(-30), xmax = scalar_t(+30);
+
+        vector_t inputs(size);
+        for (tensor_size_t i = 0; i < size; ++ i)
+        {
+                inputs(i) = xmin + (xmax - xmin) * static_cast<scalar_t>(i) / static_cast<scalar_t>(size - 1);
+        }
+        return inputs;
+}
+
+static auto make_epsilon()
+{
+        return std::max(scalar_t(1e-6), epsilon2<scalar_t>());
+}
+
+template <typename top, typename tfastop>
+static scalar_t output_error()
+{
+        const auto idata = make_inputs();
+
+        vector_t odata(idata.size()), fodata(idata.size());
+        top::output(idata.array(), odata.array());
+        tfastop::output(idata.array(), fodata.array());
+
+        return (odata - fodata).lpNorm<Eigen::Infinity>();
+}
+
+template <typename top, typename tfastop>
+static scalar_t ginput_error()
+{
+        const auto idata = make_inputs();
+
+        vector_t odata(idata.size());
+        odata.setRandom();
+
+        vector_t gidata = idata, fgidata = idata;
+        top::ginput(gidata.array(), odata.array());
+        tfastop::ginput(fgidata.array(), odata.array());
+
+        return (gidata - fgidata).lpNorm<Eigen::Infinity>();
+}
+
+NANO_BEGIN_MODULE(test_activation)
+
+NANO_CASE(tanh)
+{
+        NANO_CHECK_LESS((output_error<activation_tanh_t, activation_fast_tanh_t>()), make_epsilon());
+        NANO_CHECK_LESS((ginput_error<activation_tanh_t, activation_fast_tanh_t>()), make_epsilon());
+}
+
+NANO_CASE(sigm)
+{
+        NANO_CHECK_LESS((output_error<activation_sigm_t, activation_fast_sigm_t>()), make_epsilon());
+        NANO_CHECK_LESS((ginput_error<activation_sigm_t, activation_fast_sigm_t>()), make_epsilon());
+}
+
+NANO_CASE(splus)
+{
+        NANO_CHECK_LESS((output_error<activation_splus_t, activation_fast_splus_t>()), make_epsilon());
+        NANO_CHECK_LESS((ginput_error<activation_splus_t, activation_fast_splus_t>()), make_epsilon());
+}
+
+NANO_CASE(saturation)
+{
+        vector_t idata(4), odata(4);
+        idata << scalar_t(-1e+4), scalar_t(-100), scalar_t(+100), scalar_t(+1e+4);
+
+        activation_fast_tanh_t::output(idata.array(), odata.array());
+        NANO_CHECK(odata.array().isFinite().all());
+        NANO_CHECK_LESS((odata.array().abs() - 1).abs().maxCoeff(), make_epsilon());
+
+        activation_fast_sigm_t::output(idata.array(), odata.array());
+        NANO_CHECK(odata.array().isFinite().all());
+        NANO_CHECK_LESS(std::fabs(odata(0)), make_epsilon());
+        NANO_CHECK_LESS(std::fabs(odata(3) - 1), make_epsilon());
+
+        activation_fast_splus_t::output(idata.array(), odata.array());
+        NANO_CHECK(odata.array().isFinite().all());
+        NANO_CHECK_LESS(std::fabs(odata(0)), make_epsilon());
+        NANO_CHECK_LESS(std::fabs(odata(3) - idata(3)), make_epsilon());
+}
+
+NANO_CASE(config)
+{
+        const auto check = [&] (layer_t&& layer, const bool has_fast)
+        {
+                json_t json;
+                layer.to_json(json);
+                NANO_CHECK_EQUAL(json.count("fast"), size_t(0));
+
+                layer.from_json(to_json("fast", 1));
+
+                json = json_t();
+                layer.to_json(json);
+                NANO_CHECK_EQUAL(json.count("fast"), has_fast ? size_t(1) : size_t(0));
+        };
+
+        check(activation_layer_tanh_t(), true);
+        check(activation_layer_sigm_t(), true);
+        check(activation_layer_splus_t(), true);
+        check(activation_layer_unit_t(), false);
+        check(activation_layer_sine_t(), false);
+        check(activation_layer_snorm_t(), false);
+        check(activation_layer_ssign_t(), false);
+        check(activation_layer_pwave_t(), false);
+}
+
+NANO_END_MODULE()
@@ -2,6 +2,7 @@
 #include "function.h"
 #include "layers/conv3d.h"
 #include "layers/conv4d.h"
+#include "tensor/layout.h"
 
 using namespace nano;
 
@@ -152,7 +153,7 @@ NANO_CASE(params_invalid)
 
 NANO_CASE(gparam_accuracy)
 {
-        for (const auto kconn : {1, 2, 3})
+        for (const auto kconn : {1, 2, 3, 6})
         for (const auto drows : {1, 2})
         for (const auto dcols : {1, 2})
         {
@@ -168,7 +169,7 @@ NANO_CASE(gparam_accuracy)
 
 NANO_CASE(ginput_accuracy)
 {
-        for (const auto kconn : {1, 2, 3})
+        for (const auto kconn : {1, 2, 3, 6})
         for (const auto drows : {1, 2})
         for (const auto dcols : {1, 2})
         {
@@ -184,7 +185,7 @@ NANO_CASE(ginput_accuracy)
 
 NANO_CASE(3d_vs_4d_output)
 {
-        for (const auto kconn : {1, 2, 3})
+        for (const auto kconn : {1, 2, 3, 6})
         for (const auto drows : {1, 2})
         for (const auto dcols : {1, 2})
         {
@@ -212,7 +213,7 @@ NANO_CASE(3d_vs_4d_output)
 
 NANO_CASE(3d_vs_4d_gparam)
 {
-        for (const auto kconn : {1, 2, 3})
+        for (const auto kconn : {1, 2, 3, 6})
         for (const auto drows : {1, 2})
         for (const auto dcols : {1, 2})
         {
@@ -242,7 +243,7 @@ NANO_CASE(3d_vs_4d_gparam)
 
 NANO_CASE(3d_vs_4d_ginput)
 {
-        for (const auto kconn : {1, 2, 3})
+        for (const auto kconn : {1, 2, 3, 6})
         for (const auto drows : {1, 2})
         for (const auto dcols : {1, 2})
         {
@@ -269,4 +270,106 @@ NANO_CASE(3d_vs_4d_ginput)
         }
 }
 
+NANO_CASE(nchw_vs_nhwc_output)
+{
+        for (const auto kconn : {1, 2, 3, 6})
+        for (const auto drows : {1, 2})
+        for (const auto dcols : {1, 2})
+        {
+                const auto params = make_default_params(kconn, drows, dcols);
+                NANO_REQUIRE(params.valid());
+
+                auto op3d = conv3d_t{params};
+                auto op4d = conv4d_t{params, tensor_layout::nhwc};
+
+                for (int i = 0; i < 3; ++ i)
+                {
+                        tensor4d_t idata, kdata, odata, idata4, odata4;
+                        vector_t bdata;
+
+                        std::tie(bdata, idata, kdata, odata) = make_buffers(params, i + 2);
+                        idata4 = idata; odata4 = odata;
+
+                        convert(idata, tensor_layout::nchw, idata4, tensor_layout::nhwc);
+
+                        op3d.output(idata, kdata, bdata, odata);
+                        op4d.output(idata4, kdata, bdata, odata4);
+
+                        convert(tensor4d_t{odata4}, tensor_layout::nhwc, odata4, tensor_layout::nchw);
+
+                        NANO_CHECK_EIGEN_CLOSE(odata.array(), odata4.array(), epsilon1<scalar_t>());
+                }
+        }
+}
+
+NANO_CASE(nchw_vs_nhwc_gparam)
+{
+        for (const auto kconn : {1, 2, 3, 6})
+        for (const auto drows : {1, 2})
+        for (const auto dcols : {1, 2})
+        {
+                const auto params = make_default_params(kconn, drows, dcols);
+                NANO_REQUIRE(params.valid());
+
+                auto op3d = conv3d_t{params};
+                auto op4d = conv4d_t{params, tensor_layout::nhwc};
+
+                for (int i = 0; i < 3; ++ i)
+                {
+                        tensor4d_t idata, kdata3, kdata4, odata, idata4, odata4;
+                        vector_t bdata3, bdata4;
+
+                        std::tie(bdata3, idata, kdata3, odata) = make_buffers(params, i + 2);
+                        std::tie(bdata4, idata, kdata4, odata) = make_buffers(params, i + 2);
+                        idata4 = idata; odata4 = odata;
+
+                        convert(idata, tensor_layout::nchw, idata4, tensor_layout::nhwc);
+
+                        op4d.output(idata4, kdata4, bdata4, odata4);// NB: needed to update the internal buffers!
+                        convert(odata4, tensor_layout::nhwc, odata, tensor_layout::nchw);
+
+                        op3d.gparam(idata, kdata3, bdata3, odata);
+                        op4d.gparam(idata4, kdata4, bdata4, odata4);
+
+                        NANO_CHECK_EIGEN_CLOSE(bdata3.array(), bdata4.array(), epsilon1<scalar_t>());
+                        NANO_CHECK_EIGEN_CLOSE(kdata3.array(), kdata4.array(), epsilon1<scalar_t>());
+                }
+        }
+}
+
+NANO_CASE(nchw_vs_nhwc_ginput)
+{
+        for (const auto kconn : {1, 2, 3, 6})
+        for (const auto drows : {1, 2})
+        for (const auto dcols : {1, 2})
+        {
+                const auto params = make_default_params(kconn, drows, dcols);
+                NANO_REQUIRE(params.valid());
+
+                auto op3d = conv3d_t{params};
+                auto op4d = conv4d_t{params, tensor_layout::nhwc};
+
+                for (int i = 0; i < 3; ++ i)
+                {
+                        tensor4d_t idata, kdata, odata, idata4, odata4;
+                        vector_t bdata;
+
+                        std::tie(bdata, idata, kdata, odata) = make_buffers(params, i + 2);
+                        idata4 = idata; odata4 = odata;
+
+                        convert(idata, tensor_layout::nchw, idata4, tensor_layout::nhwc);
+
+                        op4d.output(idata4, kdata, bdata, odata4);// NB: needed to update the internal buffers!
+                        convert(odata4, tensor_layout::nhwc, odata, tensor_layout::nchw);
+
+                        op3d.ginput(idata, kdata, bdata, odata);
+                        op4d.ginput(idata4, kdata, bdata, odata4);
+
+                        convert(tensor4d_t{idata4}, tensor_layout::nhwc, idata4, tensor_layout::nchw);
+
+                        NANO_CHECK_EIGEN_CLOSE(idata.array(), idata4.array(), epsilon1<scalar_t>());
+                }
+        }
+}
+
 NANO_END_MODULE()
@@ -0,0 +1,53 @@
+#include "utest.h"
+#include "core/hash.h"
+#include <vector>
+#include <string>
+
+using namespace nano;
+
+NANO_BEGIN_MODULE(test_core_hash)
+
+NANO_CASE(hash_bytes)
+{
+        const auto hash = [] (const std::string& str, const uint64_t seed = 0)
+        {
+                return hash_bytes(str.data(), str.size(), seed);
+        };
+
+        // reference 64-bit xxHash values
+        NANO_CHECK_EQUAL(hash(""), 0xEF46DB3751D8E999ULL);
+        NANO_CHECK_EQUAL(hash("a"), 0xD24EC4F1A98C6E5BULL);
+        NANO_CHECK_EQUAL(hash("abc"), 0x44BC2CF5AD770999ULL);
+        NANO_CHECK_EQUAL(hash("Nobody inspects the spammish repetition"), 0xFBCEA83C8A378BF1ULL);
+
+        NANO_CHECK_NOT_EQUAL(hash("abc", 0), hash("abc", 1));
+}
+
+NANO_CASE(hash_range)
+{
+        std::vector<float> values(1027);
+        for (size_t i = 0; i < values.size(); ++ i)
+        {
+                values[i] = static_cast<float>(i) * 0.5f;
+        }
+
+        const auto* begin = values.data();
+        const auto* end = values.data() + values.size();
+
+        // contiguous arithmetic values are hashed as bytes
+        const auto hash0 = nano::hash_range(begin, end);
+        NANO_CHECK_EQUAL(hash0, hash_bytes(begin, values.size() * sizeof(float)));
+        NANO_CHECK_EQUAL(hash0, nano::hash_range(values.data(), values.data() + values.size()));
+
+        // any change in any position changes the hash
+        for (const auto index : {size_t(0), size_t(31), size_t(32), size_t(1000), size_t(1026)})
+        {
+                auto changed = values;
+                changed[index] += 1;
+                NANO_CHECK_NOT_EQUAL(hash0, nano::hash_range(changed.data(), changed.data() + changed.size()));
+        }
+
+        NANO_CHECK_NOT_EQUAL(hash0, nano::hash_range(begin, end - 1));
+}
+
+NANO_END_MODULE()
@@ -112,6 +112,33 @@ NANO_CASE(io_tensor)
         }
 }
 
+NANO_CASE(io_tensor_map)
+{
+        auto rng = make_rng();
+        auto udist = make_udist<coord_t>(16, 64);
+        auto udist_luma = make_udist<int>(0, 255);
+
+        const auto rows = udist(rng);
+        const auto cols = udist(rng);
+
+        image_t image(rows, cols, color_mode::rgba);
+        for (auto i = 0; i < image.dims(); ++ i)
+        {
+                image.plane(i) = image.plane(i).unaryExpr([&] (const luma_t) { return static_cast<luma_t>(udist_luma(rng)); });
+        }
+
+        // the whole image written in place (e.g. in a minibatch)
+        tensor4d_t idata(2, image.dims(), rows, cols);
+        image.to_tensor(idata.tensor(1));
+        NANO_CHECK_EIGEN_CLOSE(idata.vector(1), image.to_tensor().vector(), epsilon0<scalar_t>());
+
+        // a region written in place
+        const auto region = rect_t(3, 5, cols - 7, rows - 9);
+        tensor4d_t rdata(2, image.dims(), region.height(), region.width());
+        image.to_tensor(region, rdata.tensor(0));
+        NANO_CHECK_EIGEN_CLOSE(rdata.vector(0), image.to_tensor(region).vector(), epsilon0<scalar_t>());
+}
+
 NANO_CASE(io_luma)
 {
         auto rng = make_rng();
@@ -9,6 +9,8 @@
 #include "core/istream_std.h"
 #include <cstdio>
 #include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace nano;
 
@@ -162,6 +164,33 @@ NANO_CASE(bstream)
                 NANO_CHECK(ob.write_tensor(var_tensor));
         }
 
+        // check writing to a file descriptor (same binary format)
+        const std::string fd_path = "bstream.fd.test";
+        {
+                const auto fd = ::open(fd_path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+                NANO_REQUIRE(fd >= 0);
+
+                obstream_t ob(fd);
+
+                NANO_CHECK(ob.write(var_double));
+                NANO_CHECK(ob.write(var_string));
+                NANO_CHECK(ob.write(var_float));
+                NANO_CHECK(ob.write(var_int));
+                NANO_CHECK(ob.write(var_size_t));
+                NANO_CHECK(ob.write(var_struct));
+                NANO_CHECK(ob.write_vector(var_vector));
+                NANO_CHECK(ob.write_matrix(var_matrix));
+                NANO_CHECK(ob.write_tensor(var_tensor));
+
+                ::close(fd);
+        }
+        {
+                std::ifstream stream1(path, std::ios::binary), stream2(fd_path, std::ios::binary);
+                const auto bytes1 = std::string(std::istreambuf_iterator<char>(stream1), std::istreambuf_iterator<char>());
+                const auto bytes2 = std::string(std::istreambuf_iterator<char>(stream2), std::istreambuf_iterator<char>());
+                NANO_CHECK(bytes1 == bytes2);
+        }
+
         // check reading
         {
                 ibstream_t ib(path);
@@ -207,6 +236,7 @@ NANO_CASE(bstream)
 
         // cleanup
         std::remove(path.c_str());
+        std::remove(fd_path.c_str());
 }
 
 NANO_END_MODULE()
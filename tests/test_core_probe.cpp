@@ -0,0 +1,63 @@
+#include "utest.h"
+#include "core/probe.h"
+
+using namespace nano;
+
+NANO_BEGIN_MODULE(test_core_probe)
+
+NANO_CASE(modes)
+{
+        const auto old_mode = probe_t::mode();
+        const auto old_period = probe_t::period();
+
+        for (const auto mode : enum_values<probe_mode>())
+        {
+                probe_t::mode(mode);
+                probe_t::period(4);
+                NANO_CHECK(probe_t::mode() == mode);
+                NANO_CHECK_EQUAL(probe_t::period(), int64_t(4));
+
+                // the operation should always be called, but measured only depending on the mode
+                probe_t probe("probe", "probe(op)", 1);
+
+                size_t calls = 0;
+                for (size_t i = 0; i < 10; ++ i)
+                {
+                        probe.measure([&] () { ++ calls; }, 2);
+                }
+
+                NANO_CHECK_EQUAL(calls, size_t(10));
+                switch (mode)
+                {
+                case probe_mode::off:           NANO_CHECK_EQUAL(probe.timings().count(), size_t(0)); break;
+                case probe_mode::sampled:       NANO_CHECK_EQUAL(probe.timings().count(), size_t(3)); break;
+                default:                        NANO_CHECK_EQUAL(probe.timings().count(), size_t(10)); break;
+                }
+        }
+
+        probe_t::mode(old_mode);
+        probe_t::period(old_period);
+}
+
+NANO_CASE(tsc)
+{
+        probe_t::mode(probe_mode::tsc);
+
+        // the time-stamp counter should be calibrated to nanoseconds
+        probe_t probe;
+        probe.measure([&] ()
+        {
+                const nano::timer_t timer;
+                while (timer.microseconds().count() < 2000)
+                {
+                }
+        });
+
+        probe_t::mode(probe_mode::precise);
+
+        NANO_CHECK_EQUAL(probe.timings().count(), size_t(1));
+        NANO_CHECK_GREATER_EQUAL(probe.timings().min(), int64_t(1000 * 1000));
+        NANO_CHECK_LESS_EQUAL(probe.timings().max(), int64_t(1000 * 1000 * 1000));
+}
+
+NANO_END_MODULE()
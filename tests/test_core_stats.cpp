@@ -84,4 +84,37 @@ NANO_CASE(random)
         NANO_CHECK_CLOSE(stats.var(), (sum2 - sum1 * sum1 / count) / count, 1e-12);
 }
 
+NANO_CASE(contiguous)
+{
+        auto rng = make_rng();
+        auto udist = make_udist<double>(-3.0, +5.0);
+
+        for (const size_t count : {1, 7, 8, 9, 255, 256, 257, 1000})
+        {
+                std::vector<double> values(count);
+                for (auto& value : values)
+                {
+                        value = udist(rng);
+                }
+
+                // the vectorized update of a contiguous range should match the update of each value
+                stats_t<double> stats1;
+                for (const auto value : values)
+                {
+                        stats1(value);
+                }
+
+                stats_t<double> stats2;
+                stats2(values.data(), values.data() + values.size());
+
+                NANO_CHECK_EQUAL(stats2.count(), stats1.count());
+                NANO_CHECK_EQUAL(stats2.min(), stats1.min());
+                NANO_CHECK_EQUAL(stats2.max(), stats1.max());
+                NANO_CHECK_CLOSE(stats2.sum1(), stats1.sum1(), 1e-12);
+                NANO_CHECK_CLOSE(stats2.sum2(), stats1.sum2(), 1e-12);
+                NANO_CHECK_CLOSE(stats2.avg(), stats1.avg(), 1e-12);
+                NANO_CHECK_CLOSE(stats2.stdev(), stats1.stdev(), 1e-12);
+        }
+}
+
 NANO_END_MODULE()
@@ -1,5 +1,6 @@
 #include "utest.h"
 #include <numeric>
+#include <stdexcept>
 #include "core/tpool.h"
 #include "core/random.h"
 
@@ -120,4 +121,22 @@ NANO_CASE(evaluate)
         }
 }
 
+NANO_CASE(exception)
+{
+        std::atomic<size_t> count{0};
+        const auto op = [&] (const size_t begin, const size_t end)
+        {
+                count += end - begin;
+                if (begin == 0)
+                {
+                        throw std::runtime_error("failed");
+                }
+        };
+
+        // the exception is raised after all tasks are done
+        NANO_CHECK_THROW(nano::loopi(size_t(100), size_t(100), op), std::runtime_error);
+        NANO_CHECK_EQUAL(count.load(), size_t(100));
+        NANO_CHECK_EQUAL(tpool_t::instance().tasks(), 0u);
+}
+
 NANO_END_MODULE()
@@ -0,0 +1,146 @@
+#include "utest.h"
+#include "layers/gemm.h"
+
+using namespace nano;
+
+static auto make_backends()
+{
+        auto backends = enum_values<gemm_backend>();
+        if (!has_blas())
+        {
+                backends.erase(std::remove(backends.begin(), backends.end(), gemm_backend::blas), backends.end());
+        }
+        return backends;
+}
+
+static matrix_t make_matrix(const tensor_size_t rows, const tensor_size_t cols)
+{
+        matrix_t matrix(rows, cols);
+        matrix.setRandom();
+        return matrix;
+}
+
+template <typename tmatrixa, typename tmatrixb>
+static matrix_t expected(const tmatrixa& a, const bool transa, const tmatrixb& b, const bool transb,
+        const matrix_t& c, const scalar_t beta)
+{
+        const matrix_t opa = transa ? matrix_t(a.transpose()) : matrix_t(a);
+        const matrix_t opb = transb ? matrix_t(b.transpose()) : matrix_t(b);
+        return opa * opb + beta * c;
+}
+
+static scalar_t gemm_error(const tensor_size_t m, const tensor_size_t n, const tensor_size_t k)
+{
+        auto error = scalar_t(0);
+        for (const auto backend : make_backends())
+        for (const auto transa : {false, true})
+        for (const auto transb : {false, true})
+        for (const auto beta : {scalar_t(0), scalar_t(1), scalar_t(0.5)})
+        {
+                set_gemm_backend(backend);
+
+                const auto a = transa ? make_matrix(k, m) : make_matrix(m, k);
+                const auto b = transb ? make_matrix(n, k) : make_matrix(k, n);
+                auto c = make_matrix(m, n);
+
+                const matrix_t cc = expected(a, transa, b, transb, c, beta);
+                gemm(a, transa, b, transb, c, beta);
+
+                error = std::max(error, (c - cc).array().abs().maxCoeff());
+        }
+
+        set_gemm_backend(gemm_backend::eigen);
+        return error;
+}
+
+NANO_BEGIN_MODULE(test_gemm)
+
+NANO_CASE(small)
+{
+        NANO_CHECK_LESS(gemm_error(1, 1, 1), epsilon1<scalar_t>());
+        NANO_CHECK_LESS(gemm_error(3, 5, 7), epsilon1<scalar_t>());
+        NANO_CHECK_LESS(gemm_error(11, 2, 9), epsilon1<scalar_t>());
+}
+
+NANO_CASE(blocked)
+{
+        NANO_CHECK_LESS(gemm_error(67, 259, 13), epsilon1<scalar_t>());
+        NANO_CHECK_LESS(gemm_error(5, 17, 263), epsilon1<scalar_t>());
+        NANO_CHECK_LESS(gemm_error(131, 300, 270), epsilon1<scalar_t>());
+}
+
+NANO_CASE(strided)
+{
+        for (const auto backend : make_backends())
+        {
+                set_gemm_backend(backend);
+
+                const auto m = 13, n = 9, k = 21;
+                const auto data = make_matrix(4 * k, 4 * m);
+
+                // every other column from op(A), op(B) as a block, C as a (non-contiguous) block
+                const auto a = map_matrix(data.data(), m, k, 4 * 4 * m, 2);
+                const auto b = data.block(1, 3, k, n);
+
+                matrix_t cbuff = make_matrix(m, 2 * n);
+                matrix_t c0 = cbuff;
+
+                gemm(a, false, b, false, cbuff.leftCols(n), 1);
+
+                const matrix_t cc = expected(a, false, b, false, c0.leftCols(n), 1);
+                NANO_CHECK_EIGEN_CLOSE(cbuff.leftCols(n), cc, epsilon1<scalar_t>());
+                NANO_CHECK_EIGEN_CLOSE(cbuff.rightCols(n), c0.rightCols(n), epsilon0<scalar_t>());
+        }
+
+        set_gemm_backend(gemm_backend::eigen);
+}
+
+NANO_CASE(strided_inner)
+{
+        // e.g. the grouped convolutions in the nhwc layout: interleaved columns of op(A) and C
+        for (const auto backend : make_backends())
+        for (const auto transb : {false, true})
+        {
+                set_gemm_backend(backend);
+
+                const tensor_size_t m = 40, n = 300, k = 70, groups = 3;
+
+                const auto adata = make_matrix(m, k * groups);
+                const auto b = transb ? make_matrix(n, k) : make_matrix(k, n);
+
+                matrix_t cdata = make_matrix(m, n * groups);
+                const matrix_t c0 = cdata;
+
+                for (tensor_size_t g = 0; g < groups; ++ g)
+                {
+                        const auto a = map_matrix(adata.data() + g, m, k, k * groups, groups);
+                        auto c = map_matrix(cdata.data() + g, m, n, n * groups, groups);
+
+                        const matrix_t cc = expected(a, false, b, transb, matrix_t(c), 1);
+                        gemm(a, false, b, transb, c, 1);
+
+                        NANO_CHECK_EIGEN_CLOSE(matrix_t(c), cc, epsilon1<scalar_t>());
+
+                        // the other groups are not modified
+                        for (tensor_size_t gg = g + 1; gg < groups; ++ gg)
+                        {
+                                const auto cg = map_matrix(cdata.data() + gg, m, n, n * groups, groups);
+                                const auto cg0 = map_matrix(c0.data() + gg, m, n, n * groups, groups);
+                                NANO_CHECK_EIGEN_CLOSE(matrix_t(cg), matrix_t(cg0), epsilon0<scalar_t>());
+                        }
+                }
+
+                // the transposed strided op(A) (e.g. the gradient wrt the kernels)
+                const auto at = map_matrix(adata.data() + 1, m, k, k * groups, groups);
+                const auto bt = make_matrix(m, n);
+                matrix_t ct = make_matrix(k, n);
+
+                const matrix_t cct = expected(at, true, bt, false, ct, 0);
+                gemm(at, true, bt, false, ct, 0);
+                NANO_CHECK_EIGEN_CLOSE(ct, cct, epsilon1<scalar_t>());
+        }
+
+        set_gemm_backend(gemm_backend::eigen);
+}
+
+NANO_END_MODULE()
@@ -107,9 +107,10 @@ NANO_CASE(activation)
         for (const auto& layer_id : get_layers().ids())
         {
                 if (is_activation_node(layer_id))
+                for (const auto fast : {false, true})
                 {
                         model_t model;
-                        NANO_CHECK(model.add(config_activation_node("1", layer_id)));
+                        NANO_CHECK(model.add(config_activation_node("1", layer_id, fast)));
                         NANO_CHECK(model.add(config_affine_node("2", cmd_omaps, cmd_orows, cmd_ocols)));
                         NANO_CHECK(model.connect("1", "2"));
 
@@ -560,13 +561,16 @@ NANO_CASE(multi_mix_plus4d)
         NANO_CHECK_EQUAL(model.odims(), cmd_odims);
         NANO_CHECK_EQUAL(model.psize(), psize);
 
-        const auto count = 3;
-        const auto loss = get_losses().get("s-logistic");
-        const auto pfun = model_wrt_params_function_t{loss, model, count};
+        // NB: the inputs of the mixing node are stored in its output buffer for single samples
+        for (const auto count : {1, 3})
+        {
+                const auto loss = get_losses().get("s-logistic");
+                const auto pfun = model_wrt_params_function_t{loss, model, count};
 
-        const vector_t px = pfun.m_model.params();
-        NANO_CHECK_EQUAL(px.size(), pfun.size());
-        NANO_CHECK_LESS(pfun.grad_accuracy(px), epsilon2<scalar_t>());
+                const vector_t px = pfun.m_model.params();
+                NANO_CHECK_EQUAL(px.size(), pfun.size());
+                NANO_CHECK_LESS(pfun.grad_accuracy(px), epsilon2<scalar_t>());
+        }
 }
 
 NANO_CASE(multi_mix_tcat4d)
@@ -598,6 +602,50 @@ NANO_CASE(multi_mix_tcat4d)
         NANO_CHECK_EQUAL(model.odims(), cmd_odims);
         NANO_CHECK_EQUAL(model.psize(), psize);
 
+        // NB: the inputs of the mixing node are stored in its output buffer for single samples
+        for (const auto count : {1, 3})
+        {
+                const auto loss = get_losses().get("s-logistic");
+                const auto pfun = model_wrt_params_function_t{loss, model, count};
+
+                const vector_t px = pfun.m_model.params();
+                NANO_CHECK_EQUAL(px.size(), pfun.size());
+                NANO_CHECK_LESS(pfun.grad_accuracy(px), epsilon2<scalar_t>());
+        }
+}
+
+NANO_CASE(multi_mix_nhwc)
+{
+        model_t model;
+        NANO_CHECK(model.add(config_conv3d_node("11", 4, 5, 5, 1, 1, 1)));
+        NANO_CHECK(model.add(config_norm3d_node("12", norm_type::plane)));
+        NANO_CHECK(model.add(config_conv3d_node("21", 3, 3, 3, 3, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("22", "act-snorm")));
+        NANO_CHECK(model.add(config_conv3d_node("23", 4, 3, 3, 1, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("24", "act-snorm")));
+        NANO_CHECK(model.add(config_tcat4d_node("xx")));
+        NANO_CHECK(model.add(config_activation_node("x1", "act-splus")));
+        NANO_CHECK(model.add(config_affine_node("x2", 5, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("x3", "act-splus")));
+        NANO_CHECK(model.add(config_affine_node("x4", cmd_omaps, cmd_orows, cmd_ocols)));
+        NANO_CHECK(model.connect("11", "12", "xx"));
+        NANO_CHECK(model.connect("21", "22", "23", "24", "xx"));
+        NANO_CHECK(model.connect("xx", "x1", "x2", "x3", "x4"));
+
+        const auto psize =
+                cpsize(cmd_idims, 4, 5, 5, 1) +
+                cpsize(cmd_idims, 3, 3, 3, 3) + cpsize({3, 4, 4}, 4, 3, 3, 1) +
+                apsize({8, 2, 2}, {5, 1, 1}) + apsize({5, 1, 1}, cmd_odims);
+
+        model.layout(tensor_layout::nhwc);
+
+        NANO_REQUIRE(model.done());
+        NANO_REQUIRE(model.resize(cmd_idims, cmd_odims));
+        NANO_CHECK(model.layout() == tensor_layout::nhwc);
+        NANO_CHECK_EQUAL(model.idims(), cmd_idims);
+        NANO_CHECK_EQUAL(model.odims(), cmd_odims);
+        NANO_CHECK_EQUAL(model.psize(), psize);
+
         const auto count = 3;
         const auto loss = get_losses().get("s-logistic");
         const auto pfun = model_wrt_params_function_t{loss, model, count};
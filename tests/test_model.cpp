@@ -4,6 +4,7 @@
 #include "builder.h"
 #include "accumulator.h"
 #include "core/numeric.h"
+#include <cstdio>
 
 using namespace nano;
 
@@ -258,4 +259,450 @@ NANO_CASE(evaluate)
         std::remove(path.c_str());
 }
 
+NANO_CASE(prune)
+{
+        const auto idims = make_dims(3, 4, 4);
+        const auto odims = make_dims(5, 1, 1);
+
+        model_t model;
+        NANO_CHECK(model.add(config_affine_node("aff1", 16, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("act1", "act-snorm")));
+        NANO_CHECK(model.add(config_affine_node("aff2", 5, 1, 1)));
+        NANO_CHECK(model.connect("aff1", "act1", "aff2"));
+        NANO_CHECK(model.done());
+        NANO_REQUIRE(model.resize(idims, odims));
+        model.random();
+
+        tensor4d_t idata(cat_dims(7, idims));
+        idata.setRandom();
+        const tensor4d_t odata = model.output(idata);
+        const auto psize = model.psize();
+
+        NANO_CHECK(!model.prune("act1", scalar_t(0.5)));
+        NANO_CHECK(!model.prune("aff3", scalar_t(0.5)));
+        NANO_CHECK(!model.prune("aff1", scalar_t(0)));
+
+        // keeping all weights should not change the outputs
+        NANO_REQUIRE(model.prune("aff2", scalar_t(1)));
+        NANO_CHECK_EQUAL(model.psize(), psize);
+        NANO_CHECK_EIGEN_CLOSE(model.output(idata).array(), odata.array(), epsilon1<scalar_t>());
+
+        // keeping fewer weights should reduce the number of parameters
+        NANO_REQUIRE(model.prune("aff1", scalar_t(0.25)));
+        NANO_CHECK_LESS(model.psize(), psize);
+        NANO_CHECK_EQUAL(model.idims(), idims);
+        NANO_CHECK_EQUAL(model.odims(), odims);
+        const tensor4d_t podata = model.output(idata);
+
+        // the pruned model should be serializable
+        const auto path = string_t("./test_model_prune.test");
+        NANO_REQUIRE(model.save(path));
+
+        model_t xmodel;
+        NANO_REQUIRE(xmodel.load(path));
+        NANO_CHECK_EQUAL(xmodel.psize(), model.psize());
+        NANO_CHECK_EIGEN_CLOSE(xmodel.output(idata).array(), podata.array(), epsilon0<scalar_t>());
+
+        // cleanup
+        std::remove(path.c_str());
+}
+
+NANO_CASE(mix_buffers)
+{
+        const auto idims = make_dims(3, 6, 6);
+        const auto odims = make_dims(4, 1, 1);
+
+        model_t model;
+        NANO_CHECK(model.add(config_conv3d_node("c11", 4, 3, 3, 1, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("a11", "act-snorm")));
+        NANO_CHECK(model.add(config_conv3d_node("c21", 2, 3, 3, 1, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("a21", "act-snorm")));
+        NANO_CHECK(model.add(config_conv3d_node("c22", 6, 1, 1, 1, 1, 1)));
+        NANO_CHECK(model.add(config_tcat4d_node("cat")));
+        NANO_CHECK(model.add(config_conv3d_node("c31", 6, 1, 1, 1, 1, 1)));
+        NANO_CHECK(model.add(config_plus4d_node("sum")));
+        NANO_CHECK(model.add(config_affine_node("aff", 4, 1, 1)));
+        NANO_CHECK(model.connect("c11", "a11", "cat"));
+        NANO_CHECK(model.connect("c21", "a21", "cat"));
+        NANO_CHECK(model.connect("a21", "c22", "sum"));
+        NANO_CHECK(model.connect("cat", "c31", "sum"));
+        NANO_CHECK(model.connect("cat", "sum", "aff"));
+        NANO_CHECK(model.done());
+        NANO_REQUIRE(model.resize(idims, odims));
+        model.random();
+
+        const auto count = 5;
+        tensor4d_t idata(cat_dims(count, idims));
+        idata.setRandom();
+        const tensor4d_t odata = model.output(idata);
+
+        // processing one sample at a time (when the mixing nodes' inputs share their output buffers)
+        //      should produce the same outputs as processing all samples at once
+        for (auto x = 0; x < count; ++ x)
+        {
+                tensor4d_t xidata(cat_dims(1, idims));
+                xidata.vector() = idata.vector(x);
+                const tensor4d_t xodata = model.output(xidata);
+
+                NANO_CHECK_EIGEN_CLOSE(xodata.vector(), odata.vector(x), epsilon0<scalar_t>());
+        }
+}
+
+NANO_CASE(mix_buffers_size)
+{
+        const auto idims = make_dims(3, 6, 6);
+        const auto odims = make_dims(4, 1, 1);
+        const auto isize = nano::size(idims);
+
+        // (input, a1, a2, mixing node, output)
+        model_t pmodel;
+        NANO_CHECK(pmodel.add(config_affine_node("a1", 8, 1, 1)));
+        NANO_CHECK(pmodel.add(config_affine_node("a2", 8, 1, 1)));
+        NANO_CHECK(pmodel.add(config_plus4d_node("sum")));
+        NANO_CHECK(pmodel.add(config_affine_node("out", 4, 1, 1)));
+        NANO_CHECK(pmodel.connect("a1", "sum", "out"));
+        NANO_CHECK(pmodel.connect("a2", "sum"));
+        NANO_CHECK(pmodel.done());
+        NANO_REQUIRE(pmodel.resize(idims, odims));
+
+        model_t tmodel;
+        NANO_CHECK(tmodel.add(config_affine_node("a1", 8, 1, 1)));
+        NANO_CHECK(tmodel.add(config_affine_node("a2", 8, 1, 1)));
+        NANO_CHECK(tmodel.add(config_tcat4d_node("cat")));
+        NANO_CHECK(tmodel.add(config_affine_node("out", 4, 1, 1)));
+        NANO_CHECK(tmodel.connect("a1", "cat", "out"));
+        NANO_CHECK(tmodel.connect("a2", "cat"));
+        NANO_CHECK(tmodel.done());
+        NANO_REQUIRE(tmodel.resize(idims, odims));
+
+        for (const tensor_size_t count : {1, 2, 16})
+        {
+                // the first input of mix-plus is accumulated in-place for any number of samples
+                NANO_CHECK_EQUAL(pmodel.xsize(count), count * (isize + 0 + 8 + 8 + 4));
+
+                // the inputs of mix-tcat are written in place only for single samples (e.g. inference), not for minibatches
+                NANO_CHECK_EQUAL(tmodel.xsize(count), count * (isize + ((count == 1) ? 0 : 16) + 16 + 4));
+        }
+}
+
+NANO_CASE(clone)
+{
+        const auto idims = make_dims(3, 4, 4);
+        const auto odims = make_dims(5, 1, 1);
+
+        model_t model;
+        NANO_CHECK(model.add(config_affine_node("aff1", 16, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("act1", "act-snorm")));
+        NANO_CHECK(model.add(config_affine_node("aff2", 5, 1, 1)));
+        NANO_CHECK(model.connect("aff1", "act1", "aff2"));
+        NANO_CHECK(model.done());
+        NANO_REQUIRE(model.resize(idims, odims));
+        model.random();
+
+        tensor4d_t idata(cat_dims(3, idims));
+        idata.setRandom();
+        tensor4d_t odata(cat_dims(3, odims));
+        odata.setRandom();
+
+        const tensor4d_t outputs = model.output(idata);
+        const vector_t gparams = model.gparam(odata);
+
+        // the copy should not reuse the execution plan (compiled for the original buffers)
+        const auto xmodel = model.clone();
+        model.random();
+
+        NANO_CHECK_EIGEN_CLOSE(xmodel->output(idata).array(), outputs.array(), epsilon0<scalar_t>());
+        NANO_CHECK_EIGEN_CLOSE(xmodel->gparam(odata), gparams, epsilon0<scalar_t>());
+}
+
+NANO_CASE(variable_batches)
+{
+        const auto idims = make_dims(3, 6, 6);
+        const auto odims = make_dims(4, 1, 1);
+
+        model_t model;
+        NANO_CHECK(model.add(config_conv3d_node("conv", 4, 3, 3, 1, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("act", "act-snorm")));
+        NANO_CHECK(model.add(config_affine_node("aff", 4, 1, 1)));
+        NANO_CHECK(model.connect("conv", "act", "aff"));
+        NANO_CHECK(model.done());
+        NANO_REQUIRE(model.resize(idims, odims));
+        model.random();
+        model.reserve(8);
+
+        for (const auto count : {8, 3, 5, 1, 8, 2})
+        {
+                tensor4d_t idata(cat_dims(count, idims));
+                idata.setRandom();
+                tensor4d_t odata(cat_dims(count, odims));
+                odata.setRandom();
+
+                // batches smaller than the reserved size should produce the same results as a fresh model
+                const auto xmodel = model.clone();
+
+                const tensor4d_t outputs = model.output(idata);
+                const vector_t gparams = model.gparam(odata);
+
+                NANO_CHECK_EIGEN_CLOSE(xmodel->output(idata).array(), outputs.array(), epsilon0<scalar_t>());
+                NANO_CHECK_EIGEN_CLOSE(xmodel->gparam(odata), gparams, epsilon0<scalar_t>());
+        }
+}
+
+NANO_CASE(checkpoints)
+{
+        const auto idims = make_dims(3, 6, 6);
+        const auto odims = make_dims(4, 1, 1);
+
+        model_t model;
+        NANO_CHECK(model.add(config_conv3d_node("c1", 4, 3, 3, 1, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("a1", "act-snorm")));
+        NANO_CHECK(model.add(config_conv3d_node("c2", 4, 1, 1, 1, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("a2", "act-snorm")));
+        NANO_CHECK(model.add(config_plus4d_node("sum")));
+        NANO_CHECK(model.add(config_conv3d_node("c3", 4, 3, 3, 1, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("a3", "act-snorm")));
+        NANO_CHECK(model.add(config_affine_node("aff", 4, 1, 1)));
+        NANO_CHECK(model.connect("c1", "a1", "c2", "a2", "sum", "c3", "a3", "aff"));
+        NANO_CHECK(model.connect("a1", "sum"));
+        NANO_CHECK(model.done());
+        NANO_REQUIRE(model.resize(idims, odims));
+        model.random();
+
+        const auto count = 5;
+        tensor4d_t idata(cat_dims(count, idims));
+        idata.setRandom();
+        tensor4d_t odata(cat_dims(count, odims));
+        odata.setRandom();
+
+        const auto params = model.params();
+        const auto xsize = model.xsize(count);
+        const tensor4d_t outputs = model.output(idata);
+        const vector_t gparams = model.gparam(odata);
+
+        // the checkpoints must split the computation graph
+        model.checkpoints({"c2"});
+        NANO_CHECK(!model.resize(idims, odims));
+        model.checkpoints({"c4"});
+        NANO_CHECK(!model.resize(idims, odims));
+
+        // storing the outputs of the first activations only should save memory
+        model.checkpoints({"a1", "a3"});
+        NANO_REQUIRE(model.resize(idims, odims));
+        NANO_CHECK_LESS(model.xsize(count), xsize);
+
+        // recomputing the outputs should not change the gradients
+        for (const auto& checkpoints : {strings_t{"a1", "a3"}, strings_t{"sum"}, strings_t{"auto"}})
+        {
+                model.checkpoints(checkpoints);
+                NANO_REQUIRE(model.resize(idims, odims));
+                model.params(params);
+
+                NANO_CHECK_EIGEN_CLOSE(model.output(idata).array(), outputs.array(), epsilon0<scalar_t>());
+                NANO_CHECK_EIGEN_CLOSE(model.gparam(odata), gparams, epsilon0<scalar_t>());
+
+                model_t xmodel;
+                NANO_REQUIRE(xmodel.from_json(model.to_json()));
+                NANO_REQUIRE(xmodel.resize(idims, odims));
+                NANO_CHECK(xmodel.checkpoints() == checkpoints);
+                NANO_CHECK_EQUAL(xmodel.xsize(count), model.xsize(count));
+        }
+}
+
+NANO_CASE(checkpoints_auto)
+{
+        const auto idims = make_dims(16, 1, 1);
+        const auto odims = make_dims(4, 1, 1);
+
+        model_t model;
+        strings_t names;
+        for (auto i = 0; i < 8; ++ i)
+        {
+                names.push_back("aff" + std::to_string(i));
+                NANO_CHECK(model.add(config_affine_node(*names.rbegin(), 16, 1, 1)));
+                names.push_back("act" + std::to_string(i));
+                NANO_CHECK(model.add(config_activation_node(*names.rbegin(), "act-snorm")));
+        }
+        names.push_back("out");
+        NANO_CHECK(model.add(config_affine_node(*names.rbegin(), 4, 1, 1)));
+        NANO_CHECK(model.connect(names));
+        NANO_CHECK(model.done());
+        NANO_REQUIRE(model.resize(idims, odims));
+        model.random();
+
+        const auto count = 7;
+        tensor4d_t idata(cat_dims(count, idims));
+        idata.setRandom();
+        tensor4d_t odata(cat_dims(count, odims));
+        odata.setRandom();
+
+        const auto params = model.params();
+        const auto xsize = model.xsize(count);
+        const tensor4d_t outputs = model.output(idata);
+        const vector_t gparams = model.gparam(odata);
+
+        // deep feed-forward chains should benefit from automatically placed checkpoints
+        model.checkpoints({"auto"});
+        NANO_REQUIRE(model.resize(idims, odims));
+        model.params(params);
+
+        NANO_CHECK_LESS(model.xsize(count), xsize);
+        NANO_CHECK_EIGEN_CLOSE(model.output(idata).array(), outputs.array(), epsilon0<scalar_t>());
+        NANO_CHECK_EIGEN_CLOSE(model.gparam(odata), gparams, epsilon0<scalar_t>());
+}
+
+NANO_CASE(frozen)
+{
+        const auto idims = make_dims(3, 6, 6);
+        const auto odims = make_dims(4, 1, 1);
+
+        model_t model;
+        NANO_CHECK(model.add(config_conv3d_node("c1", 4, 3, 3, 1, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("a1", "act-snorm")));
+        NANO_CHECK(model.add(config_conv3d_node("c2", 4, 3, 3, 1, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("a2", "act-snorm")));
+        NANO_CHECK(model.add(config_affine_node("aff", 4, 1, 1)));
+        NANO_CHECK(model.connect("c1", "a1", "c2", "a2", "aff"));
+        NANO_CHECK(model.done());
+        NANO_REQUIRE(model.resize(idims, odims));
+        model.random();
+
+        const auto count = 5;
+        tensor4d_t idata(cat_dims(count, idims));
+        idata.setRandom();
+        tensor4d_t odata(cat_dims(count, odims));
+        odata.setRandom();
+
+        const auto psize = model.psize();
+        const auto params = model.params();
+        const tensor4d_t outputs = model.output(idata);
+        const vector_t gparams = model.gparam(odata);
+        NANO_CHECK_EQUAL(model.prefix_size(), size_t(0));
+
+        // unknown nodes cannot be frozen
+        NANO_CHECK(!model.freeze({"c3"}));
+
+        // the frozen parameters are preserved, but not optimized
+        NANO_REQUIRE(model.freeze({"c1", "a1", "c2", "a2"}));
+        NANO_CHECK_EQUAL(model.prefix_size(), size_t(4));
+        NANO_CHECK(model.prefix_odims() == make_dims(4, 2, 2));
+
+        const auto fsize = psize - model.psize();
+        NANO_CHECK_LESS(model.psize(), psize);
+        NANO_CHECK_EIGEN_CLOSE(model.params(), params.segment(fsize, model.psize()), epsilon0<scalar_t>());
+
+        NANO_CHECK_EIGEN_CLOSE(model.output(idata).array(), outputs.array(), epsilon0<scalar_t>());
+        NANO_CHECK_EIGEN_CLOSE(model.gparam(odata), gparams.segment(fsize, model.psize()), epsilon0<scalar_t>());
+
+        // the outputs of the frozen prefix can be cached
+        const tensor4d_t fdata = model.prefix_output(idata);
+        NANO_CHECK(fdata.dims() == cat_dims(count, model.prefix_odims()));
+        NANO_CHECK_EIGEN_CLOSE(model.suffix_output(fdata).array(), outputs.array(), epsilon0<scalar_t>());
+        NANO_CHECK_EIGEN_CLOSE(model.gparam(odata), gparams.segment(fsize, model.psize()), epsilon0<scalar_t>());
+
+        // the frozen flag is serialized
+        {
+                model_t xmodel;
+                NANO_REQUIRE(xmodel.from_json(model.to_json()));
+                NANO_REQUIRE(xmodel.resize(idims, odims));
+                NANO_CHECK_EQUAL(xmodel.psize(), model.psize());
+                NANO_CHECK_EQUAL(xmodel.prefix_size(), model.prefix_size());
+        }
+        {
+                const auto path = "test_model_frozen.model";
+
+                model_t xmodel;
+                NANO_REQUIRE(model.save(path));
+                NANO_REQUIRE(xmodel.load(path));
+                NANO_CHECK_EQUAL(xmodel.psize(), model.psize());
+                NANO_CHECK_EIGEN_CLOSE(xmodel.params(), model.params(), epsilon0<scalar_t>());
+                NANO_CHECK_EIGEN_CLOSE(xmodel.output(idata).array(), outputs.array(), epsilon0<scalar_t>());
+                std::remove(path);
+        }
+
+        // unfreezing restores the original parameters
+        NANO_REQUIRE(model.freeze({"c1", "a1", "c2", "a2"}, false));
+        NANO_CHECK_EQUAL(model.prefix_size(), size_t(0));
+        NANO_CHECK_EQUAL(model.psize(), psize);
+        NANO_CHECK_EIGEN_CLOSE(model.params(), params, epsilon0<scalar_t>());
+}
+
+NANO_CASE(stages)
+{
+        const auto idims = make_dims(3, 6, 6);
+        const auto odims = make_dims(4, 1, 1);
+
+        model_t model;
+        NANO_CHECK(model.add(config_conv3d_node("c1", 4, 3, 3, 1, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("a1", "act-snorm")));
+        NANO_CHECK(model.add(config_conv3d_node("c2", 4, 1, 1, 1, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("a2", "act-snorm")));
+        NANO_CHECK(model.add(config_plus4d_node("sum")));
+        NANO_CHECK(model.add(config_conv3d_node("c3", 4, 3, 3, 1, 1, 1)));
+        NANO_CHECK(model.add(config_activation_node("a3", "act-snorm")));
+        NANO_CHECK(model.add(config_affine_node("aff", 4, 1, 1)));
+        NANO_CHECK(model.connect("c1", "a1", "c2", "a2", "sum", "c3", "a3", "aff"));
+        NANO_CHECK(model.connect("a1", "sum"));
+        NANO_CHECK(model.done());
+        NANO_REQUIRE(model.resize(idims, odims));
+        model.random();
+
+        // two micro-batches of different sizes
+        std::vector<tensor4d_t> idatas, odatas, outputs;
+        std::vector<vector_t> gparams;
+        for (const auto count : {3, 2})
+        {
+                idatas.emplace_back(cat_dims(count, idims));
+                idatas.rbegin()->setRandom();
+                odatas.emplace_back(cat_dims(count, odims));
+                odatas.rbegin()->setRandom();
+
+                outputs.emplace_back(model.output(*idatas.rbegin()));
+                gparams.emplace_back(model.gparam(*odatas.rbegin()));
+        }
+
+        // processing the stages of the micro-batches interleaved should not change the outputs and the gradients
+        for (const auto& checkpoints : {strings_t{}, strings_t{"a1", "a3"}})
+        {
+                model.checkpoints(checkpoints);
+                NANO_REQUIRE(model.resize(idims, odims));
+                for (size_t stages = 1; stages <= 8; ++ stages)
+                {
+                        const auto bounds = model.stages(stages);
+                        NANO_REQUIRE(bounds.size() >= 2 && bounds.size() <= stages + 1);
+                        NANO_CHECK_EQUAL(*bounds.begin(), size_t(0));
+                        NANO_CHECK_EQUAL(*bounds.rbegin(), size_t(8));
+                        NANO_CHECK(std::is_sorted(bounds.begin(), bounds.end()));
+
+                        model.micros(2);
+                        NANO_REQUIRE_EQUAL(model.micros(), size_t(2));
+
+                        std::vector<tensor4d_t> xoutputs(2);
+                        for (size_t s = 0; s + 1 < bounds.size(); ++ s)
+                        {
+                                for (size_t m = 0; m < 2; ++ m)
+                                {
+                                        xoutputs[m] = model.output(m, idatas[m], bounds[s], bounds[s + 1]);
+                                }
+                        }
+
+                        vector_t xgparams = vector_t::Zero(model.psize());
+                        for (size_t s = bounds.size() - 1; s > 0; -- s)
+                        {
+                                for (size_t m = 0; m < 2; ++ m)
+                                {
+                                        model.gparam(m, odatas[m], bounds[s - 1], bounds[s], xgparams);
+                                }
+                        }
+
+                        NANO_CHECK_EIGEN_CLOSE(xoutputs[0].array(), outputs[0].array(), epsilon0<scalar_t>());
+                        NANO_CHECK_EIGEN_CLOSE(xoutputs[1].array(), outputs[1].array(), epsilon0<scalar_t>());
+                        NANO_CHECK_EIGEN_CLOSE(xgparams, gparams[0] + gparams[1], epsilon0<scalar_t>());
+
+                        // the model's own buffers are allocated again if needed
+                        NANO_CHECK_EIGEN_CLOSE(model.output(idatas[0]).array(), outputs[0].array(), epsilon0<scalar_t>());
+                        NANO_CHECK_EIGEN_CLOSE(model.gparam(odatas[0]), gparams[0], epsilon0<scalar_t>());
+                }
+        }
+}
+
 NANO_END_MODULE()
@@ -2,6 +2,7 @@
 #include "function.h"
 #include "core/stats.h"
 #include "layers/norm4d.h"
+#include "tensor/layout.h"
 
 using namespace nano;
 
@@ -55,6 +56,27 @@ auto make_wrt_inputs_function(const norm3d_params_t& params)
 
 NANO_BEGIN_MODULE(test_norm4d)
 
+NANO_CASE(moments)
+{
+        for (const auto size : {1, 7, 1023, 1024, 1025, 4097})
+        {
+                const auto offset = scalar_t(1e+6);
+
+                vector_t data(size);
+                data.setRandom();
+                data.array() += offset;
+
+                scalar_t mean, variance;
+                norm4d_t::moments(data.array(), mean, variance);
+
+                const auto xmean = data.mean();
+                const auto xvariance = (data.array() - xmean).square().mean();
+
+                NANO_CHECK_CLOSE(mean, xmean, epsilon0<scalar_t>() * offset);
+                NANO_CHECK_CLOSE(variance, xvariance, epsilon1<scalar_t>());
+        }
+}
+
 NANO_CASE(globally)
 {
         const auto count = 9, xmaps = 3, xrows = 7, xcols = 5;
@@ -81,6 +103,67 @@ NANO_CASE(globally)
         }
 }
 
+NANO_CASE(globally_large_offset)
+{
+        const auto count = 3, xmaps = 16, xrows = 16, xcols = 16;
+        const auto params = norm3d_params_t{xmaps, xrows, xcols, norm_type::global};
+        NANO_REQUIRE(params.valid());
+
+        // NB: the sum-of-squares formula is not stable in this case
+        tensor4d_t idata(count, xmaps, xrows, xcols);
+        idata.random(-1, +1);
+        idata.array() += scalar_t(1e+6);
+
+        auto odata = idata;
+        norm4d_t norm(params);
+        norm.output(idata, odata);
+
+        for (auto x = 0; x < count; ++ x)
+        {
+                const auto stats = get_stats(odata.tensor(x));
+
+                NANO_CHECK_LESS(std::fabs(stats.avg() - scalar_t(0)), epsilon2<scalar_t>());
+                NANO_CHECK_LESS(std::fabs(stats.stdev() - scalar_t(1)), epsilon2<scalar_t>());
+        }
+}
+
+NANO_CASE(cached_statistics)
+{
+        const auto count = 5, xmaps = 3, xrows = 7, xcols = 5;
+
+        for (const auto ntype : {norm_type::global, norm_type::plane})
+        {
+                const auto params = norm3d_params_t{xmaps, xrows, xcols, ntype};
+                NANO_REQUIRE(params.valid());
+
+                tensor4d_t idata(count, xmaps, xrows, xcols);
+                idata.random(-1, +1);
+
+                auto odata = idata;
+                norm4d_t norm(params);
+                norm.output(idata, odata);
+
+                const auto groups = ntype == norm_type::global ? 1 : xmaps;
+                NANO_REQUIRE_EQUAL(norm.means().rows(), count);
+                NANO_REQUIRE_EQUAL(norm.means().cols(), groups);
+                NANO_REQUIRE_EQUAL(norm.istdvs().rows(), count);
+                NANO_REQUIRE_EQUAL(norm.istdvs().cols(), groups);
+
+                for (auto x = 0; x < count; ++ x)
+                {
+                        for (auto i = 0; i < groups; ++ i)
+                        {
+                                const auto stats = (ntype == norm_type::global) ?
+                                        get_stats(idata.tensor(x)) : get_stats(idata.matrix(x, i));
+
+                                NANO_CHECK_CLOSE(norm.means()(x, i), stats.avg(), epsilon0<scalar_t>());
+                                NANO_CHECK_CLOSE(norm.istdvs()(x, i),
+                                        scalar_t(1) / std::sqrt(stats.var()), epsilon1<scalar_t>());
+                        }
+                }
+        }
+}
+
 NANO_CASE(globally_ginput_accuracy)
 {
         const auto xmaps = 3, xrows = 7, xcols = 5;
@@ -134,4 +217,32 @@ NANO_CASE(by_plane_ginput_accuracy)
         NANO_CHECK_LESS(ifunct.grad_accuracy(ix), epsilon2<scalar_t>());
 }
 
- NANO_END_MODULE()
+NANO_CASE(by_plane_nchw_vs_nhwc)
+{
+        const auto count = 9, xmaps = 3, xrows = 7, xcols = 5;
+        const auto params = norm3d_params_t{xmaps, xrows, xcols, norm_type::plane};
+        NANO_REQUIRE(params.valid());
+
+        tensor4d_t idata(count, xmaps, xrows, xcols), idatax(count, xmaps, xrows, xcols);
+        tensor4d_t odata(count, xmaps, xrows, xcols), odatax(count, xmaps, xrows, xcols);
+        idata.random(-1, +1);
+        odata.random(-1, +1);
+
+        convert(idata, tensor_layout::nchw, idatax, tensor_layout::nhwc);
+        convert(odata, tensor_layout::nchw, odatax, tensor_layout::nhwc);
+
+        norm4d_t norm(params, tensor_layout::nchw), normx(params, tensor_layout::nhwc);
+
+        auto odata1 = odata, odatax1 = odatax;
+        norm.output(idata, odata1);
+        normx.output(idatax, odatax1);
+        convert(tensor4d_t{odatax1}, tensor_layout::nhwc, odatax1, tensor_layout::nchw);
+        NANO_CHECK_EIGEN_CLOSE(odata1.array(), odatax1.array(), epsilon0<scalar_t>());
+
+        norm.ginput(idata, odata);
+        normx.ginput(idatax, odatax);
+        convert(tensor4d_t{idatax}, tensor_layout::nhwc, idatax, tensor_layout::nchw);
+        NANO_CHECK_EIGEN_CLOSE(idata.array(), idatax.array(), epsilon0<scalar_t>());
+}
+
+NANO_END_MODULE()
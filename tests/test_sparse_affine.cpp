@@ -0,0 +1,202 @@
+#include "utest.h"
+#include "function.h"
+#include "layers/affine4d.h"
+#include "layers/sparse_affine4d.h"
+
+using namespace nano;
+
+auto make_default_params()
+{
+        const auto imaps = 2;
+        const auto irows = 3;
+        const auto icols = 4;
+        const auto omaps = 3;
+        const auto orows = 4;
+        const auto ocols = 5;
+
+        return affine_params_t{imaps, irows, icols, omaps, orows, ocols};
+}
+
+auto make_default_op(const scalar_t density)
+{
+        const auto params = make_default_params();
+
+        sparse_indices_t rowptr, colidx;
+        sparse_affine4d_t::make_pattern(params, density, rowptr, colidx);
+        return sparse_affine4d_t{params, rowptr, colidx};
+}
+
+auto make_buffers(const sparse_affine4d_t& op, const tensor_size_t count)
+{
+        vector_t wdata(op.nnz()); wdata.setRandom();
+        auto bdata = op.params().make_bdata(); bdata.setRandom();
+        auto idata = op.params().make_idata(count); idata.setRandom();
+        auto odata = op.params().make_odata(count); odata.setRandom();
+        return std::make_tuple(idata, wdata, bdata, odata);
+}
+
+matrix_t make_dense(const sparse_affine4d_t& op, const vector_t& wdata)
+{
+        matrix_t dense = op.params().make_wdata();
+        dense.setZero();
+        for (tensor_size_t o = 0; o < dense.rows(); ++ o)
+        {
+                for (auto k = op.rowptr()[o]; k < op.rowptr()[o + 1]; ++ k)
+                {
+                        dense(o, op.colidx()[k]) = wdata(k);
+                }
+        }
+        return dense;
+}
+
+struct wrt_params_function_t final : public function_t
+{
+        explicit wrt_params_function_t(const sparse_affine4d_t& op) :
+                function_t("sparse-affine", op.psize(), op.psize(), op.psize(), convexity::no),
+                m_op(op)
+        {
+                std::tie(m_idata, m_wdata, m_bdata, m_odata) = make_buffers(op, 3);
+        }
+
+        scalar_t vgrad(const vector_t& x, vector_t* gx) const override
+        {
+                m_wdata = map_vector(x.data(), m_wdata.size());
+                m_bdata = map_vector(x.data() + m_wdata.size(), m_bdata.size());
+                m_op.output(m_idata, m_wdata, m_bdata, m_odata);
+                if (gx)
+                {
+                        gx->resize(x.size());
+                        auto wdata = map_vector(gx->data(), m_wdata.size());
+                        auto bdata = map_vector(gx->data() + m_wdata.size(), m_bdata.size());
+                        m_op.gparam(m_idata, wdata, bdata, m_odata);
+                }
+                return m_odata.array().square().sum() / 2;
+        }
+
+        sparse_affine4d_t       m_op;
+        tensor4d_t              m_idata;
+        mutable vector_t        m_wdata;
+        mutable vector_t        m_bdata;
+        mutable tensor4d_t      m_odata;
+};
+
+struct wrt_inputs_function_t final : public function_t
+{
+        explicit wrt_inputs_function_t(const sparse_affine4d_t& op) :
+                function_t("sparse-affine", op.params().isize(), op.params().isize(), op.params().isize(), convexity::no),
+                m_op(op)
+        {
+                std::tie(m_idata, m_wdata, m_bdata, m_odata) = make_buffers(op, 1);
+        }
+
+        scalar_t vgrad(const vector_t& x, vector_t* gx) const override
+        {
+                m_idata = map_tensor(x.data(), m_idata.dims());
+                m_op.output(m_idata, m_wdata, m_bdata, m_odata);
+                if (gx)
+                {
+                        gx->resize(x.size());
+                        auto idata = map_tensor(gx->data(), m_idata.dims());
+                        m_op.ginput(idata, m_wdata, m_bdata, m_odata);
+                }
+                return m_odata.array().square().sum() / 2;
+        }
+
+        sparse_affine4d_t       m_op;
+        mutable tensor4d_t      m_idata;
+        vector_t                m_wdata;
+        vector_t                m_bdata;
+        mutable tensor4d_t      m_odata;
+};
+
+NANO_BEGIN_MODULE(test_sparse_affine)
+
+NANO_CASE(pattern)
+{
+        for (const auto density : {0.01, 0.1, 0.5, 1.0})
+        {
+                const auto op = make_default_op(density);
+                NANO_REQUIRE(op.valid());
+
+                const auto isize = op.params().isize();
+                const auto osize = op.params().osize();
+
+                NANO_CHECK_EQUAL(op.rowptr().size(), static_cast<size_t>(osize + 1));
+                NANO_CHECK_GREATER_EQUAL(op.nnz(), osize);
+                NANO_CHECK_LESS_EQUAL(op.nnz(), osize * isize);
+                NANO_CHECK_EQUAL(op.psize(), op.nnz() + osize);
+        }
+
+        const auto params = make_default_params();
+        NANO_CHECK(!(sparse_affine4d_t{params, {0, 1}, {0}}.valid()));
+        NANO_CHECK(!(sparse_affine4d_t{params, {}, {}}.valid()));
+}
+
+NANO_CASE(gparam_accuracy)
+{
+        for (const auto density : {0.1, 0.5, 1.0})
+        {
+                const auto pfunct = wrt_params_function_t{make_default_op(density)};
+
+                vector_t px(pfunct.size()); px.setRandom();
+                NANO_CHECK_LESS(pfunct.grad_accuracy(px), epsilon2<scalar_t>());
+        }
+}
+
+NANO_CASE(ginput_accuracy)
+{
+        for (const auto density : {0.1, 0.5, 1.0})
+        {
+                const auto ifunct = wrt_inputs_function_t{make_default_op(density)};
+
+                vector_t ix(ifunct.size()); ix.setRandom();
+                NANO_CHECK_LESS(ifunct.grad_accuracy(ix), epsilon2<scalar_t>());
+        }
+}
+
+NANO_CASE(sparse_vs_dense)
+{
+        for (const auto density : {0.1, 0.5, 1.0})
+        {
+                const auto op = make_default_op(density);
+                const auto opd = affine4d_t{op.params()};
+
+                for (int i = 0; i < 4; ++ i)
+                {
+                        tensor4d_t idata, odata, odatad;
+                        vector_t wdata, bdata;
+
+                        std::tie(idata, wdata, bdata, odata) = make_buffers(op, i + 2);
+
+                        // sparse inputs
+                        idata.array() *= (idata.array() > scalar_t(0)).template cast<scalar_t>();
+
+                        const matrix_t wdense = make_dense(op, wdata);
+                        odatad = odata;
+
+                        op.output(idata, wdata, bdata, odata);
+                        opd.output(idata, wdense, bdata, odatad);
+                        NANO_CHECK_EIGEN_CLOSE(odata.array(), odatad.array(), epsilon1<scalar_t>());
+
+                        tensor4d_t gidata = idata, gidatad = idata;
+                        op.ginput(gidata, wdata, bdata, odata);
+                        opd.ginput(gidatad, wdense, bdata, odata);
+                        NANO_CHECK_EIGEN_CLOSE(gidata.array(), gidatad.array(), epsilon1<scalar_t>());
+
+                        vector_t gwdata = wdata, gbdata = bdata, gbdatad = bdata;
+                        matrix_t gwdatad = wdense;
+                        op.gparam(idata, gwdata, gbdata, odata);
+                        opd.gparam(idata, gwdatad, gbdatad, odata);
+                        NANO_CHECK_EIGEN_CLOSE(gbdata, gbdatad, epsilon1<scalar_t>());
+                        for (tensor_size_t o = 0; o < gwdatad.rows(); ++ o)
+                        {
+                                for (auto k = op.rowptr()[o]; k < op.rowptr()[o + 1]; ++ k)
+                                {
+                                        NANO_CHECK_CLOSE(gwdata(k), gwdatad(o, op.colidx()[k]), epsilon1<scalar_t>());
+                                }
+                        }
+                }
+        }
+}
+
+NANO_END_MODULE()
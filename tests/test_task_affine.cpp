@@ -1,5 +1,6 @@
 #include "task.h"
 #include "utest.h"
+#include <algorithm>
 
 using namespace nano;
 
@@ -70,4 +71,121 @@ NANO_CASE(construction)
         NANO_CHECK_LESS_EQUAL(task->intersections(), size_t(0));
 }
 
+NANO_CASE(reproducible)
+{
+        const auto make_task = [] (const size_t seed)
+        {
+                auto task = get_tasks().get("synth-affine");
+                task->from_json(to_json("isize", 7, "osize", 3, "count", 100, "folds", 3, "seed", seed));
+                return task;
+        };
+
+        const auto task1 = make_task(42);
+        const auto task2 = make_task(42);
+        const auto task3 = make_task(43);
+        NANO_REQUIRE(task1->load());
+        NANO_REQUIRE(task2->load());
+        NANO_REQUIRE(task3->load());
+
+        for (size_t f = 0; f < task1->fsize(); ++ f)
+        {
+                std::vector<size_t> hashes;
+                for (const auto p : {protocol::train, protocol::valid, protocol::test})
+                {
+                        const auto fold = fold_t{f, p};
+                        const auto size = task1->size(fold);
+
+                        // the same seed generates the same samples, in any order
+                        const auto batch1 = task1->get(fold, 0, size);
+                        const auto batch2 = task2->get(fold, 0, size);
+                        const auto batch3 = task3->get(fold, 0, size);
+                        NANO_CHECK_EIGEN_CLOSE(batch1.idata().vector(), batch2.idata().vector(), epsilon0<scalar_t>());
+                        NANO_CHECK_EIGEN_CLOSE(batch1.odata().vector(), batch2.odata().vector(), epsilon0<scalar_t>());
+                        NANO_CHECK_GREATER((batch1.idata().vector() - batch3.idata().vector()).lpNorm<Eigen::Infinity>(),
+                                epsilon1<scalar_t>());
+
+                        for (size_t i = 0; i < size; ++ i)
+                        {
+                                const auto sample = task1->get(fold, i, i + 1);
+                                NANO_CHECK_EIGEN_CLOSE(sample.idata(0).vector(), batch1.idata(static_cast<tensor_size_t>(i)).vector(),
+                                        epsilon0<scalar_t>());
+                                hashes.push_back(task1->ihash(fold, i));
+                        }
+
+                        // shuffling changes only the order of the samples
+                        std::vector<size_t> shuffled;
+                        task2->shuffle(fold);
+                        for (size_t i = 0; i < size; ++ i)
+                        {
+                                shuffled.push_back(task2->ihash(fold, i));
+                        }
+
+                        auto expected = std::vector<size_t>(hashes.end() - static_cast<std::ptrdiff_t>(size), hashes.end());
+                        std::sort(expected.begin(), expected.end());
+                        std::sort(shuffled.begin(), shuffled.end());
+                        NANO_CHECK(expected == shuffled);
+                }
+
+                // each fold is a partition of the same samples
+                std::sort(hashes.begin(), hashes.end());
+                NANO_CHECK(std::adjacent_find(hashes.begin(), hashes.end()) == hashes.end());
+                NANO_CHECK_EQUAL(hashes.size(), size_t(100));
+        }
+}
+
+NANO_CASE(random_seed)
+{
+        const auto make_task = [] ()
+        {
+                auto task = get_tasks().get("synth-affine");
+                task->from_json(to_json("isize", 7, "osize", 3, "count", 100, "folds", 3));
+                return task;
+        };
+
+        const auto task1 = make_task();
+        const auto task2 = make_task();
+        NANO_REQUIRE(task1->load());
+        NANO_REQUIRE(task2->load());
+
+        // a fresh seed is drawn when not given explicitly...
+        json_t json1, json2;
+        task1->to_json(json1);
+        task2->to_json(json2);
+        uint64_t seed1 = 0, seed2 = 0;
+        from_json(json1, "seed", seed1);
+        from_json(json2, "seed", seed2);
+        NANO_CHECK_NOT_EQUAL(seed1, seed2);
+
+        const auto fold = fold_t{0, protocol::train};
+        const auto size = task1->size(fold);
+        NANO_CHECK_GREATER((task1->get(fold, 0, size).idata().vector() -
+                task2->get(fold, 0, size).idata().vector()).lpNorm<Eigen::Infinity>(), epsilon1<scalar_t>());
+
+        // ... and reported to reproduce the samples
+        auto task3 = get_tasks().get("synth-affine");
+        task3->from_json(json1);
+        NANO_REQUIRE(task3->load());
+        NANO_CHECK_EIGEN_CLOSE(task1->get(fold, 0, size).idata().vector(),
+                task3->get(fold, 0, size).idata().vector(), epsilon0<scalar_t>());
+}
+
+NANO_CASE(large)
+{
+        // the samples are generated on the fly, so the number of samples doesn't matter
+        const auto count = size_t(1) << 40;
+
+        auto task = get_tasks().get("synth-affine");
+        task->from_json(to_json("isize", 5, "osize", 2, "count", count, "folds", 2));
+        NANO_REQUIRE(task->load());
+
+        NANO_CHECK_EQUAL(task->size(), 2 * count);
+        NANO_CHECK_EQUAL(task->size({1, protocol::train}), 40 * count / 100);
+
+        const auto fold = fold_t{1, protocol::test};
+        const auto last = task->size(fold);
+        const auto minibatch = task->get(fold, last - 16, last);
+        NANO_CHECK_EQUAL(minibatch.count(), 16);
+        NANO_CHECK_LESS_EQUAL(minibatch.idata().vector().lpNorm<Eigen::Infinity>(), scalar_t(1));
+}
+
 NANO_END_MODULE()
@@ -0,0 +1,116 @@
+#include "utest.h"
+#include "tasks/task_augment.h"
+
+using namespace nano;
+
+static image_t make_image(const coord_t rows, const coord_t cols)
+{
+        image_tensor_t data(3, rows, cols);
+        for (coord_t b = 0; b < 3; ++ b)
+        {
+                for (coord_t r = 0; r < rows; ++ r)
+                {
+                        for (coord_t c = 0; c < cols; ++ c)
+                        {
+                                data(b, r, c) = static_cast<luma_t>((b * 71 + r * 13 + c * 7) % 256);
+                        }
+                }
+        }
+
+        image_t image;
+        image.load(data);
+        return image;
+}
+
+NANO_BEGIN_MODULE(test_task_augment)
+
+NANO_CASE(disabled)
+{
+        augment_t augment;
+        NANO_CHECK(!augment.enabled());
+
+        augment.from_json(to_json("crop", 0, "flip", 0, "jitter", 0));
+        NANO_CHECK(!augment.enabled());
+
+        const auto image = make_image(9, 11);
+
+        tensor3d_t idata(3, 9, 11);
+        augment(image, rect_t(), idata.tensor());
+        NANO_CHECK_EIGEN_CLOSE(idata.vector(), image.to_tensor().vector(), epsilon0<scalar_t>());
+
+        const auto region = rect_t(2, 3, 5, 4);
+        tensor3d_t rdata(3, 4, 5);
+        augment(image, region, rdata.tensor());
+        NANO_CHECK_EIGEN_CLOSE(rdata.vector(), image.to_tensor(region).vector(), epsilon0<scalar_t>());
+}
+
+NANO_CASE(flip)
+{
+        augment_t augment;
+        augment.from_json(to_json("flip", 1));
+        NANO_CHECK(augment.enabled());
+
+        const auto image = make_image(8, 8);
+        const auto region = rect_t(1, 2, 6, 5);
+        const auto expected = image.to_tensor(region);
+
+        for (int trial = 0; trial < 16; ++ trial)
+        {
+                tensor3d_t idata(3, 5, 6);
+                augment(image, region, idata.tensor());
+
+                for (coord_t b = 0; b < 3; ++ b)
+                {
+                        const auto flipped = (idata.matrix(b) - expected.matrix(b).rowwise().reverse()).norm() < epsilon0<scalar_t>();
+                        const auto original = (idata.matrix(b) - expected.matrix(b)).norm() < epsilon0<scalar_t>();
+                        NANO_CHECK(flipped || original);
+                }
+        }
+}
+
+NANO_CASE(crop)
+{
+        augment_t augment;
+        augment.from_json(to_json("crop", 3));
+
+        const auto image = make_image(10, 12);
+        const auto expected = image.to_tensor();
+
+        for (int trial = 0; trial < 16; ++ trial)
+        {
+                tensor3d_t idata(3, 10, 12);
+                augment(image, rect_t(), idata.tensor());
+
+                // the translated pixels are either zero or pixels of the original image
+                for (coord_t b = 0; b < 3; ++ b)
+                {
+                        for (coord_t r = 0; r < 10; ++ r)
+                        {
+                                for (coord_t c = 0; c < 12; ++ c)
+                                {
+                                        const auto value = idata(b, r, c);
+                                        NANO_CHECK(value == scalar_t(0) ||
+                                                (expected.matrix(b).array() - value).abs().minCoeff() < epsilon0<scalar_t>());
+                                }
+                        }
+                }
+        }
+}
+
+NANO_CASE(jitter)
+{
+        augment_t augment;
+        augment.from_json(to_json("crop", 2, "flip", 1, "jitter", 0.2));
+
+        const auto image = make_image(7, 7);
+        for (int trial = 0; trial < 16; ++ trial)
+        {
+                tensor3d_t idata(3, 7, 7);
+                augment(image, rect_t(), idata.tensor());
+
+                NANO_CHECK_GREATER_EQUAL(idata.vector().minCoeff(), scalar_t(0));
+                NANO_CHECK_LESS_EQUAL(idata.vector().maxCoeff(), scalar_t(1));
+        }
+}
+
+NANO_END_MODULE()
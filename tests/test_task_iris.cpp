@@ -1,5 +1,11 @@
 #include "task.h"
 #include "utest.h"
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <fstream>
+#include <dirent.h>
+#include <unistd.h>
 
 using namespace nano;
 
@@ -28,6 +34,157 @@ NANO_CASE(default_config)
         NANO_CHECK_EQUAL(folds, 10u);
 }
 
+NANO_CASE(snapshot)
+{
+        char dir[] = "/tmp/nano-iris-XXXXXX";
+        NANO_REQUIRE(::mkdtemp(dir) != nullptr);
+
+        const auto path = string_t(dir) + "/iris.data";
+        {
+                std::ofstream stream(path.c_str());
+                for (int i = 0; i < 60; ++ i)
+                {
+                        stream << (i % 7) << "," << (i % 5) << "," << (i % 3) << "," << i << ",class" << (i % 3) << "\n";
+                }
+        }
+
+        const auto folds = size_t(3);
+        const auto load = [&] ()
+        {
+                auto task = nano::get_tasks().get("iris");
+                task->from_json(to_json("path", path, "folds", folds));
+                return task;
+        };
+
+        // the first load populates the task and saves the snapshot, the second one maps the snapshot
+        const auto task1 = load();
+        NANO_REQUIRE(task1->load());
+
+        const auto task2 = load();
+        NANO_REQUIRE(task2->load());
+
+        NANO_CHECK_EQUAL(task1->idims(), task2->idims());
+        NANO_CHECK_EQUAL(task1->odims(), task2->odims());
+        NANO_CHECK_EQUAL(task1->fsize(), task2->fsize());
+        NANO_REQUIRE_EQUAL(task1->size(), task2->size());
+
+        for (size_t f = 0; f < folds; ++ f)
+        {
+                for (const auto p : {protocol::train, protocol::valid, protocol::test})
+                {
+                        NANO_REQUIRE_EQUAL(task1->size({f, p}), task2->size({f, p}));
+                        for (size_t i = 0, size = task1->size({f, p}); i < size; ++ i)
+                        {
+                                const auto sample1 = task1->get({f, p}, i, i + 1);
+                                const auto sample2 = task2->get({f, p}, i, i + 1);
+
+                                NANO_CHECK_EIGEN_CLOSE(sample1.idata(0).vector(), sample2.idata(0).vector(), epsilon0<scalar_t>());
+                                NANO_CHECK_EIGEN_CLOSE(sample1.odata(0).vector(), sample2.odata(0).vector(), epsilon0<scalar_t>());
+                                NANO_CHECK_EQUAL(task1->label({f, p}, i), task2->label({f, p}, i));
+                                NANO_CHECK_EQUAL(task1->ihash({f, p}, i), task2->ihash({f, p}, i));
+                        }
+                }
+        }
+
+        // cleanup (no temporary file should be left behind)
+        size_t snapshots = 0, temporaries = 0;
+        if (auto* handle = ::opendir(dir))
+        {
+                while (const auto* entry = ::readdir(handle))
+                {
+                        const auto name = string_t(entry->d_name);
+                        if (name != "." && name != "..")
+                        {
+                                snapshots += name.find(".snapshot") != string_t::npos;
+                                temporaries += name.find(".tmp") != string_t::npos;
+                                std::remove((string_t(dir) + "/" + name).c_str());
+                        }
+                }
+                ::closedir(handle);
+        }
+        ::rmdir(dir);
+
+        NANO_CHECK_EQUAL(snapshots, size_t(1));
+        NANO_CHECK_EQUAL(temporaries, size_t(0));
+}
+
+NANO_CASE(parsing)
+{
+        char dir[] = "/tmp/nano-iris-XXXXXX";
+        NANO_REQUIRE(::mkdtemp(dir) != nullptr);
+
+        // large enough to be parsed as several ranges, with blank lines, spaces and CRLF line endings
+        const auto rows = 100000;
+        const auto path = string_t(dir) + "/iris.data";
+        {
+                std::ofstream stream(path.c_str());
+                for (int i = 0; i < rows; ++ i)
+                {
+                        stream << (i % 7) << ", " << (i % 5) << "," << (i % 3) << "," << i << ",class" << (i % 3) << "\r\n";
+                        if (i % 1000 == 0)
+                        {
+                                stream << "\n";
+                        }
+                }
+        }
+
+        const auto folds = size_t(1);
+        const auto task = nano::get_tasks().get("iris");
+        task->from_json(to_json("path", path, "folds", folds));
+        NANO_REQUIRE(task->load());
+
+        NANO_CHECK_EQUAL(task->idims(), make_dims(4, 1, 1));
+        NANO_CHECK_EQUAL(task->odims(), make_dims(3, 1, 1));
+        NANO_REQUIRE_EQUAL(task->size(), size_t(rows));
+
+        std::vector<int> counts(rows, 0);
+        for (const auto p : {protocol::train, protocol::valid, protocol::test})
+        {
+                const auto size = task->size({0, p});
+                const auto minibatch = task->get({0, p}, 0, size);
+                for (size_t s = 0; s < size; ++ s)
+                {
+                        // the inputs are scaled by the maximum absolute value of each attribute
+                        const auto idata = minibatch.idata(static_cast<tensor_size_t>(s)).vector();
+                        const auto i = static_cast<int>(std::lround(idata(3) * (rows - 1)));
+                        NANO_REQUIRE(i >= 0 && i < rows);
+
+                        ++ counts[static_cast<size_t>(i)];
+                        NANO_CHECK_CLOSE(idata(0), static_cast<scalar_t>(i % 7) / 6, epsilon1<scalar_t>());
+                        NANO_CHECK_CLOSE(idata(1), static_cast<scalar_t>(i % 5) / 4, epsilon1<scalar_t>());
+                        NANO_CHECK_CLOSE(idata(2), static_cast<scalar_t>(i % 3) / 2, epsilon1<scalar_t>());
+                        NANO_CHECK_EQUAL(task->label({0, p}, s), "class" + to_string(i % 3));
+                }
+        }
+
+        NANO_CHECK(std::all_of(counts.begin(), counts.end(), [] (const int count) { return count == 1; }));
+
+        // invalid number of columns
+        {
+                std::ofstream stream(path.c_str(), std::ios::app);
+                stream << "1,2,3,class0\n";
+        }
+
+        const auto invalid = nano::get_tasks().get("iris");
+        invalid->from_json(to_json("path", path, "folds", folds));
+        NANO_CHECK(!invalid->load());
+
+        // cleanup
+        if (auto* handle = ::opendir(dir))
+        {
+                while (const auto* entry = ::readdir(handle))
+                {
+                        const auto name = string_t(entry->d_name);
+                        if (name != "." && name != "..")
+                        {
+                                std::remove((string_t(dir) + "/" + name).c_str());
+                        }
+                }
+                ::closedir(handle);
+        }
+        ::rmdir(dir);
+}
+
 NANO_CASE(loading)
 {
         const auto idims = tensor3d_dim_t{4, 1, 1};
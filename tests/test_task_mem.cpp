@@ -0,0 +1,273 @@
+#include "utest.h"
+#include "cortex.h"
+#include "tasks/task_mem_tensor.h"
+#include <cstdio>
+#include <fstream>
+#include <tuple>
+#include <iterator>
+#include <algorithm>
+#include <dirent.h>
+#include <unistd.h>
+
+using namespace nano;
+
+///
+/// \brief in-memory task loaded (in theory) from a file and counting how many times it is populated.
+///
+class file_task_t final : public mem_tensor_task_t
+{
+public:
+
+        file_task_t(const string_t& path, const size_t folds) :
+                mem_tensor_task_t(make_dims(2, 1, 1), make_dims(3, 1, 1), folds),
+                m_path(path)
+        {
+        }
+
+        void to_json(json_t& json) const override
+        {
+                nano::to_json(json, "path", m_path, "folds", fsize());
+        }
+
+        void from_json(const json_t&) override
+        {
+        }
+
+        size_t populated() const { return m_populated; }
+
+        using mem_tensor_task_t::n_chunks;
+        using mem_tensor_task_t::n_targets;
+        using mem_tensor_task_t::n_labels;
+        using mem_tensor_task_t::n_samples;
+
+private:
+
+        strings_t sources() const override { return {m_path}; }
+
+        bool populate() override
+        {
+                ++ m_populated;
+
+                // NB: the same samples are distributed differently to train, validation and test in each fold
+                const auto count = tensor_size_t(30);
+                for (tensor_size_t i = 0; i < count; ++ i)
+                {
+                        tensor3d_t input(idims());
+                        input.vector() << i, i * i;
+                        add_chunk(input, static_cast<size_t>(i));
+                }
+
+                for (size_t f = 0; f < fsize(); ++ f)
+                {
+                        for (tensor_size_t i = 0; i < count; ++ i)
+                        {
+                                const auto k = (static_cast<size_t>(i) + f) % 3;
+                                const auto p = (k == 0) ? protocol::test : (k == 1 ? protocol::valid : protocol::train);
+                                add_sample({f, p}, static_cast<size_t>(i), class_target(i % 3, 3), "class" + std::to_string(i % 3));
+                        }
+                }
+
+                return true;
+        }
+
+        // attributes
+        string_t        m_path;
+        size_t          m_populated{0};
+};
+
+static strings_t list_snapshots(const string_t& dir)
+{
+        strings_t paths;
+        if (auto* handle = ::opendir(dir.c_str()))
+        {
+                while (const auto* entry = ::readdir(handle))
+                {
+                        const auto name = string_t(entry->d_name);
+                        if (name.find(".snapshot") != string_t::npos)
+                        {
+                                paths.push_back(dir + "/" + name);
+                        }
+                }
+                ::closedir(handle);
+        }
+        return paths;
+}
+
+static std::vector<char> read_file(const string_t& path)
+{
+        std::ifstream stream(path.c_str(), std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+static void write_file(const string_t& path, const std::vector<char>& data)
+{
+        std::ofstream stream(path.c_str(), std::ios::binary | std::ios::trunc);
+        stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+NANO_BEGIN_MODULE(test_task_mem)
+
+NANO_CASE(corrupted_snapshot)
+{
+        char dir[] = "/tmp/nano-task-mem-XXXXXX";
+        NANO_REQUIRE(::mkdtemp(dir) != nullptr);
+
+        const auto check_equal = [&] (const task_t& task1, const task_t& task2)
+        {
+                NANO_CHECK_EQUAL(task1.idims(), task2.idims());
+                NANO_CHECK_EQUAL(task1.odims(), task2.odims());
+                NANO_CHECK_EQUAL(task1.fsize(), task2.fsize());
+                NANO_REQUIRE_EQUAL(task1.size(), task2.size());
+
+                for (size_t f = 0; f < task1.fsize(); ++ f)
+                {
+                        for (const auto p : {protocol::train, protocol::valid, protocol::test})
+                        {
+                                const auto fold = fold_t{f, p};
+                                NANO_REQUIRE_EQUAL(task1.size(fold), task2.size(fold));
+                                for (size_t i = 0, size = task1.size(fold); i < size; ++ i)
+                                {
+                                        const auto sample1 = task1.get(fold, i, i + 1);
+                                        const auto sample2 = task2.get(fold, i, i + 1);
+
+                                        NANO_CHECK_EIGEN_CLOSE(sample1.idata(0).vector(), sample2.idata(0).vector(), epsilon0<scalar_t>());
+                                        NANO_CHECK_EIGEN_CLOSE(sample1.odata(0).vector(), sample2.odata(0).vector(), epsilon0<scalar_t>());
+                                        NANO_CHECK_EQUAL(task1.label(fold, i), task2.label(fold, i));
+                                        NANO_CHECK_EQUAL(task1.ihash(fold, i), task2.ihash(fold, i));
+                                        NANO_CHECK_EQUAL(task1.ohash(fold, i), task2.ohash(fold, i));
+                                }
+                        }
+                }
+        };
+
+        const auto path = string_t(dir) + "/task.data";
+        write_file(path, std::vector<char>(16, 'x'));
+
+        // the first load populates the task and saves the snapshot, the second one maps the snapshot
+        file_task_t task1(path, 2);
+        NANO_REQUIRE(task1.load());
+        NANO_CHECK_EQUAL(task1.populated(), size_t(1));
+
+        const auto snapshots = list_snapshots(dir);
+        NANO_REQUIRE_EQUAL(snapshots.size(), size_t(1));
+        const auto snapshot = snapshots[0];
+        const auto original = read_file(snapshot);
+
+        file_task_t task2(path, 2);
+        NANO_REQUIRE(task2.load());
+        NANO_CHECK_EQUAL(task2.populated(), size_t(0));
+        check_equal(task1, task2);
+
+        // offset of the number of chunks: magic, version, input and target dimensions, number of folds
+        const auto offset = sizeof(uint64_t) + sizeof(uint32_t) + 2 * sizeof(tensor3d_dim_t) + sizeof(size_t);
+        NANO_REQUIRE(offset + sizeof(size_t) < original.size());
+
+        std::vector<std::vector<char>> corrupted;
+
+        // truncated
+        corrupted.emplace_back(original.begin(), original.begin() + static_cast<std::ptrdiff_t>(original.size() / 2));
+
+        // huge number of chunks
+        corrupted.push_back(original);
+        std::fill(corrupted.back().begin() + offset, corrupted.back().begin() + offset + sizeof(size_t), char(0xFF));
+
+        // garbled chunks, targets, labels and samples
+        corrupted.push_back(original);
+        for (auto i = offset + sizeof(size_t); i < original.size(); ++ i)
+        {
+                corrupted.back()[i] = static_cast<char>((i * 131 + 17) % 256);
+        }
+
+        // the corrupted snapshots should be ignored and the task loaded again from its source
+        for (const auto& data : corrupted)
+        {
+                write_file(snapshot, data);
+
+                file_task_t task3(path, 2);
+                NANO_REQUIRE(task3.load());
+                NANO_CHECK_EQUAL(task3.populated(), size_t(1));
+                check_equal(task1, task3);
+        }
+
+        // cleanup
+        for (const auto& snapshot : list_snapshots(dir))
+        {
+                std::remove(snapshot.c_str());
+        }
+        std::remove(path.c_str());
+        ::rmdir(dir);
+}
+
+NANO_CASE(interning)
+{
+        file_task_t task("/dev/null/task.data", 3);
+        task.cache(false);
+        NANO_REQUIRE(task.load());
+
+        // the samples shared by several folds are stored once, as are their targets and labels
+        NANO_CHECK_EQUAL(task.n_chunks(), size_t(30));
+        NANO_CHECK_EQUAL(task.n_samples(), size_t(30));
+        NANO_CHECK_EQUAL(task.n_targets(), size_t(3));
+        NANO_CHECK_EQUAL(task.n_labels(), size_t(3));
+        NANO_CHECK_EQUAL(task.size(), size_t(90));
+
+        for (size_t f = 0; f < task.fsize(); ++ f)
+        {
+                for (const auto p : {protocol::train, protocol::valid, protocol::test})
+                {
+                        const auto fold = fold_t{f, p};
+                        NANO_REQUIRE_EQUAL(task.size(fold), size_t(10));
+                        for (size_t i = 0, size = task.size(fold); i < size; ++ i)
+                        {
+                                const auto sample = task.get(fold, i, i + 1);
+                                const auto index = static_cast<tensor_size_t>(sample.idata(0).vector()(0));
+                                const auto target = class_target(index % 3, 3);
+
+                                NANO_CHECK_EQUAL(task.label(fold, i), "class" + std::to_string(index % 3));
+                                NANO_CHECK_EQUAL(task.ohash(fold, i), nano::hash_range(target.data(), target.data() + target.size()));
+                                NANO_CHECK_EIGEN_CLOSE(sample.odata(0).vector(), target, epsilon0<scalar_t>());
+                        }
+                }
+        }
+}
+
+NANO_CASE(shuffle)
+{
+        file_task_t task("/dev/null/task.data", 2);
+        task.cache(false);
+        NANO_REQUIRE(task.load());
+
+        const auto describe = [&] (const fold_t& fold)
+        {
+                std::vector<std::tuple<scalar_t, scalar_t, size_t, size_t, string_t>> samples;
+                for (size_t i = 0, size = task.size(fold); i < size; ++ i)
+                {
+                        const auto sample = task.get(fold, i, i + 1);
+                        samples.emplace_back(
+                                sample.idata(0).vector()(0), sample.idata(0).vector()(1),
+                                task.ihash(fold, i), task.ohash(fold, i), task.label(fold, i));
+                }
+                return samples;
+        };
+
+        const auto fold = fold_t{1, protocol::train};
+        const auto other = fold_t{0, protocol::train};
+
+        const auto before = describe(fold);
+        const auto before_other = describe(other);
+        for (int trial = 0; trial < 8; ++ trial)
+        {
+                task.shuffle(fold);
+        }
+        const auto after = describe(fold);
+
+        // the samples are permuted, but each input keeps its target, label and hashes
+        NANO_CHECK(before != after);
+        NANO_CHECK(std::is_permutation(before.begin(), before.end(), after.begin(), after.end()));
+
+        // the other folds and the stored samples are not changed
+        NANO_CHECK(before_other == describe(other));
+        NANO_CHECK_EQUAL(task.n_samples(), size_t(30));
+}
+
+NANO_END_MODULE()
@@ -0,0 +1,214 @@
+#include "task.h"
+#include "utest.h"
+#include "tasks/task_stream.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <unistd.h>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace nano;
+
+static string_t make_temp_path()
+{
+        char path[] = "/tmp/nano-task-stream-XXXXXX";
+        const auto fd = ::mkstemp(path);
+        if (fd >= 0)
+        {
+                ::close(fd);
+        }
+        return path;
+}
+
+NANO_BEGIN_MODULE(test_task_stream)
+
+NANO_CASE(failed)
+{
+        const auto task = get_tasks().get("stream");
+        NANO_REQUIRE(task);
+
+        task->from_json(to_json("path", "/dev/null?!"));
+        NANO_CHECK(!task->load());
+}
+
+NANO_CASE(convert)
+{
+        const auto isize = 5;
+        const auto osize = 3;
+        const auto count = size_t(240);
+        const auto folds = size_t(3);
+
+        const auto task1 = get_tasks().get("synth-affine");
+        NANO_REQUIRE(task1);
+        task1->from_json(to_json("isize", isize, "osize", osize, "noise", 0, "count", count, "folds", folds));
+        NANO_REQUIRE(task1->load());
+
+        // convert the task using small blocks and stream it with a small window to force evictions
+        const auto path = make_temp_path();
+        NANO_REQUIRE(stream_task_t::save(*task1, path, 7));
+
+        const auto task2 = get_tasks().get("stream");
+        NANO_REQUIRE(task2);
+        task2->from_json(to_json("path", path, "window", 4, "readahead", 2));
+        NANO_REQUIRE(task2->load());
+
+        NANO_CHECK_EQUAL(task1->idims(), task2->idims());
+        NANO_CHECK_EQUAL(task1->odims(), task2->odims());
+        NANO_CHECK_EQUAL(task1->fsize(), task2->fsize());
+        NANO_REQUIRE_EQUAL(task1->size(), task2->size());
+
+        for (size_t f = 0; f < folds; ++ f)
+        {
+                for (const auto p : {protocol::train, protocol::valid, protocol::test})
+                {
+                        const auto fold = fold_t{f, p};
+                        const auto size = task1->size(fold);
+                        NANO_REQUIRE_EQUAL(size, task2->size(fold));
+
+                        // the minibatches span several blocks
+                        const auto batch1 = task1->get(fold, 0, size);
+                        const auto batch2 = task2->get(fold, 0, size);
+                        for (size_t i = 0; i < size; ++ i)
+                        {
+                                const auto ii = static_cast<tensor_size_t>(i);
+                                NANO_CHECK_EIGEN_CLOSE(batch1.idata(ii).vector(), batch2.idata(ii).vector(), epsilon0<scalar_t>());
+                                NANO_CHECK_EIGEN_CLOSE(batch1.odata(ii).vector(), batch2.odata(ii).vector(), epsilon0<scalar_t>());
+                                NANO_CHECK_EQUAL(task1->label(fold, i), task2->label(fold, i));
+                                NANO_CHECK_EQUAL(task1->ihash(fold, i), task2->ihash(fold, i));
+                                NANO_CHECK_EQUAL(task1->ohash(fold, i), task2->ohash(fold, i));
+                        }
+
+                        // shuffling changes only the order of the samples
+                        std::vector<size_t> hashes1, hashes2;
+                        for (size_t i = 0; i < size; ++ i)
+                        {
+                                hashes1.push_back(task2->ihash(fold, i));
+                        }
+
+                        task2->shuffle(fold);
+                        for (size_t i = 0; i < size; ++ i)
+                        {
+                                hashes2.push_back(task2->ihash(fold, i));
+
+                                const auto sample = task2->get(fold, i, i + 1);
+                                NANO_CHECK_EQUAL(sample.idata(0).dims(), task1->idims());
+                        }
+
+                        std::sort(hashes1.begin(), hashes1.end());
+                        std::sort(hashes2.begin(), hashes2.end());
+                        NANO_CHECK(hashes1 == hashes2);
+                }
+        }
+
+        std::remove(path.c_str());
+}
+
+NANO_CASE(truncated)
+{
+        const auto task1 = get_tasks().get("synth-affine");
+        NANO_REQUIRE(task1);
+        task1->from_json(to_json("isize", 5, "osize", 3, "noise", 0, "count", 100, "folds", 1));
+        NANO_REQUIRE(task1->load());
+
+        const auto path = make_temp_path();
+        NANO_REQUIRE(stream_task_t::save(*task1, path, 8));
+
+        const auto task2 = get_tasks().get("stream");
+        NANO_REQUIRE(task2);
+        task2->from_json(to_json("path", path, "window", 4, "readahead", 0));
+        NANO_REQUIRE(task2->load());
+
+        // the blocks cannot be read anymore after the file is truncated
+        std::ifstream stream(path, std::ios::binary | std::ios::ate);
+        const auto size = static_cast<off_t>(stream.tellg());
+        NANO_REQUIRE(::truncate(path.c_str(), size / 2) == 0);
+
+        // ... so the minibatches fail (and again, as the failed blocks are not cached)
+        const auto fold = fold_t{0, protocol::train};
+        const auto count = task2->size(fold);
+        NANO_CHECK_THROW(task2->get(fold, 0, count), std::runtime_error);
+        NANO_CHECK_THROW(task2->get(fold, 0, count), std::runtime_error);
+
+        std::remove(path.c_str());
+}
+
+#if defined(__linux__)
+NANO_CASE(shared)
+{
+        const auto count = size_t(120);
+        const auto folds = size_t(2);
+
+        const auto task1 = get_tasks().get("synth-affine");
+        NANO_REQUIRE(task1);
+        task1->from_json(to_json("isize", 4, "osize", 2, "noise", 0, "count", count, "folds", folds));
+        NANO_REQUIRE(task1->load());
+
+        const auto name = strcat("/nano-task-stream-test-", ::getpid());
+        stream_task_t::unpublish(name);
+        NANO_REQUIRE(stream_task_t::publish(*task1, name, 16));
+
+        // the segment is published only once
+        NANO_CHECK(!stream_task_t::publish(*task1, name, 16));
+
+        // several tasks (e.g. in different processes) attach to the same segment
+        const auto task2 = get_tasks().get("stream");
+        const auto task3 = get_tasks().get("stream");
+        NANO_REQUIRE(task2 && task3);
+        task2->from_json(to_json("shm", name));
+        task3->from_json(to_json("shm", name));
+        NANO_CHECK(task2->load());
+        NANO_CHECK(task3->load());
+
+        // the mappings stay valid after removing the segment's name
+        NANO_CHECK(stream_task_t::unpublish(name));
+        NANO_CHECK(!stream_task_t::unpublish(name));
+
+        NANO_REQUIRE_EQUAL(task1->size(), task2->size());
+        NANO_REQUIRE_EQUAL(task1->size(), task3->size());
+
+        for (size_t f = 0; f < folds; ++ f)
+        {
+                for (const auto p : {protocol::train, protocol::valid, protocol::test})
+                {
+                        const auto fold = fold_t{f, p};
+                        const auto size = task1->size(fold);
+                        NANO_REQUIRE_EQUAL(size, task2->size(fold));
+
+                        task3->shuffle(fold);
+
+                        const auto batch1 = task1->get(fold, 0, size);
+                        const auto batch2 = task2->get(fold, 0, size);
+                        const auto batch3 = task3->get(fold, 0, size);
+                        for (size_t i = 0; i < size; ++ i)
+                        {
+                                const auto ii = static_cast<tensor_size_t>(i);
+                                NANO_CHECK_EIGEN_CLOSE(batch1.idata(ii).vector(), batch2.idata(ii).vector(), epsilon0<scalar_t>());
+                                NANO_CHECK_EIGEN_CLOSE(batch1.odata(ii).vector(), batch2.odata(ii).vector(), epsilon0<scalar_t>());
+                                NANO_CHECK_EQUAL(batch1.label(i), batch2.label(i));
+                                NANO_CHECK_EQUAL(task1->ihash(fold, i), task2->ihash(fold, i));
+                                NANO_CHECK_EQUAL(task1->ohash(fold, i), task2->ohash(fold, i));
+                        }
+
+                        // the shuffled samples are still consistent with their hashes
+                        for (size_t i = 0; i < size; ++ i)
+                        {
+                                size_t j = 0;
+                                while (j < size && task1->ihash(fold, j) != task3->ihash(fold, i))
+                                {
+                                        ++ j;
+                                }
+
+                                NANO_REQUIRE(j < size);
+                                const auto ii = static_cast<tensor_size_t>(i), jj = static_cast<tensor_size_t>(j);
+                                NANO_CHECK_EIGEN_CLOSE(batch1.idata(jj).vector(), batch3.idata(ii).vector(), epsilon0<scalar_t>());
+                        }
+                }
+        }
+
+        task2->from_json(to_json("shm", name));
+        NANO_CHECK(!task2->load());
+}
+#endif
+
+NANO_END_MODULE()